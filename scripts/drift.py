@@ -1,27 +1,80 @@
-# testing with a drift-based LFO
+# Prototype of a drift-based LFO, ported to src/synthesizer/dsp/effect_drift.c
+#
+# Cubed random points are linearly interpolated, SEGMENT values per point, and
+# smoothed by a 2nd order Butterworth lowpass at CUTOFF of nyquist. Plots the
+# prototype by default.
+#
+# --check runs the host build of the C kernel, tests/host/drift_kernel.c, and
+# compares its output against the prototype filtering the same points. The
+# cutoff relative to the point rate is kept for slower rates, as in the kernel.
 
-import numpy as np
-import matplotlib.pyplot as plt
-from scipy import signal
+import argparse
+import math
+import random
+import subprocess
+import sys
 
 N = 32
-M = 1024
+SEGMENT = 32
+CUTOFF = 0.1
+
+# largest difference from the prototype, in 16-bit LSB
+TOLERANCE = 4
+
+
+def butter2(cutoff):
+    # the same as scipy.signal.iirfilter(2, Wn=cutoff, btype='low', ftype='butter')
+    k = math.tan(math.pi * cutoff / 2)
+    norm = 1 / (1 + math.sqrt(2) * k + k * k)
+    b = [k * k * norm, 2 * k * k * norm, k * k * norm]
+    a = [1, 2 * (k * k - 1) * norm, (1 - math.sqrt(2) * k + k * k) * norm]
+    return b, a
+
+
+def prototype(points, segment, cutoff):
+    # interpolated from the previous point, starting at 0, towards each point
+    x = []
+    prev = 0
+    for r in points:
+        for j in range(segment):
+            x.append(prev + (r - prev) * (j / segment))
+        prev = r
 
-R = np.random.randint(-32, 32, N)
+    # scipy.signal.lfilter, direct form
+    b, a = butter2(cutoff)
+    y = []
+    x1 = x2 = y1 = y2 = 0
+    for x0 in x:
+        y0 = b[0] * x0 + b[1] * x1 + b[2] * x2 - a[1] * y1 - a[2] * y2
+        x2, x1, y2, y1 = x1, x0, y1, y0
+        y.append(y0)
+    return y
 
-F = R**3
-F_scale = np.empty(M)
 
-prev = 0
-for i, r in enumerate(F):
-    m = M//N
-    for j in range(m):
-        F_scale[i*m+j] = prev + (r-prev)*(j/m)
-    prev = r
+def check(kernel):
+    failed = False
+    for segment, points, seed in [(SEGMENT, 64, 1), (SEGMENT, 64, 0x12345678), (300, 16, 7), (1500, 8, 99)]:
+        output = subprocess.run([kernel, str(segment), str(points), str(seed)], check=True, capture_output=True, text=True).stdout.split('\n')
+        segment = int(output[0])
+        rows = [tuple(map(int, line.split())) for line in output[1:] if line]
+        targets = [rows[i * segment][0] for i in range(len(rows) // segment)]
 
+        reference = prototype(targets, segment, min(CUTOFF * SEGMENT / segment, 0.9))
+        error = max(abs(y - max(min(r, 2**15 - 1), -2**15)) for (_, y), r in zip(rows, reference))
 
-b, a = signal.iirfilter(2, Wn=0.1, btype="low", ftype="butter")
-Y = signal.lfilter(b, a, F_scale)
+        print('segment {:5}, {:3} points: largest difference {:.1f} LSB'.format(segment, len(targets), error))
+        failed |= error > TOLERANCE
+    return not failed
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--check', metavar='KERNEL', help='host build of the C kernel to compare with the prototype')
+args = parser.parse_args()
+
+if args.check:
+    sys.exit(0 if check(args.check) else 1)
+
+import matplotlib.pyplot as plt
 
-plt.plot(Y)
+plt.plot(prototype([random.randint(-32, 31)**3 for _ in range(N)], SEGMENT, CUTOFF))
 plt.show()
@@ -0,0 +1,507 @@
+# Generates the voice and bus processing of a patch known at build time
+#
+# The patch is described as two chains of modules in a YAML file, see
+# patch.yaml. Voices are unrolled for the number of voices. The lowpass, allpass
+# and pan kernels are generated as static inline functions with their
+# coefficients as literals. Oscillator, envelope, modulation and echo are called
+# through their modules on static state, with their parameters set once in
+# patch_init. Parameters given as "param" follow the parameter store instead,
+# as MIDI control changes and sequencer parameter locks do. Delay buffers are
+# sized for their delay. Modules with "enabled: false" are left out.
+
+import argparse
+import math
+import sys
+
+import yaml
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--description', required=True, help='patch description in YAML')
+parser.add_argument('--voices', type=int, required=True, help='number of voices to unroll, CONFIG_MAX_NOTES')
+parser.add_argument('--sample-rate', type=int, required=True)
+parser.add_argument('--output', required=True)
+args = parser.parse_args()
+
+INT16_MAX = 2**15 - 1
+
+WAVEFORMS = ['sine', 'triangle', 'sawtooth']
+ENVELOPE_MODES = {
+    'loop': 'ENVELOPE_MODE_LOOP',
+    'one_shot': 'ENVELOPE_MODE_ONE_SHOT',
+    'one_shot_hold': 'ENVELOPE_MODE_ONE_SHOT_HOLD',
+}
+
+VOICE_MODULES = ['oscillator', 'envelope', 'lowpass', 'allpass', 'modulation', 'pan']
+BUS_MODULES = ['lowpass', 'echo']
+
+# modules called out of line, the other kernels are generated
+HEADERS = {
+    'oscillator': 'dsp/oscillator.h',
+    'envelope': 'dsp/effect_envelope.h',
+    'modulation': 'dsp/effect_modulation.h',
+    'echo': 'dsp/effect_echo.h',
+}
+
+# parameters which may be given as "param", to follow the parameter store
+BINDINGS = {
+    ('envelope', 'period_ms'): 'PARAM_ENVELOPE_PERIOD_MS',
+    ('envelope', 'duty_cycle'): 'PARAM_ENVELOPE_DUTY_CYCLE',
+    ('envelope', 'floor'): 'PARAM_ENVELOPE_FLOOR',
+    ('lowpass', 'cutoff'): 'PARAM_FILTER_CUTOFF',
+    ('modulation', 'freq'): 'PARAM_LFO_FREQ_MHZ',
+    ('echo', 'feedback'): 'PARAM_ECHO_FEEDBACK',
+}
+
+
+def fail(message):
+    sys.exit('{}: {}'.format(args.description, message))
+
+
+def parse_chain(chain, allowed, name):
+    modules = []
+    for entry in chain or []:
+        if not isinstance(entry, dict) or len(entry) != 1:
+            fail('{} entries must be a single module each'.format(name))
+        module, params = next(iter(entry.items()))
+        params = params or {}
+        if module not in allowed:
+            fail('{} is not a {} module'.format(module, name))
+        if params.get('enabled', True):
+            modules.append((module, params))
+    return modules
+
+
+def value(module, params, key, default):
+    # a number is folded into the generated code, "param" is the name of the parameter in the store
+    x = params.get(key, default)
+    if x == 'param':
+        if (module, key) not in BINDINGS:
+            fail('{} {} cannot follow the parameter store'.format(module, key))
+        return BINDINGS[(module, key)]
+    if not isinstance(x, (int, float)) or isinstance(x, bool):
+        fail('{} {} must be a number or param'.format(module, key))
+    return float(x)
+
+
+def bound(x):
+    return isinstance(x, str)
+
+
+def q15(module, key, x):
+    # same truncation as FIXED16_LITERAL
+    if not 0 <= x <= 1:
+        fail('{} {} must be within [0, 1]'.format(module, key))
+    return int(x * INT16_MAX)
+
+
+def pan_gains(pan):
+    # same constant power law as stereo_pan_gains, left in the lower half
+    angle = (pan + 1) / 2 * math.pi / 2
+    left = round(INT16_MAX * math.cos(angle))
+    right = round(INT16_MAX * math.sin(angle))
+    return '0x{:08x}'.format((right << 16) | left)
+
+
+with open(args.description) as f:
+    description = yaml.safe_load(f) or {}
+
+voice = parse_chain(description.get('voice'), VOICE_MODULES, 'voice')
+bus = parse_chain(description.get('bus'), BUS_MODULES, 'bus')
+
+if not voice or voice[0][0] != 'oscillator':
+    fail('voice chain must start with an oscillator')
+if voice[-1][0] != 'pan':
+    fail('voice chain must end with pan')
+for chain, name in [(voice, 'voice'), (bus, 'bus')]:
+    modules = [m for m, _ in chain]
+    if len(modules) != len(set(modules)):
+        fail('each module may only be used once in the {} chain'.format(name))
+
+voice_params = dict(voice)
+bus_params = dict(bus)
+voice_modules = [m for m, _ in voice if m != 'pan']
+
+waveform = voice_params['oscillator'].get('waveform', 'triangle')
+if waveform not in WAVEFORMS:
+    fail('unknown waveform {}'.format(waveform))
+
+envelope = voice_params.get('envelope')
+if envelope is not None and envelope.get('mode', 'one_shot') not in ENVELOPE_MODES:
+    fail('unknown envelope mode {}'.format(envelope.get('mode')))
+
+spread = float(voice_params['pan'].get('spread', 0.0))
+pans = [0.0] if args.voices == 1 else [-spread + 2 * spread * v / (args.voices - 1) for v in range(args.voices)]
+
+# values of all parameters, numbers or the names of parameters in the store
+settings = {}
+for chain, prefix in [(voice, 'voice'), (bus, 'bus')]:
+    for module, params in chain:
+        if module == 'envelope':
+            settings[prefix, module] = {
+                'period_ms': value(module, params, 'period_ms', 150),
+                'duty_cycle': value(module, params, 'duty_cycle', 0.1),
+                'floor': value(module, params, 'floor', 0.0),
+                'fade_out_attenuation': value(module, params, 'fade_out_attenuation', 0.05),
+            }
+        elif module == 'lowpass':
+            settings[prefix, module] = {'cutoff': value(module, params, 'cutoff', 1.0)}
+        elif module == 'allpass':
+            settings[prefix, module] = {'gain': value(module, params, 'gain', 0.6)}
+        elif module == 'modulation':
+            settings[prefix, module] = {
+                'freq': value(module, params, 'freq', 1.0),
+                'amplitude': value(module, params, 'amplitude', 1.0),
+            }
+        elif module == 'echo':
+            settings[prefix, module] = {'feedback': value(module, params, 'feedback', 0.0)}
+
+for (_, module), params in settings.items():
+    for key, x in params.items():
+        if not bound(x) and key in ('cutoff', 'gain', 'feedback', 'duty_cycle', 'floor'):
+            q15(module, key, x)
+
+
+def delay_ms(module, params):
+    # the delay sizes the buffer, so it has no default
+    delay = params.get('delay_ms')
+    if not isinstance(delay, int) or isinstance(delay, bool) or delay <= 0:
+        fail('{} needs delay_ms, a whole number of milliseconds above 0'.format(module))
+    return delay
+
+
+def delay_frames(module, params):
+    return args.sample_rate * delay_ms(module, params) // 1000
+
+
+def state(v, module):
+    return '_voice_{}_{}'.format(v, module)
+
+
+def cutoff_ramp(prefix):
+    # the cutoff in the upper 16 bits, the lower 16 bits accumulate the fractional ramp
+    s = '_{}_lowpass_cutoff'.format(prefix)
+    return [
+        '/* PARAM_FILTER_CUTOFF, ramped across the block */',
+        'const fixed16 cutoff_target = param_store_get(PARAM_FILTER_CUTOFF);',
+        'const int32_t cutoff = (int32_t){} << 16;'.format(s),
+        'const int32_t cutoff_ramp = (((int32_t)cutoff_target - {}) << 16) / (int32_t)block_size;'.format(s),
+        '',
+        '{} = cutoff_target;'.format(s),
+        '',
+    ]
+
+
+def lowpass_kernel(prefix):
+    cutoff = settings[prefix, 'lowpass']['cutoff']
+    stereo = prefix == 'bus'
+    lines = []
+    if bound(cutoff):
+        lines.append('/* one pole lowpass of the {}, y[n] = y[n-1] + a*(x[n] - y[n-1]) with a following {} */'.format(
+            'bus' if stereo else 'voices', cutoff))
+        arguments = ', int32_t cutoff, int32_t cutoff_ramp'
+        coefficient = '(cutoff >> 16)'
+    else:
+        lines.append('/* one pole lowpass of the {}, y[n] = y[n-1] + a*(x[n] - y[n-1]) with a = {} */'.format(
+            'bus' if stereo else 'voices', cutoff))
+        arguments = ''
+        coefficient = str(q15('lowpass', 'cutoff', cutoff))
+
+    if stereo:
+        lines += [
+            'static inline void _bus_lowpass(int32_t* state, stereo16* block, size_t block_size{})'.format(arguments),
+            '{',
+            '    int32_t left = state[0];',
+            '    int32_t right = state[1];',
+            '',
+            '    for (size_t i = 0; i < block_size; i++) {',
+            '        left += ({} * (STEREO_LEFT(block[i]) - left)) >> 15;'.format(coefficient),
+            '        right += ({} * (STEREO_RIGHT(block[i]) - right)) >> 15;'.format(coefficient),
+            '        block[i] = stereo_pack(left, right);',
+        ]
+    else:
+        lines += [
+            'static inline void _voice_lowpass(int32_t* state, fixed16* block, size_t block_size{})'.format(arguments),
+            '{',
+            '    int32_t y = *state;',
+            '',
+            '    for (size_t i = 0; i < block_size; i++) {',
+            '        y += ({} * (block[i] - y)) >> 15;'.format(coefficient),
+            '        block[i] = y;',
+        ]
+    if bound(cutoff):
+        lines += ['', '        cutoff += cutoff_ramp;']
+    lines += ['    }', '']
+    if stereo:
+        lines += ['    state[0] = left;', '    state[1] = right;']
+    else:
+        lines += ['    *state = y;']
+    lines += ['}', '']
+    return lines
+
+
+def allpass_kernel():
+    gain = q15('allpass', 'gain', settings['voice', 'allpass']['gain'])
+    gain2 = INT16_MAX - ((gain * gain) >> 15)
+    frames = delay_frames('allpass', voice_params['allpass'])
+    return [
+        '/* allpass of the voices with a gain of {}, over a buffer of exactly the delay, so the oldest frame is'.format(
+            settings['voice', 'allpass']['gain']),
+        ' * read where the newest is written. Same arithmetic as filter_allpass */',
+        'static inline void _voice_allpass(fixed16* buffer, uint32_t* index, fixed16* block, size_t block_size)',
+        '{',
+        '    uint32_t head = *index;',
+        '',
+        '    for (size_t i = 0; i < block_size; i++) {',
+        '        const fixed16 input = block[i];',
+        '        const fixed16 delayed = buffer[head];',
+        '',
+        '        block[i] = FIXED_ADD_SATURATE(FIXED_MULTIPLY(input, {}), FIXED_ADD(delayed, {}));'.format(-gain, gain2),
+        '        buffer[head] = input + FIXED_MULTIPLY(delayed, {});'.format(gain),
+        '',
+        '        head++;',
+        '        if (head == {}) {{'.format(frames),
+        '            head = 0;',
+        '        }',
+        '    }',
+        '',
+        '    *index = head;',
+        '}',
+        '',
+    ]
+
+
+def voice_init(v):
+    lines = []
+    for module, params in voice:
+        s = state(v, module)
+        setting = settings.get(('voice', module))
+        if module == 'oscillator':
+            lines += ['osc_init(&{});'.format(s)]
+        elif module == 'envelope':
+            lines += [
+                'effect_envelope_init(&{});'.format(s),
+                'effect_envelope_set_mode(&{}, {});'.format(s, ENVELOPE_MODES[params.get('mode', 'one_shot')]),
+            ]
+            for key, setter in [('period_ms', 'period'), ('duty_cycle', 'duty_cycle'), ('floor', 'floor'),
+                                ('fade_out_attenuation', 'fade_out_attenuation')]:
+                if not bound(setting[key]):
+                    lines.append('effect_envelope_set_{}(&{}, {}f);'.format(setter, s, setting[key]))
+        elif module == 'lowpass':
+            lines += ['{} = 0;'.format(s)]
+        elif module == 'allpass':
+            lines += [
+                'memset({0}_buffer, 0, sizeof({0}_buffer));'.format(s),
+                '{}_index = 0;'.format(s),
+            ]
+        elif module == 'modulation':
+            lines += ['effect_modulation_init(&{});'.format(s)]
+            if not bound(setting['freq']):
+                lines.append('effect_modulation_set_freq(&{}, {}f);'.format(s, setting['freq']))
+            lines.append('effect_modulation_set_amplitude(&{}, FLOAT_TO_UFIXED16({}f));'.format(s, setting['amplitude']))
+    return lines
+
+
+def voice_process(v):
+    # modules returning false leave a silent block, which ends the voice for this block
+    gates = []
+    if envelope is not None:
+        gates.append('effect_envelope_is_active(&{})'.format(state(v, 'envelope')))
+    gates.append('osc_process_{}(&{}, voice, block_size)'.format(waveform, state(v, 'oscillator')))
+    if envelope is not None:
+        gates.append('effect_envelope_process(&{}, voice, block_size)'.format(state(v, 'envelope')))
+
+    body = []
+    for module, params in voice:
+        s = state(v, module)
+        if module == 'lowpass':
+            ramp = ', cutoff, cutoff_ramp' if bound(settings['voice', 'lowpass']['cutoff']) else ''
+            body.append('_voice_lowpass(&{}, voice, block_size{});'.format(s, ramp))
+        elif module == 'allpass':
+            body.append('_voice_allpass({0}_buffer, &{0}_index, voice, block_size);'.format(s))
+        elif module == 'modulation':
+            body.append('(void)effect_modulation_process(&{}, voice, block_size);'.format(s))
+    body.append('stereo_mix_panned(block, voice, block_size, {}); /* pan {:.3f} */'.format(pan_gains(pans[v]), pans[v]))
+
+    lines = ['/* voice {} */'.format(v), 'if (' + '\n    && '.join(gates) + ') {']
+    lines += ['    ' + line for line in body]
+    lines += ['}']
+    return lines
+
+
+def bus_init():
+    lines = []
+    for module, params in bus:
+        s = '_bus_' + module
+        if module == 'lowpass':
+            lines += ['{0}_state[0] = 0;'.format(s), '{0}_state[1] = 0;'.format(s)]
+        elif module == 'echo':
+            feedback = settings['bus', 'echo']['feedback']
+            lines += [
+                'effect_echo_init(&{0}, {0}_buffer, ARRAY_SIZE({0}_buffer));'.format(s),
+                'effect_echo_set_delay(&{}, {});'.format(s, delay_ms(module, params)),
+                'effect_echo_set_feedback(&{}, {});'.format(
+                    s, 'param_store_get({})'.format(feedback) if bound(feedback) else 'FIXED16_LITERAL({})'.format(feedback)),
+            ]
+    return lines
+
+
+def bus_process():
+    lines = []
+    for module, _ in bus:
+        s = '_bus_' + module
+        if module == 'lowpass':
+            ramp = ', cutoff, cutoff_ramp' if bound(settings['bus', 'lowpass']['cutoff']) else ''
+            lines.append('_bus_lowpass({}, block, block_size{});'.format(s + '_state', ramp))
+        elif module == 'echo':
+            lines.append('(void)effect_echo_process(&{}, block, block_size);'.format(s))
+    return lines
+
+
+def params_apply():
+    # same conversions as the generic voice loop applies
+    conversions = {
+        'PARAM_ENVELOPE_PERIOD_MS': 'param_store_get(PARAM_ENVELOPE_PERIOD_MS)',
+        'PARAM_ENVELOPE_DUTY_CYCLE': '(float)param_store_get(PARAM_ENVELOPE_DUTY_CYCLE) / INT16_MAX',
+        'PARAM_ENVELOPE_FLOOR': '(float)param_store_get(PARAM_ENVELOPE_FLOOR) / INT16_MAX',
+        'PARAM_LFO_FREQ_MHZ': 'param_store_get(PARAM_LFO_FREQ_MHZ) / 1000.0f',
+    }
+    setters = {
+        'PARAM_ENVELOPE_PERIOD_MS': ('envelope', 'effect_envelope_set_period'),
+        'PARAM_ENVELOPE_DUTY_CYCLE': ('envelope', 'effect_envelope_set_duty_cycle'),
+        'PARAM_ENVELOPE_FLOOR': ('envelope', 'effect_envelope_set_floor'),
+        'PARAM_LFO_FREQ_MHZ': ('modulation', 'effect_modulation_set_freq'),
+    }
+
+    lines = []
+    for param, (module, setter) in setters.items():
+        if param not in settings.get(('voice', module), {}).values():
+            continue
+        if lines:
+            lines.append('')
+        lines += [
+            'if (changed & PARAM_MASK({})) {{'.format(param),
+            '    const float value = {};'.format(conversions[param]),
+            '',
+        ]
+        lines += ['    {}(&{}, value);'.format(setter, state(v, module)) for v in range(args.voices)]
+        lines += ['}']
+
+    # the lowpass cutoffs are read for each block, and ramped there
+    if settings.get(('bus', 'echo'), {}).get('feedback') == 'PARAM_ECHO_FEEDBACK':
+        if lines:
+            lines.append('')
+        lines += [
+            'if (changed & PARAM_MASK(PARAM_ECHO_FEEDBACK)) {',
+            '    effect_echo_set_feedback_target(&_bus_echo, param_store_get(PARAM_ECHO_FEEDBACK));',
+            '}',
+        ]
+
+    return lines or ['ARG_UNUSED(changed);']
+
+
+def indent(lines, level=1):
+    return ''.join(('    ' * level + line if line else '') + '\n' for line in '\n'.join(lines).split('\n'))
+
+
+used = sorted(set(m for m in voice_modules + [m for m, _ in bus] if m in HEADERS), key=list(HEADERS).index)
+voice_cutoff = settings.get(('voice', 'lowpass'), {}).get('cutoff')
+bus_cutoff = settings.get(('bus', 'lowpass'), {}).get('cutoff')
+
+with open(args.output, 'w') as f:
+    f.write('/* generated by scripts/patch.py from {}, do not edit */\n\n'.format(args.description.replace('\\', '/').split('/')[-1]))
+    f.write('#include "patch.h"\n\n')
+    if 'allpass' in voice_params:
+        f.write('#include <string.h>\n')
+    f.write('#include <zephyr/kernel.h>\n\n')
+    f.write('#include "integer_math.h"\n')
+    f.write('#include "param_store.h"\n')
+    for module in used:
+        f.write('#include "{}"\n'.format(HEADERS[module]))
+    f.write('\n')
+
+    for v in range(args.voices):
+        for module, params in voice:
+            s = state(v, module)
+            if module == 'oscillator':
+                f.write('static struct oscillator {};\n'.format(s))
+            elif module == 'envelope':
+                f.write('static struct effect_envelope {};\n'.format(s))
+            elif module == 'lowpass':
+                f.write('static int32_t {};\n'.format(s))
+            elif module == 'allpass':
+                f.write('static fixed16 {}_buffer[{}];\n'.format(s, delay_frames(module, params)))
+                f.write('static uint32_t {}_index;\n'.format(s))
+            elif module == 'modulation':
+                f.write('static struct effect_modulation {};\n'.format(s))
+    if bound(voice_cutoff):
+        f.write('static fixed16 _voice_lowpass_cutoff;\n')
+    for module, params in bus:
+        if module == 'echo':
+            f.write('static stereo16 _bus_echo_buffer[{}];\n'.format(delay_frames(module, params)))
+            f.write('static struct effect_echo _bus_echo;\n')
+        elif module == 'lowpass':
+            f.write('static int32_t _bus_lowpass_state[2];\n')
+            if bound(bus_cutoff):
+                f.write('static fixed16 _bus_lowpass_cutoff;\n')
+    f.write('\n')
+
+    if voice_cutoff is not None:
+        f.write('\n'.join(lowpass_kernel('voice')) + '\n')
+    if 'allpass' in voice_params:
+        f.write('\n'.join(allpass_kernel()) + '\n')
+    if bus_cutoff is not None:
+        f.write('\n'.join(lowpass_kernel('bus')) + '\n')
+
+    f.write('void patch_init(void)\n{\n')
+    for v in range(args.voices):
+        f.write(indent(voice_init(v)))
+    if bound(voice_cutoff):
+        f.write('    _voice_lowpass_cutoff = param_store_get(PARAM_FILTER_CUTOFF);\n')
+    f.write(indent(bus_init()))
+    if bound(bus_cutoff):
+        f.write('    _bus_lowpass_cutoff = param_store_get(PARAM_FILTER_CUTOFF);\n')
+    f.write('\n    patch_params_apply(PARAM_MASK_ALL);\n')
+    f.write('}\n\n')
+
+    f.write('void patch_params_apply(uint32_t changed)\n{\n')
+    f.write(indent(params_apply()))
+    f.write('}\n\n')
+
+    f.write('void patch_note_on(int voice, uint32_t phase_increment, fixed16 amplitude)\n{\n')
+    f.write('    switch (voice) {\n')
+    for v in range(args.voices):
+        lines = [
+            'osc_set_phase_increment(&{}, phase_increment);'.format(state(v, 'oscillator')),
+            'osc_set_amplitude(&{}, amplitude);'.format(state(v, 'oscillator')),
+        ]
+        if envelope is not None:
+            lines.append('effect_envelope_start(&{});'.format(state(v, 'envelope')))
+        f.write('        case {}:\n'.format(v))
+        f.write(indent(lines + ['break;'], 3))
+    f.write('    }\n}\n\n')
+
+    f.write('void patch_note_off(int voice)\n{\n')
+    f.write('    switch (voice) {\n')
+    for v in range(args.voices):
+        if envelope is not None:
+            lines = ['effect_envelope_end(&{});'.format(state(v, 'envelope'))]
+        else:
+            lines = ['osc_set_amplitude(&{}, 0);'.format(state(v, 'oscillator'))]
+        f.write('        case {}:\n'.format(v))
+        f.write(indent(lines + ['break;'], 3))
+    f.write('    }\n}\n\n')
+
+    f.write('void patch_voices_process(stereo16* block, size_t block_size)\n{\n')
+    f.write('    fixed16 voice[block_size];\n\n')
+    if bound(voice_cutoff):
+        f.write(indent(cutoff_ramp('voice')))
+    f.write('\n'.join(indent(voice_process(v)) for v in range(args.voices)))
+    f.write('}\n\n')
+
+    f.write('void patch_bus_process(stereo16* block, size_t block_size)\n{\n')
+    if bound(bus_cutoff):
+        f.write(indent(cutoff_ramp('bus')))
+    f.write(indent(bus_process()) if bus else '    ARG_UNUSED(block);\n    ARG_UNUSED(block_size);\n')
+    f.write('}\n')
+
+print('patch: {} voices of {}, bus {}'.format(args.voices, ' -> '.join(m for m, _ in voice), ' -> '.join(m for m, _ in bus) or 'empty'))
@@ -0,0 +1,66 @@
+# Generates C tables for integer pitch computation
+#
+# midi_note_to_frequency: frequency in Hz of each MIDI note
+# note_phase_increment: phase increment for each MIDI note
+# fine_tune_ratio: ratio between a note and the next 1/STEPS semitones, in Q31
+# pitch_table_sample_rate_hz: rate the increments are computed for
+# pitch_table_max: highest pitch whose phase increment is below Nyquist
+
+import argparse
+import math
+
+N = 128
+STEPS = 64
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--sample-rate', type=int, required=True, help='rate at which the phase accumulators are incremented')
+parser.add_argument('--output', required=True)
+args = parser.parse_args()
+
+frequencies = []
+increments = []
+for n in range(N):
+    freq = 440 * 2 ** ((n - 69) / 12)
+    frequencies.append(freq)
+    # notes above Nyquist are never looked up, but must still fit in uint32_t
+    increments.append(min(round(freq / args.sample_rate * 2**32), 2**32 - 1))
+
+ratios = []
+for s in range(STEPS):
+    ratios.append(round(2 ** (s / (12 * STEPS)) * 2**31))
+
+# same integer arithmetic as pitch_to_phase_increment(), the oscillator requires
+# increments below UINT32_MAX / 2
+pitch_max = -1
+for pitch in range(N * STEPS):
+    if (increments[pitch // STEPS] * ratios[pitch % STEPS]) >> 31 >= (2**32 - 1) // 2:
+        break
+    pitch_max = pitch
+if pitch_max < 0:
+    raise SystemExit('pitch_table.py: sample rate {} Hz is too low for any note'.format(args.sample_rate))
+
+with open(args.output, 'w') as f:
+    f.write('/* generated by scripts/pitch_table.py, do not edit */\n\n')
+    f.write('#include "pitch_table.h"\n')
+    f.write('#include "midi_note_to_frequency.h"\n\n')
+    f.write('const uint32_t pitch_table_sample_rate_hz = {};\n\n'.format(args.sample_rate))
+    f.write('const int32_t pitch_table_max = {};\n\n'.format(pitch_max))
+    f.write('const float midi_note_to_frequency[{}] = {{'.format(N))
+    f.write(','.join('{}f'.format(repr(x)) for x in frequencies))
+    f.write('};\n\n')
+    f.write('const uint32_t note_phase_increment[{}] = {{'.format(N))
+    f.write(','.join(map(str, increments)))
+    f.write('};\n\n')
+    f.write('const uint32_t fine_tune_ratio[{}] = {{'.format(STEPS))
+    f.write(','.join(map(str, ratios)))
+    f.write('};\n')
+
+sizes = [
+    ('midi_note_to_frequency', N, 'float', 4),
+    ('note_phase_increment', N, 'uint32_t', 4),
+    ('fine_tune_ratio', STEPS, 'uint32_t', 4),
+]
+for name, count, ctype, octets in sizes:
+    print('{}: {} x {} = {} bytes'.format(name, count, ctype, count * octets))
+print('highest pitch below Nyquist: note {} + {}/{}'.format(pitch_max // STEPS, pitch_max % STEPS, STEPS))
+print('pitch tables: {} bytes'.format(sum(count * octets for _, count, _, octets in sizes)))
@@ -0,0 +1,151 @@
+# Builds a sample bank image for the flash partition sample_partition
+#
+# Each sample is given as path[:key=value,...] with the keys
+#   format=pcm|adpcm  (default adpcm)
+#   root=<midi note>  note the sample is recorded at (default 60)
+#   loop=<start>-<end> loop points in samples, one shot if omitted
+#
+# Input is 16-bit WAV, mixed down to mono. The image is written as raw
+# binary, or as Intel HEX when an address is given.
+
+import argparse
+import struct
+import wave
+
+MAGIC = 0x4B4E4253
+VERSION = 1
+HEADER = struct.Struct('<IHH')
+ENTRY = struct.Struct('<IIIIIBBBB')
+
+FORMAT_PCM16 = 0
+FORMAT_IMA_ADPCM = 1
+MODE_ONE_SHOT = 0
+MODE_LOOP = 1
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+
+
+def read_wav(path):
+    with wave.open(path, 'rb') as w:
+        if w.getsampwidth() != 2:
+            raise SystemExit('{}: only 16-bit wav is supported'.format(path))
+        channels = w.getnchannels()
+        frames = w.readframes(w.getnframes())
+        rate = w.getframerate()
+    values = struct.unpack('<{}h'.format(len(frames) // 2), frames)
+    mono = [sum(values[i:i + channels]) // channels for i in range(0, len(values), channels)]
+    return mono, rate
+
+
+def adpcm_encode(samples):
+    predictor, index = 0, 0
+    nibbles = []
+    for sample in samples:
+        step = STEP_TABLE[index]
+        diff = sample - predictor
+        nibble = 0
+        if diff < 0:
+            nibble = 8
+            diff = -diff
+        for bit, scale in ((4, step), (2, step >> 1), (1, step >> 2)):
+            if diff >= scale:
+                nibble |= bit
+                diff -= scale
+
+        # track the decoder exactly, including its rounding
+        delta = step >> 3
+        if nibble & 4: delta += step
+        if nibble & 2: delta += step >> 1
+        if nibble & 1: delta += step >> 2
+        predictor += -delta if nibble & 8 else delta
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + INDEX_TABLE[nibble]))
+
+        nibbles.append(nibble)
+
+    if len(nibbles) % 2:
+        nibbles.append(0)
+    return bytes(nibbles[i] | (nibbles[i + 1] << 4) for i in range(0, len(nibbles), 2))
+
+
+def parse_sample(arg):
+    path, _, options = arg.partition(':')
+    config = {'format': 'adpcm', 'root': '60', 'loop': None}
+    for option in filter(None, options.split(',')):
+        key, _, value = option.partition('=')
+        if key not in config:
+            raise SystemExit('unknown sample option {}'.format(key))
+        config[key] = value
+    return path, config
+
+
+def write_hex(path, data, address):
+    def record(kind, offset, payload):
+        line = bytes([len(payload), (offset >> 8) & 0xFF, offset & 0xFF, kind]) + payload
+        return ':{}{:02X}\n'.format(line.hex().upper(), (-sum(line)) & 0xFF)
+
+    with open(path, 'w') as f:
+        upper = None
+        for i in range(0, len(data), 16):
+            current = address + i
+            if current >> 16 != upper:
+                upper = current >> 16
+                f.write(record(4, 0, struct.pack('>H', upper)))
+            f.write(record(0, current & 0xFFFF, data[i:i + 16]))
+        f.write(record(1, 0, b''))
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('samples', nargs='+', help='path[:format=pcm|adpcm,root=60,loop=start-end]')
+parser.add_argument('--output', required=True)
+parser.add_argument('--hex-address', type=lambda x: int(x, 0), help='write intel hex at this flash address')
+args = parser.parse_args()
+
+entries = []
+payloads = []
+offset = HEADER.size + ENTRY.size * len(args.samples)
+
+for arg in args.samples:
+    path, config = parse_sample(arg)
+    samples, rate = read_wav(path)
+
+    if config['format'] == 'pcm':
+        data, fmt = struct.pack('<{}h'.format(len(samples)), *samples), FORMAT_PCM16
+    elif config['format'] == 'adpcm':
+        data, fmt = adpcm_encode(samples), FORMAT_IMA_ADPCM
+    else:
+        raise SystemExit('unknown format {}'.format(config['format']))
+
+    if config['loop']:
+        loop_start, loop_end = (int(x) for x in config['loop'].split('-'))
+        if not 0 <= loop_start < loop_end <= len(samples):
+            raise SystemExit('{}: invalid loop points'.format(path))
+        mode = MODE_LOOP
+    else:
+        loop_start, loop_end, mode = 0, len(samples), MODE_ONE_SHOT
+
+    entries.append(ENTRY.pack(offset, len(samples), loop_start, loop_end, rate, fmt, mode, int(config['root']), 0))
+    data += bytes(-len(data) % 4)
+    payloads.append(data)
+    offset += len(data)
+
+    print('{}: {} samples at {} Hz, {} bytes'.format(path, len(samples), rate, len(data)))
+
+image = HEADER.pack(MAGIC, VERSION, len(entries)) + b''.join(entries) + b''.join(payloads)
+
+if args.hex_address is None:
+    with open(args.output, 'wb') as f:
+        f.write(image)
+else:
+    write_hex(args.output, image, args.hex_address)
+
+print('sample bank: {} bytes'.format(len(image)))
@@ -0,0 +1,178 @@
+# Builds a sequencer image for the flash partition pattern_partition
+#
+# The song is described in a YAML file, see sequence.yaml. Each pattern has
+# a number of steps and up to 16 tracks, and each track gives the steps it
+# plays as step: note, or step: {note, velocity, gate, lock}. Drum tracks play
+# the percussion voices by general MIDI note, kick, snare or hat. Locks set
+# parameters for the step they are on. The image is written as raw binary,
+# or as Intel HEX when an address is given.
+
+import argparse
+import struct
+import sys
+
+import yaml
+
+MAGIC = 0x434E5153
+VERSION = 1
+HEADER = struct.Struct('<IHHHH')
+PATTERN = struct.Struct('<HHHBB')
+
+TRACKS_MAX = 16
+EVENT_NOTE = 1 << 4
+EVENT_LOCK = 1 << 5
+
+INT16_MAX = 2**15 - 1
+
+# index in enum param, whether the value is fixed16, and the range of the
+# value as in _ranges of src/synthesizer/param_store.c, which rejects the rest
+PARAMS = {
+    'echo_delay_ms': (0, False, 1, 250),
+    'echo_feedback': (1, True, 0, INT16_MAX),
+    'filter_cutoff': (2, True, 0, INT16_MAX),
+    'envelope_period_ms': (3, False, 1, 10000),
+    'envelope_duty_cycle': (4, True, 0, INT16_MAX),
+    'envelope_floor': (5, True, 0, INT16_MAX),
+    'lfo_freq_mhz': (6, False, 0, 20000),
+}
+
+DRUMS = {'kick': 36, 'snare': 38, 'hat': 42}
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--description', required=True, help='song description in YAML')
+parser.add_argument('--output', required=True)
+parser.add_argument('--hex-address', type=lambda x: int(x, 0), help='write intel hex at this flash address')
+args = parser.parse_args()
+
+
+def fail(message):
+    sys.exit('{}: {}'.format(args.description, message))
+
+
+def lock_value(name, value):
+    if name not in PARAMS:
+        fail('unknown parameter {}'.format(name))
+    index, fixed, minimum, maximum = PARAMS[name]
+    value = round(float(value) * INT16_MAX) if fixed else int(value)
+    if not minimum <= value <= maximum:
+        if fixed:
+            fail('{} of {:.4f} out of range [{}, {}]'.format(name, value / INT16_MAX, minimum / INT16_MAX, maximum / INT16_MAX))
+        fail('{} of {} out of range [{}, {}]'.format(name, value, minimum, maximum))
+    return index, value
+
+
+def encode_event(track, step, drum):
+    if not isinstance(step, dict):
+        step = {'note': step}
+
+    flags = track
+    data = b''
+
+    note = step.get('note')
+    if note is not None:
+        note = DRUMS.get(note, note) if drum else note
+        velocity = int(step.get('velocity', 100))
+        gate = int(step.get('gate', 1))
+        if not (0 <= int(note) <= 127 and 0 <= velocity <= 127 and 1 <= gate <= 255):
+            fail('invalid note {}'.format(step))
+        flags |= EVENT_NOTE
+        data += bytes([int(note), velocity, gate])
+
+    events = []
+    for name, value in (step.get('lock') or {}).items():
+        index, value = lock_value(name, value)
+        if flags & EVENT_LOCK:
+            # one lock per event, further locks are events of their own on the same track
+            events.append(bytes([track | EVENT_LOCK]) + struct.pack('<Bh', index, value))
+            continue
+        flags |= EVENT_LOCK
+        data += struct.pack('<Bh', index, value)
+
+    return [bytes([flags]) + data] + events
+
+
+def encode_pattern(name, pattern):
+    steps = int(pattern.get('steps', 16))
+    ticks_per_step = int(pattern.get('ticks_per_step', 6))
+    tracks = pattern.get('tracks') or []
+
+    if not 1 <= steps <= 0xFFFF or not 1 <= ticks_per_step <= 255:
+        fail('pattern {} has invalid steps or ticks_per_step'.format(name))
+    if len(tracks) > TRACKS_MAX:
+        fail('pattern {} has more than {} tracks'.format(name, TRACKS_MAX))
+
+    events = [[] for _ in range(steps)]
+    drum_tracks = 0
+    for track, description in enumerate(tracks):
+        drum = bool(description.get('drum', False))
+        if drum:
+            drum_tracks |= 1 << track
+        for step, event in (description.get('steps') or {}).items():
+            if not 0 <= int(step) < steps:
+                fail('pattern {} has no step {}'.format(name, step))
+            events[int(step)] += encode_event(track, event, drum)
+
+    data = b''.join(bytes([len(e)]) + b''.join(e) for e in events)
+    if len(data) > 0xFFFF:
+        fail('pattern {} is too large'.format(name))
+
+    return PATTERN.pack(steps, len(data), drum_tracks, ticks_per_step, 0) + data, max(len(e) for e in events)
+
+
+def write_hex(path, data, address):
+    def record(kind, offset, payload):
+        line = bytes([len(payload), (offset >> 8) & 0xFF, offset & 0xFF, kind]) + payload
+        return ':{}{:02X}\n'.format(line.hex().upper(), (-sum(line)) & 0xFF)
+
+    with open(path, 'w') as f:
+        upper = None
+        for i in range(0, len(data), 16):
+            current = address + i
+            if current >> 16 != upper:
+                upper = current >> 16
+                f.write(record(4, 0, struct.pack('>H', upper)))
+            f.write(record(0, current & 0xFFFF, data[i:i + 16]))
+        f.write(record(1, 0, b''))
+
+
+with open(args.description) as f:
+    description = yaml.safe_load(f) or {}
+
+patterns = description.get('patterns') or {}
+if not patterns:
+    fail('no patterns')
+if len(patterns) > 255:
+    fail('more than 255 patterns')
+
+names = list(patterns)
+song = []
+for name in description.get('song') or []:
+    if name not in patterns:
+        fail('song plays unknown pattern {}'.format(name))
+    song.append(names.index(name))
+
+encoded = [encode_pattern(name, patterns[name]) for name in names]
+
+offset = HEADER.size + 4 * len(names) + len(song)
+offset += -offset % 4
+offsets = []
+payloads = []
+for data, _ in encoded:
+    data += bytes(-len(data) % 4)
+    offsets.append(offset)
+    payloads.append(data)
+    offset += len(data)
+
+table = HEADER.pack(MAGIC, VERSION, len(names), len(song), 0) + struct.pack('<{}I'.format(len(offsets)), *offsets) + bytes(song)
+table += bytes(-len(table) % 4)
+image = table + b''.join(payloads)
+
+if args.hex_address is None:
+    with open(args.output, 'wb') as f:
+        f.write(image)
+else:
+    write_hex(args.output, image, args.hex_address)
+
+for name, (data, events) in zip(names, encoded):
+    print('{}: {} bytes, at most {} events in a step'.format(name, len(data), events))
+print('sequencer image: {} patterns, song of {}, {} bytes'.format(len(names), len(song), len(image)))
@@ -0,0 +1,150 @@
+# Converts a standard MIDI file, type 0 or 1, to a flat event array in C
+#
+# smf_events: channel messages and tempo changes of all tracks, sorted by
+#   time in ticks of the tick provider, 24 per quarter note, with the rest
+#   of a tick in 1/256. Note offs come first among events at the same time.
+#   Tempo changes carry the tempo in 1/256 bpm, below 256 bpm.
+# smf_song_ticks: length of the song, to the end of the longest track
+#
+# Note on with velocity 0 is converted to note off, system exclusive and meta
+# events other than tempo are left out.
+
+import argparse
+import struct
+import sys
+
+TICKS_PER_QUARTER_NOTE = 24
+FRACTION_STEPS = 256
+TEMPO_STEPS = 256
+EVENT_TEMPO = 0xFF
+
+DATA_BYTES = {0x80: 2, 0x90: 2, 0xA0: 2, 0xB0: 2, 0xC0: 1, 0xD0: 1, 0xE0: 2}
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--input', required=True, help='standard MIDI file')
+parser.add_argument('--output', required=True)
+args = parser.parse_args()
+
+
+def fail(message):
+    sys.exit('{}: {}'.format(args.input, message))
+
+
+def read_varlen(data, i):
+    value = 0
+    while True:
+        if i >= len(data):
+            fail('truncated variable length value')
+        byte = data[i]
+        i += 1
+        value = (value << 7) | (byte & 0x7F)
+        if byte & 0x80 == 0:
+            return value, i
+
+
+def read_track(data):
+    # (time, order, status, data0, data1) with time in file ticks
+    events = []
+    time = 0
+    status = None
+    i = 0
+    while i < len(data):
+        delta, i = read_varlen(data, i)
+        time += delta
+
+        byte = data[i]
+        if byte == 0xFF:
+            kind = data[i + 1]
+            length, i = read_varlen(data, i + 2)
+            if kind == 0x51 and length == 3:
+                tempo_us = int.from_bytes(data[i:i + 3], 'big')
+                events.append((time, 0, EVENT_TEMPO, tempo_us))
+            elif kind == 0x2F:
+                return events, time
+            i += length
+            # meta and system exclusive events cancel running status
+            status = None
+            continue
+        if byte in (0xF0, 0xF7):
+            length, i = read_varlen(data, i + 1)
+            i += length
+            status = None
+            continue
+
+        # running status
+        if byte & 0x80:
+            status = byte
+            i += 1
+        elif status is None:
+            fail('data byte without status')
+
+        count = DATA_BYTES.get(status & 0xF0)
+        if count is None:
+            fail('unsupported status 0x{:02x}'.format(status))
+        values = list(data[i:i + count]) + [0] * (2 - count)
+        i += count
+
+        if status & 0xF0 == 0x90 and values[1] == 0:
+            events.append((time, 0, 0x80 | (status & 0x0F), values[0], 0))
+        else:
+            events.append((time, 0 if status & 0xF0 == 0x80 else 1, status, values[0], values[1]))
+
+    return events, time
+
+
+with open(args.input, 'rb') as f:
+    data = f.read()
+
+if data[:4] != b'MThd':
+    fail('not a standard MIDI file')
+header_length = struct.unpack('>I', data[4:8])[0]
+file_format, track_count, division = struct.unpack('>HHH', data[8:14])
+if file_format not in (0, 1):
+    fail('type {} is not supported, only type 0 and 1'.format(file_format))
+if division & 0x8000:
+    fail('SMPTE time division is not supported')
+
+events = []
+length = 0
+i = 8 + header_length
+for track in range(track_count):
+    kind, size = struct.unpack('>4sI', data[i:i + 8])
+    i += 8
+    if kind == b'MTrk':
+        track_events, end = read_track(data[i:i + size])
+        events += track_events
+        length = max(length, end)
+    i += size
+
+# sorted is stable, events at the same time keep the order of the file within their priority
+events = sorted(events, key=lambda e: (e[0], e[1]))
+
+
+def tick(time):
+    position = time * TICKS_PER_QUARTER_NOTE * FRACTION_STEPS // division
+    return position // FRACTION_STEPS, position % FRACTION_STEPS
+
+
+lines = []
+for event in events:
+    ticks, fraction = tick(event[0])
+    if event[2] == EVENT_TEMPO:
+        tempo = round(60e6 * TEMPO_STEPS / event[3])
+        if tempo > 0xFFFF:
+            fail('tempo of {:.2f} bpm is above the highest supported'.format(60e6 / event[3]))
+        lines.append('{{{}, {}, SMF_EVENT_TEMPO, {{{}, {}}}}}, /* {:.3f} bpm */'.format(ticks, fraction, tempo & 0xFF, tempo >> 8, tempo / TEMPO_STEPS))
+    else:
+        lines.append('{{{}, {}, 0x{:02X}, {{{}, {}}}}},'.format(ticks, fraction, event[2], event[3], event[4]))
+
+song_ticks = max(-(-length * TICKS_PER_QUARTER_NOTE // division), 1)
+
+with open(args.output, 'w') as f:
+    f.write('/* generated by scripts/smf.py from {}, do not edit */\n\n'.format(args.input.replace('\\', '/').split('/')[-1]))
+    f.write('#include "smf_player.h"\n\n')
+    f.write('const struct smf_event smf_events[] = {\n')
+    f.write(''.join('    {}\n'.format(line) for line in lines))
+    f.write('};\n\n')
+    f.write('const size_t smf_event_count = {};\n'.format(len(lines)))
+    f.write('const uint32_t smf_song_ticks = {};\n'.format(song_ticks))
+
+print('smf: type {}, {} tracks, {} events = {} bytes, {} ticks'.format(file_format, track_count, len(lines), len(lines) * 8, song_ticks))
@@ -0,0 +1,31 @@
+# Generates the mapping from MIDI velocity to note gain
+#
+# velocity_curve: gain in Q15 for each velocity. Velocity 0 is silent, 127 is
+# full scale. The square law follows perceived loudness closer than linear.
+
+import argparse
+
+N = 128
+INT16_MAX = 2**15 - 1
+
+CURVES = {
+    'linear': lambda v: v,
+    'square': lambda v: v**2,
+    'fixed': lambda v: 1.0 if v > 0 else 0.0,
+}
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--curve', choices=CURVES, required=True)
+parser.add_argument('--output', required=True)
+args = parser.parse_args()
+
+gains = [round(CURVES[args.curve](v / (N - 1)) * INT16_MAX) for v in range(N)]
+
+with open(args.output, 'w') as f:
+    f.write('/* generated by scripts/velocity_curve.py, do not edit */\n\n')
+    f.write('#include "velocity_curve.h"\n\n')
+    f.write('const fixed16 velocity_curve[{}] = {{'.format(N))
+    f.write(','.join(map(str, gains)))
+    f.write('};\n')
+
+print('velocity_curve: {}, {} x fixed16 = {} bytes'.format(args.curve, N, N*2))
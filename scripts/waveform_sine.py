@@ -1,15 +1,39 @@
+# Generates the C sine table used by the oscillators and LFOs
+#
+# One extra sample is appended, since interpolation between sample i and i+1
+# then never has to check for wrap around
 
+import argparse
 import math
 
-UINT16_MAX = 32767
-N = 256
+FORMATS = {
+    'q15': ('int16_t', 2**15 - 1, 2),
+    'q31': ('int32_t', 2**31 - 1, 4),
+}
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--bits', type=int, default=8, help='table length as a power of two')
+parser.add_argument('--format', choices=FORMATS.keys(), default='q15')
+parser.add_argument('--output', help='C source to write, prints the table if omitted')
+args = parser.parse_args()
+
+ctype, scale, octets = FORMATS[args.format]
+N = 2**args.bits
 
 Y = []
 for n in range(N+1):
     x = 2*math.pi*n/N
-    y = round(UINT16_MAX*math.sin(x))
+    y = round(scale*math.sin(x))
     Y.append(y)
 
-print('{', end='')
-print(','.join(map(str, Y)), end='')
-print('};')
\ No newline at end of file
+table = '{' + ','.join(map(str, Y)) + '}'
+
+if args.output is None:
+    print(table + ';')
+else:
+    with open(args.output, 'w') as f:
+        f.write('/* generated by scripts/waveform_sine.py, do not edit */\n\n')
+        f.write('#include "dsp/waveforms.h"\n\n')
+        f.write('const {} sinus_samples[{}] = {};\n'.format(ctype, N+1, table))
+
+    print('sinus_samples: {} x {} = {} bytes'.format(N+1, ctype, (N+1)*octets))
@@ -0,0 +1,66 @@
+# Generates band-limited wavetables, one mip level per octave
+#
+# Level l contains at most (N/2 >> l) harmonics, thus the level to use is
+# selected from the oscillator phase increment. Every frame is generated by
+# additive synthesis, and normalized by its peak across all levels.
+
+import argparse
+import math
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--bits', type=int, default=8, help='frame length as a power of two')
+parser.add_argument('--levels', type=int, default=8, help='number of octave mip levels')
+parser.add_argument('--output', required=True)
+args = parser.parse_args()
+
+N = 2**args.bits
+INT16_MAX = 2**15 - 1
+
+
+def sine(h):
+    return 1 if h == 1 else 0
+
+def triangle(h):
+    return 0 if h % 2 == 0 else (-1)**((h-1)//2) / h**2
+
+def sawtooth(h):
+    return (-1)**(h+1) / h
+
+def square(h):
+    return 0 if h % 2 == 0 else 1 / h
+
+# morph order, adjacent frames should be similar in timbre
+FRAMES = [sine, triangle, sawtooth, square]
+
+
+def render(harmonic, max_harmonic):
+    Y = []
+    for n in range(N+1):
+        x = 2*math.pi*n/N
+        Y.append(sum(harmonic(h)*math.sin(h*x) for h in range(1, max_harmonic+1)))
+    return Y
+
+
+tables = []
+for harmonic in FRAMES:
+    levels = [render(harmonic, max(1, (N//2) >> l)) for l in range(args.levels)]
+    peak = max(abs(y) for level in levels for y in level)
+    tables.append([[round(INT16_MAX*y/peak) for y in level] for level in levels])
+
+with open(args.output, 'w') as f:
+    f.write('/* generated by scripts/wavetable.py, do not edit */\n\n')
+    f.write('#include "dsp/wavetable.h"\n\n')
+    f.write('const fixed16 wavetable_basic_samples[{}][{}][{}] = {{\n'.format(args.levels, len(FRAMES), N+1))
+    for l in range(args.levels):
+        f.write('    {\n')
+        for frame in tables:
+            f.write('        {' + ','.join(map(str, frame[l])) + '},\n')
+        f.write('    },\n')
+    f.write('};\n\n')
+    f.write('const struct wavetable wavetable_basic = {\n')
+    f.write('    .samples = &wavetable_basic_samples[0][0][0],\n')
+    f.write('    .frames = {},\n'.format(len(FRAMES)))
+    f.write('};\n')
+
+size = args.levels*len(FRAMES)*(N+1)*2
+print('wavetable_basic: {} levels x {} frames x {} x int16_t = {} bytes'.format(args.levels, len(FRAMES), N+1, size))
@@ -1,5 +1,6 @@
 #include "audio_process.h"
 
+#include <stdlib.h>
 #include <zephyr/kernel.h>
 #include "sw_codec.h"
 #include "macros_common.h"
@@ -7,16 +8,60 @@
 #include "button.h"
 #include "synthesizer.h"
 #include "tick_provider.h"
+#include "event_calendar.h"
 #include "integer_math.h"
+#include "pcm_convert.h"
+
+#if CONFIG_SYNTH_BENCHMARK
+#include "benchmark.h"
+#endif
+
+#if CONFIG_MIDI_UART
+#include "midi_uart.h"
+#endif
+
+#if CONFIG_BLE_MIDI
+#include "ble_midi.h"
+#endif
+
+#if CONFIG_KEYBOARD
+#include "keyboard.h"
+#include "velocity_curve.h"
+#endif
+
+#if CONFIG_MIDI
+#include "audio_sync_timer.h"
+#endif
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(audio_process, CONFIG_LOG_AUDIO_PROCESS_LEVEL);
 
+BUILD_ASSERT(CONFIG_I2S_CH_NUM == 2, "the synthesizer renders stereo frames");
+BUILD_ASSERT(AUDIO_BLOCK_FRAMES % CONFIG_SYNTH_CONTROL_RATE_SAMPLES == 0, "control rate must divide the block at this sample rate and frame duration");
+
 static struct sw_codec_config _sw_codec_config;
 static bool _audio_codec_started;
 
 static void _audio_process_work_submit(struct k_timer * _unused);
 static void _audio_process(struct k_work * _unused);
+static size_t _scheduled_process(bus_frame* block);
+static size_t _render_until(bus_frame* block, size_t rendered, size_t frame);
+#if CONFIG_MIDI
+static void _block_time_update(void);
+static void _midi_event(const struct midi_message* message);
+#endif
+#if CONFIG_MIDI_UART
+static void _midi_input_process(void);
+#endif
+#if CONFIG_KEYBOARD
+static void _keyboard_input_process(void);
+#endif
+#if CONFIG_BLE_MIDI
+static size_t _midi_scheduled_process(bus_frame* block, size_t rendered, size_t end);
+#endif
+#if CONFIG_MIDI_CLOCK_OUT
+static void _midi_clock_out_tick(void);
+#endif
 
 K_TIMER_DEFINE(_encoder_timer, _audio_process_work_submit, NULL);
 
@@ -26,11 +71,27 @@ K_WORK_DEFINE(_encoder_work, _audio_process);
 
 static struct tick_provider_subscriber _syntheiziser_tick_provider;
 
+#if CONFIG_MIDI_CLOCK_OUT
+static struct tick_provider_subscriber _midi_clock_out_tick_provider;
+#endif
+
+#if CONFIG_MIDI
+/* audio sync timer time of the start of the block being rendered, advanced by one frame per block */
+static uint32_t _block_time;
+#endif
+
 void audio_process_init(void) {
 	
+	event_calendar_init();
+
 	LOG_DBG("synthesizer init");
 	synthesizer_init();
 
+#if CONFIG_SYNTH_BENCHMARK
+	LOG_DBG("synthesizer benchmark");
+	synthesizer_benchmark_run();
+#endif
+
 	LOG_DBG("tick provider init");
 	tick_provider_init();
 	
@@ -38,6 +99,14 @@ void audio_process_init(void) {
 	tick_provider_set_bpm(128);
 	tick_provider_subscribe(&_syntheiziser_tick_provider, synthesizer_tick);
 
+#if CONFIG_MIDI_CLOCK_FOLLOW
+	tick_provider_set_external(true);
+#endif
+
+#if CONFIG_MIDI_CLOCK_OUT
+	tick_provider_subscribe(&_midi_clock_out_tick_provider, _midi_clock_out_tick);
+#endif
+
 	/* audio blocks processed through a queue */
 	// TODO: since the interval is the same as ble connection interval should it instead be directly syncronized with this interval. For example by radio notify interrupt.
 	k_work_queue_init(&_encoder_work_queue);
@@ -106,16 +175,32 @@ static void _audio_process_work_submit(struct k_timer * _unused) {
 static void _audio_process(struct k_work * _unused) {
 	if (_sw_codec_config.encoder.enabled) {
 		
-		static fixed16 _audio_buf[AUDIO_BLOCK_SIZE];
-		memset(_audio_buf, 0, AUDIO_BLOCK_SIZE * sizeof _audio_buf[0]);
+		static bus_frame _audio_buf[AUDIO_BLOCK_FRAMES];
+		memset(_audio_buf, 0, AUDIO_BLOCK_FRAMES * sizeof _audio_buf[0]);
+
+#if CONFIG_MIDI
+		_block_time_update();
+#endif
+
+#if CONFIG_MIDI_UART
+		/* input received since the last block, applied before it is rendered */
+		_midi_input_process();
+#endif
+
+#if CONFIG_KEYBOARD
+		_keyboard_input_process();
+#endif
+
+		/* events and messages due within this block are applied where they fall in it */
+		const size_t rendered = _scheduled_process(_audio_buf);
 
 		/* audio proccessing here */
-		const bool did_process = synthesizer_process(_audio_buf, AUDIO_BLOCK_SIZE);
+		const bool did_process = synthesizer_process(_audio_buf + rendered, AUDIO_BLOCK_FRAMES - rendered);
 		(void)did_process;
 
 		size_t encoded_data_size = 0;
 		static uint8_t *encoded_data;
-		int ret = sw_codec_encode(_audio_buf, FRAME_SIZE_BYTES, &encoded_data, &encoded_data_size);
+		int ret = sw_codec_encode(pcm_convert(_audio_buf), FRAME_SIZE_BYTES, &encoded_data, &encoded_data_size);
 
 		ERR_CHK_MSG(ret, "Encode failed");
 
@@ -126,3 +211,152 @@ static void _audio_process(struct k_work * _unused) {
 		tick_provider_increment();
 	}
 }
+
+#if CONFIG_MIDI_UART
+/* messages dropped by the UART interrupt as of the last block */
+static uint32_t _midi_dropped;
+
+static void _midi_input_process(void) {
+	struct midi_message message;
+
+	while (midi_uart_get(&message)) {
+		/* time from arrival until the message is applied, audio follows in this block */
+		const uint32_t latency = audio_sync_timer_curr_time_get() - message.timestamp;
+		LOG_DBG("midi 0x%02x applied %u us after arrival", message.type, latency);
+
+		_midi_event(&message);
+	}
+
+	const uint32_t dropped = midi_uart_dropped();
+	if (dropped != _midi_dropped) {
+		LOG_WRN("%u MIDI messages dropped, queue full", dropped - _midi_dropped);
+		_midi_dropped = dropped;
+	}
+}
+#endif
+
+#if CONFIG_KEYBOARD
+/* keys play notes as MIDI, at the velocity of inputs without velocity */
+static void _keyboard_input_process(void) {
+	struct keyboard_change change;
+
+	while (keyboard_get(&change)) {
+		for (keyboard_keys_t keys = change.pressed | change.released; keys != 0; keys &= keys - 1) {
+			const int key = __builtin_ctzll(keys);
+			const bool pressed = change.pressed & ((keyboard_keys_t)1 << key);
+
+			const int note = CONFIG_KEYBOARD_BASE_NOTE + key;
+			if (note > 127) {
+				continue;
+			}
+
+			const struct midi_message message = {
+				.type = pressed ? MIDI_NOTE_ON : MIDI_NOTE_OFF,
+				.data = {note, pressed ? VELOCITY_DEFAULT : 0},
+			};
+			synthesizer_midi_event(&message);
+		}
+	}
+}
+#endif
+
+/* renders the block up to each calendar event and BLE MIDI message due in it, in time order. Returns the
+ * number of frames rendered */
+static size_t _scheduled_process(bus_frame* block) {
+	size_t rendered = 0;
+	size_t frame;
+	struct calendar_event event;
+
+	while (event_calendar_peek(&frame)) {
+#if CONFIG_BLE_MIDI
+		rendered = _midi_scheduled_process(block, rendered, frame);
+#endif
+		rendered = _render_until(block, rendered, frame);
+
+		(void)event_calendar_get(&event);
+		event.handler(&event);
+	}
+
+#if CONFIG_BLE_MIDI
+	rendered = _midi_scheduled_process(block, rendered, AUDIO_BLOCK_FRAMES);
+#endif
+
+	return rendered;
+}
+
+/* at the resolution of the control rate. Returns the number of frames rendered */
+static size_t _render_until(bus_frame* block, size_t rendered, size_t frame) {
+	frame -= frame % CONFIG_SYNTH_CONTROL_RATE_SAMPLES;
+
+	if (frame > rendered) {
+		(void)synthesizer_process(block + rendered, frame - rendered);
+		rendered = frame;
+	}
+
+	return rendered;
+}
+
+#if CONFIG_BLE_MIDI
+/* applies the messages due before frame end of the block, where they fall in it */
+static size_t _midi_scheduled_process(bus_frame* block, size_t rendered, size_t end) {
+	const uint32_t end_time = _block_time + end * CONFIG_AUDIO_FRAME_DURATION_US / AUDIO_BLOCK_FRAMES;
+	struct midi_message message;
+
+	while (ble_midi_get(end_time, &message)) {
+		/* messages overdue are applied at the start of the block */
+		const uint32_t offset_us = MAX((int32_t)(message.timestamp - _block_time), 0);
+		rendered = _render_until(block, rendered, offset_us * AUDIO_BLOCK_FRAMES / CONFIG_AUDIO_FRAME_DURATION_US);
+
+		_midi_event(&message);
+	}
+
+	return rendered;
+}
+#endif
+
+#if CONFIG_MIDI
+static void _block_time_update(void) {
+	const uint32_t now = audio_sync_timer_curr_time_get();
+
+	/* blocks are rendered at an even pace on average, the block clock is only moved on larger slips */
+	_block_time += CONFIG_AUDIO_FRAME_DURATION_US;
+	if (abs((int32_t)(now - _block_time)) > CONFIG_AUDIO_FRAME_DURATION_US) {
+		_block_time = now;
+	}
+}
+
+static void _midi_event(const struct midi_message* message) {
+#if CONFIG_MIDI_CLOCK_FOLLOW
+	/* clock and transport drive the tick provider, the timing of the pulses relative to the block clock */
+	switch (message->type) {
+		case MIDI_CLOCK:
+			tick_provider_clock_pulse((int32_t)(_block_time - message->timestamp));
+			return;
+		case MIDI_START:
+			tick_provider_clock_start();
+			return;
+		case MIDI_STOP:
+			tick_provider_clock_stop();
+			return;
+		case MIDI_CONTINUE:
+			tick_provider_clock_continue();
+			return;
+		default:
+			break;
+	}
+#endif
+
+	synthesizer_midi_event(message);
+}
+#endif
+
+#if CONFIG_MIDI_CLOCK_OUT
+/* sent at the frame of the tick, in the block just rendered */
+static void _midi_clock_out_tick(void) {
+	const uint32_t offset_us = tick_provider_tick_frame() * CONFIG_AUDIO_FRAME_DURATION_US / AUDIO_BLOCK_FRAMES;
+
+	if (!midi_uart_realtime_send(MIDI_CLOCK, _block_time + offset_us + CONFIG_MIDI_CLOCK_OUT_DELAY_US)) {
+		LOG_WRN("MIDI clock out queue full");
+	}
+}
+#endif
@@ -24,6 +24,9 @@
 
 #define AUDIO_BLOCK_SIZE FRAME_SIZE_BYTES / CONFIG_AUDIO_BIT_DEPTH_OCTETS
 
+/* number of stereo frames in one block, each frame holds a sample for every channel */
+#define AUDIO_BLOCK_FRAMES (AUDIO_BLOCK_SIZE / CONFIG_I2S_CH_NUM)
+
 void audio_process_init(void);
 
 /**
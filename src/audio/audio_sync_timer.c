@@ -56,6 +56,10 @@ LOG_MODULE_REGISTER(audio_sync_timer, CONFIG_LOG_AUDIO_SYNC_TIMER_LEVEL);
 #define AUDIO_SYNC_TIMER_INSTANCE 1
 
 #define AUDIO_SYNC_TIMER_CURR_TIME_CAPTURE_CHANNEL 1
+#define AUDIO_SYNC_TIMER_ALARM_CHANNEL 2
+
+/* Alarms closer than this could pass before the compare is set */
+#define AUDIO_SYNC_TIMER_ALARM_MIN_US 5
 
 #define AUDIO_SYNC_TIMER_NET_APP_IPC_EVT NRF_IPC_EVENT_RECEIVE_4
 #define AUDIO_SYNC_TIMER_NET_APP_IPC_SIGNAL_IDX 4
@@ -64,6 +68,8 @@ static const nrfx_timer_t timer_instance = NRFX_TIMER_INSTANCE(AUDIO_SYNC_TIMER_
 
 static uint8_t dppi_channel_timer_clear;
 
+static audio_sync_timer_alarm_cb alarm_cb;
+
 static nrfx_timer_config_t cfg = { .frequency = NRF_TIMER_FREQ_1MHz,
 				   .mode = NRF_TIMER_MODE_TIMER,
 				   .bit_width = NRF_TIMER_BIT_WIDTH_32,
@@ -72,6 +78,13 @@ static nrfx_timer_config_t cfg = { .frequency = NRF_TIMER_FREQ_1MHz,
 
 static void event_handler(nrf_timer_event_t event_type, void *ctx)
 {
+	if (event_type == nrf_timer_compare_event_get(AUDIO_SYNC_TIMER_ALARM_CHANNEL)) {
+		nrfx_timer_compare_int_disable(&timer_instance, AUDIO_SYNC_TIMER_ALARM_CHANNEL);
+
+		if (alarm_cb != NULL) {
+			alarm_cb();
+		}
+	}
 }
 
 
@@ -80,6 +93,20 @@ uint32_t audio_sync_timer_curr_time_get(void)
 	return nrfx_timer_capture(&timer_instance, AUDIO_SYNC_TIMER_CURR_TIME_CAPTURE_CHANNEL);
 }
 
+int audio_sync_timer_alarm_set(uint32_t time_us, audio_sync_timer_alarm_cb cb)
+{
+	__ASSERT_NO_MSG(cb != NULL);
+
+	if ((int32_t)(time_us - audio_sync_timer_curr_time_get()) < AUDIO_SYNC_TIMER_ALARM_MIN_US) {
+		return -ETIME;
+	}
+
+	alarm_cb = cb;
+	nrfx_timer_compare(&timer_instance, AUDIO_SYNC_TIMER_ALARM_CHANNEL, time_us, true);
+
+	return 0;
+}
+
 void audio_sync_timer_sync_evt_send(void)
 {
 	nrfx_ipc_signal(AUDIO_SYNC_TIMER_NET_APP_IPC_SIGNAL_IDX);
@@ -89,11 +116,16 @@ int audio_sync_timer_init(void)
 {
 	nrfx_err_t ret;
 
+	/* The alarm compare interrupt reaches event_handler through the nrfx driver */
+	IRQ_CONNECT(NRFX_IRQ_NUMBER_GET(NRF_TIMER1), NRFX_TIMER_DEFAULT_CONFIG_IRQ_PRIORITY, nrfx_isr,
+		    nrfx_timer_1_irq_handler, 0);
+
 	ret = nrfx_timer_init(&timer_instance, &cfg, event_handler);
 	if (ret - NRFX_ERROR_BASE_NUM) {
 		LOG_ERR("nrfx timer init error - Return value: %d", ret);
 		return ret;
 	}
+	irq_enable(NRFX_IRQ_NUMBER_GET(NRF_TIMER1));
 	nrfx_timer_enable(&timer_instance);
 
 	/* Initialize functionality for synchronization between APP and NET core */
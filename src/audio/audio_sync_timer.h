@@ -25,6 +25,21 @@ uint32_t audio_sync_timer_curr_time_get(void);
  */
 void audio_sync_timer_sync_evt_send(void);
 
+typedef void (*audio_sync_timer_alarm_cb)(void);
+
+/**
+ * @brief Call a function at a time of the sync timer
+ *
+ * @note The callback runs in the timer interrupt. Setting
+ * an alarm replaces the one already set
+ *
+ * @param time_us	Timer value to call the function at
+ * @param cb		Function to call
+ *
+ * @return 0 if set, -ETIME if the time is too close or has passed
+ */
+int audio_sync_timer_alarm_set(uint32_t time_us, audio_sync_timer_alarm_cb cb);
+
 /**
  * @brief Initialize the audio sync timer module
  *
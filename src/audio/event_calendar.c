@@ -0,0 +1,191 @@
+#include "event_calendar.h"
+
+#include <zephyr/kernel.h>
+#include <string.h>
+#include <errno.h>
+
+#include "audio_process.h"
+
+#define _TICK_SLOTS CONFIG_EVENT_CALENDAR_TICK_SLOTS
+#define _BLOCK_SLOTS CONFIG_EVENT_CALENDAR_BLOCK_SLOTS
+
+BUILD_ASSERT((_TICK_SLOTS & (_TICK_SLOTS - 1)) == 0, "tick slots must be a power of two");
+BUILD_ASSERT((_BLOCK_SLOTS & (_BLOCK_SLOTS - 1)) == 0, "block slots must be a power of two");
+
+/* frame time of the start of a block, wraps together with the frame times of the events */
+#define _BLOCK_TIME(block) ((uint32_t)(block) * AUDIO_BLOCK_FRAMES)
+
+struct _entry {
+    struct calendar_event event;
+    uint32_t time;      /* tick while waiting for its tick, then frame time */
+    uint32_t offset;
+    struct _entry* next;
+};
+
+static struct _entry _entries[CONFIG_EVENT_CALENDAR_EVENTS];
+static struct _entry* _free;
+
+/* events by tick in the order scheduled. Events more than one turn of the wheel ahead are passed
+ * over once per turn */
+static struct {
+    struct _entry* head;
+    struct _entry* tail;
+} _tick_slots[_TICK_SLOTS];
+
+/* events by block in frame order, taken from the head */
+static struct _entry* _block_slots[_BLOCK_SLOTS];
+
+static uint32_t _tick;          /* last tick */
+static uint32_t _tick_time;     /* frame time the events of the last tick are applied at */
+static uint32_t _block;         /* block to be processed */
+
+static void _block_insert(struct _entry* entry);
+
+void event_calendar_init(void)
+{
+    _free = NULL;
+    for (int i = ARRAY_SIZE(_entries) - 1; i >= 0; i--) {
+        _entries[i].next = _free;
+        _free = &_entries[i];
+    }
+
+    memset(_tick_slots, 0, sizeof(_tick_slots));
+    memset(_block_slots, 0, sizeof(_block_slots));
+
+    _tick = 0;
+    _tick_time = 0;
+    _block = 0;
+}
+
+int event_calendar_schedule(uint32_t ticks, uint32_t offset, const struct calendar_event* event)
+{
+    __ASSERT_NO_MSG(event != NULL);
+    __ASSERT(event->handler != NULL, "event handler must not be NULL");
+    __ASSERT(ticks <= INT32_MAX && offset <= INT32_MAX, "event too far ahead");
+
+    if (_free == NULL) {
+        return -ENOMEM;
+    }
+
+    struct _entry* entry = _free;
+    _free = entry->next;
+
+    entry->event = *event;
+    entry->offset = offset;
+    entry->next = NULL;
+
+    /* the last tick has already been taken from the wheel */
+    if (ticks == 0) {
+        entry->time = _tick_time + offset;
+        _block_insert(entry);
+        return 0;
+    }
+
+    entry->time = _tick + ticks;
+
+    const uint32_t slot = entry->time & (_TICK_SLOTS - 1);
+    if (_tick_slots[slot].head == NULL) {
+        _tick_slots[slot].head = entry;
+    } else {
+        _tick_slots[slot].tail->next = entry;
+    }
+    _tick_slots[slot].tail = entry;
+
+    return 0;
+}
+
+void event_calendar_tick(size_t frame)
+{
+    __ASSERT(frame < AUDIO_BLOCK_FRAMES, "tick frame out of range");
+
+    _tick++;
+
+    /* the block counter has already moved past the block the tick fell in */
+    _tick_time = _BLOCK_TIME(_block) + frame;
+
+    struct _entry** entry_indirect = &_tick_slots[_tick & (_TICK_SLOTS - 1)].head;
+    struct _entry* last = NULL;
+
+    while (*entry_indirect != NULL) {
+        struct _entry* entry = *entry_indirect;
+
+        if (entry->time != _tick) {
+            last = entry;
+            entry_indirect = &entry->next;
+            continue;
+        }
+
+        *entry_indirect = entry->next;
+
+        entry->time = _tick_time + entry->offset;
+        _block_insert(entry);
+    }
+
+    _tick_slots[_tick & (_TICK_SLOTS - 1)].tail = last;
+}
+
+void event_calendar_increment(void)
+{
+    _block++;
+}
+
+bool event_calendar_peek(size_t* frame)
+{
+    __ASSERT_NO_MSG(frame != NULL);
+
+    /* events of later turns of the wheel sort after those of this block */
+    const struct _entry* entry = _block_slots[_block & (_BLOCK_SLOTS - 1)];
+    if (entry == NULL) {
+        return false;
+    }
+
+    const int32_t position = entry->time - _BLOCK_TIME(_block);
+    if (position >= (int32_t)AUDIO_BLOCK_FRAMES) {
+        return false;
+    }
+
+    *frame = MAX(position, 0);
+    return true;
+}
+
+bool event_calendar_get(struct calendar_event* event)
+{
+    __ASSERT_NO_MSG(event != NULL);
+
+    size_t frame;
+    if (!event_calendar_peek(&frame)) {
+        return false;
+    }
+
+    struct _entry** head = &_block_slots[_block & (_BLOCK_SLOTS - 1)];
+    struct _entry* entry = *head;
+    *head = entry->next;
+
+    *event = entry->event;
+
+    entry->next = _free;
+    _free = entry;
+
+    return true;
+}
+
+static void _block_insert(struct _entry* entry)
+{
+    const uint32_t start = _BLOCK_TIME(_block);
+
+    /* events late for their frame are applied at the start of the next block processed */
+    if ((int32_t)(entry->time - start) < 0) {
+        entry->time = start;
+    }
+
+    const uint32_t block = _block + (entry->time - start) / AUDIO_BLOCK_FRAMES;
+
+    /* only the events of the same slot are passed, and those at the same frame are kept in order */
+    struct _entry** entry_indirect = &_block_slots[block & (_BLOCK_SLOTS - 1)];
+    while (*entry_indirect != NULL && (int32_t)((*entry_indirect)->time - entry->time) <= 0) {
+        entry_indirect = &(*entry_indirect)->next;
+    }
+
+    entry->next = *entry_indirect;
+    *entry_indirect = entry;
+}
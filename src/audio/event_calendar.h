@@ -0,0 +1,75 @@
+/**
+ * @file event_calendar.h
+ * @author Rein Gundersen Bentdal
+ * @brief Events scheduled ahead of time in ticks of the tick provider, and applied at their frame in the
+ *  audio block. Timer wheels of ticks and blocks, so neither scheduling nor taking the events due walks
+ *  all pending events
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _EVENT_CALENDAR_H_
+#define _EVENT_CALENDAR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+enum calendar_event_type {
+    CALENDAR_EVENT_NOTE_ON,
+    CALENDAR_EVENT_NOTE_OFF,
+    CALENDAR_EVENT_PARAM,
+    CALENDAR_EVENT_MIDI,
+};
+
+struct calendar_event;
+
+typedef void (*calendar_event_cb)(const struct calendar_event*);
+
+/* copied when scheduled */
+struct calendar_event {
+    calendar_event_cb handler;
+    uint8_t type;
+    /* free for the scheduling module, such as to tell apart events of an earlier start */
+    uint8_t generation;
+    union {
+        struct {
+            uint8_t note;
+            uint8_t velocity;
+        };
+        struct {
+            uint8_t param;
+            int32_t value;
+        };
+        struct {
+            uint8_t status;
+            uint8_t data[2];
+        } midi;
+    };
+};
+
+void event_calendar_init(void);
+
+/* ticks after the last tick, and offset frames after the frame of that tick. The events of a tick are
+ * applied in the block after the one the tick fell in, at the frame of the tick, so the timing between
+ * events is kept at one block of latency. Events at the same time are applied in the order they were
+ * scheduled. Returns -ENOMEM if CONFIG_EVENT_CALENDAR_EVENTS are pending.
+ * Should be called from the audio processing context, such as tick callbacks */
+int event_calendar_schedule(uint32_t ticks, uint32_t offset, const struct calendar_event* event);
+
+/* called by the tick provider, for a tick at frame of the block just processed, before the subscribers */
+void event_calendar_tick(size_t frame);
+
+/* called by the tick provider once for each block processed, before its ticks */
+void event_calendar_increment(void);
+
+/* frame in the block to be processed of the next event due in it */
+bool event_calendar_peek(size_t* frame);
+
+/* takes the next event due in the block to be processed */
+bool event_calendar_get(struct calendar_event* event);
+
+#endif
@@ -0,0 +1,31 @@
+#include "pcm_convert.h"
+
+#include <zephyr/kernel.h>
+
+#include "audio_process.h"
+
+BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_BITS == 8 * CONFIG_AUDIO_BIT_DEPTH_OCTETS,
+             "the codec reads samples of the size of their containers");
+
+/* resolution of the samples, rounded to before they are left aligned */
+#define _PCM_BITS (IS_ENABLED(CONFIG_AUDIO_BIT_DEPTH_24) ? 24 : CONFIG_AUDIO_BIT_DEPTH_BITS)
+
+void* pcm_convert(const bus_frame* frames)
+{
+#if CONFIG_SYNTH_BUS_Q31 && CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2
+    static int16_t pcm[AUDIO_BLOCK_SIZE];
+    stereo32_to_pcm16(frames, pcm, AUDIO_BLOCK_FRAMES);
+    return pcm;
+#elif CONFIG_SYNTH_BUS_Q31
+    static int32_t pcm[AUDIO_BLOCK_SIZE];
+    stereo32_to_pcm32(frames, pcm, AUDIO_BLOCK_FRAMES, _PCM_BITS);
+    return pcm;
+#elif CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2
+    /* packed frames already are interleaved 16-bit PCM */
+    return (void*)frames;
+#else
+    static int32_t pcm[AUDIO_BLOCK_SIZE];
+    stereo16_to_pcm32(frames, pcm, AUDIO_BLOCK_FRAMES);
+    return pcm;
+#endif
+}
@@ -0,0 +1,22 @@
+/**
+ * @file pcm_convert.h
+ * @author Rein Gundersen Bentdal
+ * @brief The only conversion from the synthesizer bus to the PCM depth of the codec
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PCM_CONVERT_H_
+#define _PCM_CONVERT_H_
+
+#include "dsp/stereo.h"
+
+/* one block of frames as interleaved PCM of CONFIG_AUDIO_BIT_DEPTH_BITS, the depth the codec is opened
+ * with. 24-bit samples are left aligned in 32-bit containers, so they are full scale to the codec. Returns
+ * the frames themselves when they already are PCM, or a buffer valid until the next call */
+void* pcm_convert(const bus_frame* frames);
+
+#endif
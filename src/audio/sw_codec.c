@@ -9,6 +9,8 @@
 #include <zephyr/kernel.h>
 #include <errno.h>
 
+#include "dsp_instructions.h"
+
 #if (CONFIG_SW_CODEC_LC3)
 #include "sw_codec_lc3.h"
 #endif /* (CONFIG_SW_CODEC_LC3) */
@@ -32,6 +34,9 @@ static OI_CODEC_SBC_DECODER_CONTEXT context;
 static SBC_ENC_PARAMS m_sbc_enc_params;
 static OI_CODEC_SBC_CODEC_DATA_STEREO sw_codec_sbc_dec_data;
 
+/* frames per BLE packet and the encoder sampling frequency assume 48 kHz */
+BUILD_ASSERT(CONFIG_AUDIO_SAMPLE_RATE_HZ == 48000, "SBC is only supported at 48 kHz");
+
 #define LAST_PCM_FRAME_START_IDX                                                                   \
 	(PCM_NUM_BYTES_SBC_FRAME_MONO * (CONFIG_SBC_NUM_FRAMES_PER_BLE_PACKET - 1))
 
@@ -45,7 +50,7 @@ static void _prev_frame_sbc_flush(char *pcm_data);
 int sw_codec_encode(void *pcm_data, size_t pcm_size, uint8_t **encoded_data, size_t *encoded_size)
 {
 	/* Temp storage for split stereo PCM signal */
-	char pcm_data_mono[AUDIO_CH_NUM][PCM_NUM_BYTES_MONO] = { 0 };
+	char pcm_data_mono[AUDIO_CH_NUM][PCM_NUM_BYTES_MONO] __aligned(4) = { 0 };
 	/* Make sure we have enough space for two frames (stereo) */
 	static uint8_t m_encoded_data[ENC_MAX_FRAME_SIZE * AUDIO_CH_NUM];
 
@@ -369,6 +374,34 @@ static int _pcm_two_channel_split(void const *const input, size_t input_size, ui
 		return -EINVAL;
 	}
 
+	/* 16-bit frames are split two at a time with word loads and stores, the channels are
+	 * packed from the halves of each frame without touching single bytes
+	 */
+	if (bytes_per_sample == 2 && ((uintptr_t)input & 3) == 0) {
+		const uint32_t *frames = (const uint32_t *)input;
+		uint32_t *left = (uint32_t *)output_left;
+		uint32_t *right = (uint32_t *)output_right;
+		const size_t frame_count = input_size / 4;
+
+		for (size_t i = 0; i < frame_count / 2; i++) {
+			const uint32_t first = frames[2 * i];
+			const uint32_t second = frames[2 * i + 1];
+
+			left[i] = pack_16b_16b(second, first);
+			right[i] = pack_16t_16t(second, first);
+		}
+
+		if (frame_count % 2) {
+			const uint32_t last = frames[frame_count - 1];
+
+			((uint16_t *)output_left)[frame_count - 1] = last & UINT16_MAX;
+			((uint16_t *)output_right)[frame_count - 1] = last >> 16;
+		}
+
+		*output_size = input_size / 2;
+		return 0;
+	}
+
 	char *pointer_input = (char *)input;
 	char *pointer_output_left = (char *)output_left;
 	char *pointer_output_right = (char *)output_right;
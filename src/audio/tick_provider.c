@@ -1,20 +1,60 @@
 #include "tick_provider.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <zephyr/kernel.h>
 #include "audio_process.h"
+#include "event_calendar.h"
 
+/* pulses further apart are not a running clock, such as over a stop. 20 bpm */
+#define _PULSE_PERIOD_MAX_US (60 * 1000000 / (20 * PULSES_PER_QUARTER_NOTE))
+
+/* at most one tick is sent per block */
+#define _PULSE_PERIOD_MIN_US CONFIG_AUDIO_FRAME_DURATION_US
+
+/* the pulse period is averaged over about 2^_PERIOD_SHIFT pulses, which removes the jitter of the transport */
+#define _PERIOD_SHIFT 4
+
+/* 1/2^_PHASE_SHIFT of the phase error is corrected each block, as a small change of tempo */
+#define _PHASE_SHIFT 3
+
+/* one tick in the phase, Q32 */
+#define _PHASE_ONE ((int64_t)1 << 32)
 
 static struct tick_provider_subscriber *_subscription_head = NULL;
 
 static uint32_t _phase_accumulate;
 static uint32_t _phase_increment;
+static uint32_t _last_phase_increment;
+static size_t _tick_frame;
+
+/* follows the pulses of an external clock. The tempo is the average pulse period, and the phase error at each
+ * pulse is corrected over the following blocks, so ticks neither jump nor carry the jitter of the transport */
+static struct {
+    bool enabled;
+    bool running;
+    bool locked;
+    uint32_t time_us;           /* start of the next block, advanced by one frame per block */
+    uint32_t last_pulse_us;
+    uint32_t pulses;            /* received since start */
+    uint32_t ticks;             /* sent since start */
+    uint32_t period_q8;         /* average pulse period in 1/256 us, 0 until measured */
+    uint32_t phase_increment;
+    int64_t phase_error;        /* not yet corrected, Q32 ticks */
+} _external;
+
+static void _notify(void);
+static uint32_t _external_phase_increment(void);
 
 void tick_provider_init(void)
 {
     _phase_accumulate = 0;
     _phase_increment = 0;
+    _last_phase_increment = 0;
+    _tick_frame = 0;
+
+    memset(&_external, 0, sizeof(_external));
 }
 
 void tick_provider_subscribe(struct tick_provider_subscriber* subscriber, tick_provider_notify_cb notifier)
@@ -46,21 +86,170 @@ void tick_provider_unsubscribe(struct tick_provider_subscriber* subscriber)
 
 void tick_provider_set_bpm(uint32_t bpm)
 {
-    _phase_increment = (uint32_t)(bpm * PULSES_PER_QUARTER_NOTE * AUDIO_BLOCK_SIZE / (double)(60 * CONFIG_AUDIO_SAMPLE_RATE_HZ) * UINT32_MAX);
+    tick_provider_set_bpm_milli(bpm * 1000);
+}
+
+void tick_provider_set_bpm_milli(uint32_t bpm_milli)
+{
+    /* incremented once per block, a block spans AUDIO_BLOCK_FRAMES sample periods */
+    _phase_increment = (uint32_t)((double)bpm_milli * PULSES_PER_QUARTER_NOTE * AUDIO_BLOCK_FRAMES / (60000.0 * CONFIG_AUDIO_SAMPLE_RATE_HZ) * UINT32_MAX);
 }
 
 void tick_provider_increment(void)
 {
+    uint32_t phase_increment = _phase_increment;
+
+    event_calendar_increment();
+
+    if (_external.enabled) {
+        _external.time_us += CONFIG_AUDIO_FRAME_DURATION_US;
+        phase_increment = _external_phase_increment();
+    }
+
+    _last_phase_increment = phase_increment;
+
     const uint32_t last_phase = _phase_accumulate;
-    _phase_accumulate += _phase_increment;
+    _phase_accumulate += phase_increment;
     if (_phase_accumulate < last_phase)
     { /* overflow, update subscribers */
-        struct tick_provider_subscriber *p = _subscription_head;
-        while (p != NULL)
-        {
-            /* assumes callback is not null => NULL expception handled in subscription */
-            p->notifier();
-            p = p->next;
+        const uint64_t frame = ((uint64_t)UINT32_MAX - last_phase + 1) * AUDIO_BLOCK_FRAMES / phase_increment;
+        _tick_frame = MIN(frame, AUDIO_BLOCK_FRAMES - 1);
+        _external.ticks++;
+
+        _notify();
+    }
+}
+
+size_t tick_provider_tick_frame(void)
+{
+    return _tick_frame;
+}
+
+uint32_t tick_provider_tick_frames(void)
+{
+    if (_last_phase_increment == 0) {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)AUDIO_BLOCK_FRAMES << 32) / _last_phase_increment);
+}
+
+void tick_provider_set_external(bool external)
+{
+    memset(&_external, 0, sizeof(_external));
+
+    /* a clock without transport messages is followed from its first pulse */
+    _external.enabled = external;
+    _external.running = true;
+
+    /* until measured, the tempo is that of the internal clock */
+    _external.phase_increment = _phase_increment;
+}
+
+void tick_provider_clock_pulse(int32_t age_us)
+{
+    if (!_external.enabled || !_external.running) {
+        return;
+    }
+
+    const uint32_t pulse_us = _external.time_us - age_us;
+    const uint32_t period_us = pulse_us - _external.last_pulse_us;
+
+    if (_external.pulses > 0 && period_us >= _PULSE_PERIOD_MIN_US && period_us <= _PULSE_PERIOD_MAX_US) {
+        if (_external.period_q8 == 0) {
+            _external.period_q8 = period_us << 8;
+        } else {
+            _external.period_q8 += (int32_t)((period_us << 8) - _external.period_q8) >> _PERIOD_SHIFT;
         }
+
+        const uint64_t phase_increment = ((uint64_t)CONFIG_AUDIO_FRAME_DURATION_US << 40) / _external.period_q8;
+        _external.phase_increment = MIN(phase_increment, UINT32_MAX);
     }
-}
\ No newline at end of file
+
+    _external.last_pulse_us = pulse_us;
+    _external.pulses++;
+
+    /* the tick of a pulse is due when the tick count reaches the pulse count */
+    const int64_t elapsed = (int64_t)age_us * _external.phase_increment / CONFIG_AUDIO_FRAME_DURATION_US;
+    const int64_t position = ((int64_t)_external.ticks << 32) + _phase_accumulate - elapsed;
+    const int64_t error = ((int64_t)_external.pulses << 32) - position;
+
+    if (_external.locked && error < _PHASE_ONE && error > -_PHASE_ONE) {
+        _external.phase_error = error;
+        return;
+    }
+
+    /* first pulse or lock lost, the phase restarts from this pulse. Its tick is sent now, unless it already was */
+    const bool tick_due = _external.ticks < _external.pulses;
+
+    _external.ticks = _external.pulses;
+    _external.phase_error = 0;
+    _external.locked = true;
+    _phase_accumulate = CLAMP(elapsed, 0, UINT32_MAX);
+
+    if (tick_due) {
+        _tick_frame = 0;
+        _notify();
+    }
+}
+
+void tick_provider_clock_start(void)
+{
+    _external.running = true;
+    _external.locked = false;
+    _external.pulses = 0;
+    _external.ticks = 0;
+    _phase_accumulate = 0;
+}
+
+void tick_provider_clock_stop(void)
+{
+    _external.running = false;
+}
+
+void tick_provider_clock_continue(void)
+{
+    _external.running = true;
+}
+
+uint32_t tick_provider_external_bpm_milli(void)
+{
+    if (_external.period_q8 == 0) {
+        return 0;
+    }
+
+    return (uint32_t)((60ull * 1000000 * 1000 << 8) / ((uint64_t)PULSES_PER_QUARTER_NOTE * _external.period_q8));
+}
+
+static void _notify(void)
+{
+    /* events of this tick are due before subscribers schedule new ones */
+    event_calendar_tick(_tick_frame);
+
+    struct tick_provider_subscriber *p = _subscription_head;
+    while (p != NULL)
+    {
+        /* assumes callback is not null => NULL expception handled in subscription */
+        p->notifier();
+        p = p->next;
+    }
+}
+
+static uint32_t _external_phase_increment(void)
+{
+    if (!_external.running || !_external.locked) {
+        return 0;
+    }
+
+    /* the clock has stopped without a stop message, ticks wait for it to return */
+    if ((int32_t)(_external.time_us - _external.last_pulse_us) > _PULSE_PERIOD_MAX_US) {
+        _external.locked = false;
+        return 0;
+    }
+
+    const int64_t limit = _external.phase_increment / 2;
+    const int64_t correction = CLAMP(_external.phase_error >> _PHASE_SHIFT, -limit, limit);
+    _external.phase_error -= correction;
+
+    return MIN(_external.phase_increment + correction, UINT32_MAX);
+}
@@ -14,6 +14,8 @@
 #define _TICK_PROVIDER_H_
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
 
 /* number of ticks to send to subscribers for each quarter note increment */
 #define PULSES_PER_QUARTER_NOTE 24
@@ -34,8 +36,34 @@ void tick_provider_subscribe(struct tick_provider_subscriber*, tick_provider_not
 void tick_provider_unsubscribe(struct tick_provider_subscriber*);
 
 void tick_provider_set_bpm(uint32_t bpm);
+/** tempo in 1/1000 bpm, for tempos between whole bpm such as those of MIDI files */
+void tick_provider_set_bpm_milli(uint32_t bpm_milli);
 
 /** should be called for every processed audio block, for correct time syncronizaton */
 void tick_provider_increment(void);
 
+/** frame of the block just processed where the current tick fell, valid in the notifier callbacks.
+ * Ticks of the external clock given before a block is processed are at frame 0 */
+size_t tick_provider_tick_frame(void);
+
+/** length of a tick at the tempo of the last block, in frames. 0 while ticks are held */
+uint32_t tick_provider_tick_frames(void);
+
+/** follow an external clock of PULSES_PER_QUARTER_NOTE, such as MIDI clock, instead of the tempo from
+ * tick_provider_set_bpm. Ticks stop until the first pulse is received */
+void tick_provider_set_external(bool external);
+
+/** a pulse of the external clock. age_us is the time from the pulse until the start of the next block to be
+ * processed, negative if the pulse is due within it. Should be called from the audio processing context */
+void tick_provider_clock_pulse(int32_t age_us);
+
+/** transport of the external clock. Start restarts the count at the next pulse, stop holds the ticks until
+ * continue or start */
+void tick_provider_clock_start(void);
+void tick_provider_clock_stop(void);
+void tick_provider_clock_continue(void);
+
+/** tempo of the external clock in 1/1000 bpm, 0 before it is known */
+uint32_t tick_provider_external_bpm_milli(void);
+
 #endif
\ No newline at end of file
@@ -16,6 +16,9 @@
 #include "ble_acl_gateway.h"
 #include "ble_hci_vsc.h"
 #include "macros_common.h"
+#if CONFIG_BLE_MIDI
+#include "ble_midi.h"
+#endif
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(ble, CONFIG_LOG_BLE_LEVEL);
@@ -36,6 +39,7 @@ static void _conn_parameter_updated_cb(struct bt_conn *conn, uint16_t interval,
 #if (CONFIG_BT_SMP)
 static void _security_changed_cb(struct bt_conn *conn, bt_security_t level, enum bt_security_err err);
 #endif
+static bool _conn_is_headset(struct bt_conn *conn);
 
 /**@brief BLE connection callback handlers.
  */
@@ -64,12 +68,22 @@ struct bt_conn* ble_acl_common_conn_peer_get(void)
 void ble_acl_common_start(void)
 {
 	k_work_submit(&_scan_work);
+
+#if CONFIG_BLE_MIDI
+	int ret = ble_midi_start();
+	ERR_CHK_MSG(ret, "Failed to start BLE MIDI advertising");
+#endif
 }
 
 int ble_acl_common_init(void)
 {
 	bt_conn_cb_register(&_conn_callbacks);
 
+#if CONFIG_BLE_MIDI
+	int ret = ble_midi_init();
+	RETURN_ON_ERR(ret);
+#endif
+
 	/* TODO: Initialize BLE services here, SMP is required*/
 	return ble_vcs_client_init();
 }
@@ -81,6 +95,10 @@ static void _on_connected_cb(struct bt_conn *conn, uint8_t err)
 	int ret;
 	char addr[BT_ADDR_LE_STR_LEN];
 
+	if (!_conn_is_headset(conn)) {
+		return;
+	}
+
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 	ARG_UNUSED(ret);
 	if (err) {
@@ -123,6 +141,10 @@ static void _on_disconnected_cb(struct bt_conn *conn, uint8_t reason)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
 
+	if (!_conn_is_headset(conn)) {
+		return;
+	}
+
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 	LOG_DBG("ACL disconnected with %s reason: %d", addr, reason);
 
@@ -151,6 +173,10 @@ static void _on_disconnected_cb(struct bt_conn *conn, uint8_t reason)
  */
 static bool _conn_parameter_request_cb(struct bt_conn *conn, struct bt_le_conn_param *param)
 {
+	if (!_conn_is_headset(conn)) {
+		return true;
+	}
+
 	/* Connection between two nRF5340 Audio DKs are fixed */
 	if ((param->interval_min != CONFIG_BLE_ACL_CONN_INTERVAL) ||
 	    (param->interval_max != CONFIG_BLE_ACL_CONN_INTERVAL)) {
@@ -178,6 +204,10 @@ static void _security_changed_cb(struct bt_conn *conn, bt_security_t level, enum
 {
 	int ret;
 
+	if (!_conn_is_headset(conn)) {
+		return;
+	}
+
 	if (err) {
 		LOG_ERR("Security failed: level %u err %d", level, err);
 		ret = bt_conn_disconnect(conn, err);
@@ -194,4 +224,12 @@ static void _security_changed_cb(struct bt_conn *conn, bt_security_t level, enum
 		LOG_WRN("MTU exchange procedure failed = %d", ret);
 	}
 }
-#endif /* (CONFIG_BT_SMP) */
\ No newline at end of file
+#endif /* (CONFIG_BT_SMP) */
+/**@brief Headsets are connected with the gateway as central, other links are handled by their own services
+ */
+static bool _conn_is_headset(struct bt_conn *conn)
+{
+	struct bt_conn_info info;
+
+	return bt_conn_get_info(conn, &info) == 0 && info.role == BT_CONN_ROLE_CENTRAL;
+}
@@ -25,6 +25,9 @@ K_WORK_DEFINE(_start_scan_work, work_scan_start);
 
 static struct bt_gatt_exchange_params _exchange_params;
 
+/* left and right. Connections beyond these, such as BLE MIDI, are not headsets */
+#define HEADSET_NUM 2
+
 /* Connection to the headset device - the other nRF5340 Audio device
  * This is the device we are streaming audio to/from.
  */
@@ -72,7 +75,7 @@ int ble_acl_gateway_conn_peer_set(uint8_t chan_number, struct bt_conn **p_conn)
 
 bool ble_acl_gateway_all_links_connected(void)
 {
-	for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+	for (int i = 0; i < HEADSET_NUM; i++) {
 		if (_gateway_conn_peer[i] == NULL) {
 			return false;
 		}
@@ -140,7 +143,7 @@ static int _device_found(uint8_t type, const uint8_t *data, uint8_t data_len,
 	char addr_str[BT_ADDR_LE_STR_LEN];
 	bt_addr_le_to_str(addr, addr_str, sizeof(addr_str));
 
-	const char* addr_targets[CONFIG_BT_MAX_CONN] = {"NRF5340_AUDIO_H_L", "NRF5340_AUDIO_H_R"};
+	const char* addr_targets[HEADSET_NUM] = {"NRF5340_AUDIO_H_L", "NRF5340_AUDIO_H_R"};
 
 	for (int ch = 0; ch < ARRAY_SIZE(addr_targets); ch++) {
 		if (strncmp(addr_targets[ch], data, strlen(addr_targets[ch]) - 1) == 0 && _gateway_conn_peer[ch] == NULL) {
@@ -257,7 +260,7 @@ static void _mtu_exchange_handler(struct bt_conn *conn, uint8_t err,
 }
 
 static void _update_leds(void) {
-	for (int ch = 0; ch < ARRAY_SIZE(_gateway_conn_peer); ch++) {
+	for (int ch = 0; ch < HEADSET_NUM; ch++) {
 		led_headset_connected(ch, _gateway_conn_peer[ch] != NULL);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "ble_midi.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+
+#include "audio_sync_timer.h"
+#include "macros_common.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(ble, CONFIG_LOG_BLE_LEVEL);
+
+BUILD_ASSERT(CONFIG_BT_MAX_CONN > 2, "BLE MIDI needs a connection in addition to the two headsets");
+
+#define BT_UUID_MIDI_SERVICE_VAL BT_UUID_128_ENCODE(0x03b80e5a, 0xede8, 0x4b33, 0xa751, 0x6ce34ec4c700)
+#define BT_UUID_MIDI_IO_VAL BT_UUID_128_ENCODE(0x7772e5db, 0x3868, 0x4112, 0xa1a9, 0xf2669d106bf3)
+
+static struct bt_uuid_128 _midi_service_uuid = BT_UUID_INIT_128(BT_UUID_MIDI_SERVICE_VAL);
+static struct bt_uuid_128 _midi_io_uuid = BT_UUID_INIT_128(BT_UUID_MIDI_IO_VAL);
+
+/* timestamps are 13 bits of sender time in ms */
+#define _TIMESTAMP_MASK 0x1FFF
+#define _TIMESTAMP_HIGH_MASK 0x3F
+#define _TIMESTAMP_LOW_MASK 0x7F
+
+/* sender time can not be unwrapped after a pause of more than half the timestamp range */
+#define _RESYNC_US (1000 * (_TIMESTAMP_MASK + 1) / 2)
+
+/* the transit offset follows messages arriving earlier at once, and later ones by at most 1/4096 of the time
+ * passed, which covers the drift between the sender and the audio sync timer */
+#define _OFFSET_RISE_SHIFT 12
+
+/* jitter is reported once for this many messages */
+#define _STATS_MESSAGES 256
+
+MIDI_QUEUE_DEFINE(_queue, CONFIG_BLE_MIDI_QUEUE_SIZE);
+
+static struct bt_conn *_conn;
+static struct midi_parser _parser;
+
+/* maps sender time to audio sync timer time */
+static struct {
+	bool synced;
+	uint32_t sender_ms;
+	uint32_t offset;
+	uint32_t last_arrival;
+} _clock;
+
+static struct {
+	uint32_t messages;
+	uint32_t jitter_sum;
+	uint32_t jitter_max;
+	uint32_t late;
+} _stats;
+
+static void _adv_start(struct k_work *work);
+K_WORK_DEFINE(_adv_work, _adv_start);
+
+static void _on_connected_cb(struct bt_conn *conn, uint8_t err);
+static void _on_disconnected_cb(struct bt_conn *conn, uint8_t reason);
+static ssize_t _midi_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+			  uint16_t len, uint16_t offset);
+static ssize_t _midi_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf,
+			   uint16_t len, uint16_t offset, uint8_t flags);
+static void _packet_process(const uint8_t *data, size_t length, uint32_t arrival);
+static void _message_schedule(struct midi_message *message, uint32_t sender_ms, uint32_t arrival);
+
+static struct bt_conn_cb _conn_callbacks = {
+	.connected = _on_connected_cb,
+	.disconnected = _on_disconnected_cb,
+};
+
+BT_GATT_SERVICE_DEFINE(_midi_service,
+	BT_GATT_PRIMARY_SERVICE(&_midi_service_uuid),
+	BT_GATT_CHARACTERISTIC(&_midi_io_uuid.uuid,
+			       BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE_WITHOUT_RESP | BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_READ | BT_GATT_PERM_WRITE, _midi_read, _midi_write, NULL),
+	BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+static const struct bt_data _ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_MIDI_SERVICE_VAL),
+};
+
+static const struct bt_data _sd[] = {
+	BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
+};
+
+int ble_midi_init(void)
+{
+	midi_parser_init(&_parser);
+	bt_conn_cb_register(&_conn_callbacks);
+
+	return 0;
+}
+
+int ble_midi_start(void)
+{
+	return bt_le_adv_start(BT_LE_ADV_CONN, _ad, ARRAY_SIZE(_ad), _sd, ARRAY_SIZE(_sd));
+}
+
+bool ble_midi_get(uint32_t before, struct midi_message *message)
+{
+	__ASSERT_NO_MSG(message != NULL);
+
+	if (!midi_queue_peek(&_queue, message)) {
+		return false;
+	}
+
+	if ((int32_t)(message->timestamp - before) >= 0) {
+		return false;
+	}
+
+	return midi_queue_get(&_queue, message);
+}
+
+static void _adv_start(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	int ret = ble_midi_start();
+	if (ret) {
+		LOG_WRN("BLE MIDI advertising failed to start (ret %d)", ret);
+	}
+}
+
+/* the gateway is central towards the headsets, BLE MIDI controllers connect to it as peripheral */
+static bool _conn_is_midi(struct bt_conn *conn)
+{
+	struct bt_conn_info info;
+
+	return bt_conn_get_info(conn, &info) == 0 && info.role == BT_CONN_ROLE_PERIPHERAL;
+}
+
+static void _on_connected_cb(struct bt_conn *conn, uint8_t err)
+{
+	if (!_conn_is_midi(conn)) {
+		return;
+	}
+
+	if (err) {
+		LOG_WRN("BLE MIDI connection failed, error %d", err);
+		k_work_submit(&_adv_work);
+		return;
+	}
+
+	_conn = bt_conn_ref(conn);
+	_clock.synced = false;
+	midi_parser_init(&_parser);
+
+	LOG_INF("BLE MIDI connected");
+}
+
+static void _on_disconnected_cb(struct bt_conn *conn, uint8_t reason)
+{
+	if (conn != _conn) {
+		return;
+	}
+
+	bt_conn_unref(_conn);
+	_conn = NULL;
+
+	LOG_INF("BLE MIDI disconnected, reason %d", reason);
+	k_work_submit(&_adv_work);
+}
+
+/* reads return no MIDI data, as the specification requires */
+static ssize_t _midi_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+			  uint16_t len, uint16_t offset)
+{
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, NULL, 0);
+}
+
+static ssize_t _midi_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf,
+			   uint16_t len, uint16_t offset, uint8_t flags)
+{
+	if (offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+
+	_packet_process(buf, len, audio_sync_timer_curr_time_get());
+
+	return len;
+}
+
+/* a header byte with the upper bits of the timestamp, then messages each preceded by a byte with the
+ * lower bits. Messages using running status may leave out the timestamp byte */
+static void _packet_process(const uint8_t *data, size_t length, uint32_t arrival)
+{
+	if (length < 2 || (data[0] & 0xC0) != 0x80) {
+		LOG_DBG("BLE MIDI packet malformed");
+		return;
+	}
+
+	uint32_t high = data[0] & _TIMESTAMP_HIGH_MASK;
+	int32_t last_low = -1;
+	uint32_t sender_ms = 0;
+	bool after_timestamp = false;
+
+	for (size_t i = 1; i < length; i++) {
+		const uint8_t byte = data[i];
+
+		/* a status byte directly after a timestamp, otherwise a byte with the top bit set is a timestamp */
+		if ((byte & 0x80) && !after_timestamp) {
+			const int32_t low = byte & _TIMESTAMP_LOW_MASK;
+
+			/* the low bits wrap within the packet without a new header */
+			if (low < last_low) {
+				high = (high + 1) & _TIMESTAMP_HIGH_MASK;
+			}
+			last_low = low;
+
+			sender_ms = (high << 7) | low;
+			after_timestamp = true;
+			continue;
+		}
+		after_timestamp = false;
+
+		/* data without a timestamp first */
+		if (last_low < 0) {
+			continue;
+		}
+
+		struct midi_message message;
+		if (midi_parser_feed(&_parser, byte, &message)) {
+			_message_schedule(&message, sender_ms, arrival);
+		}
+	}
+}
+
+/* sender time is mapped to local time by the smallest transit seen, and messages are due a fixed delay
+ * later. Messages batched in one connection event are spread out again by their original spacing */
+static void _message_schedule(struct midi_message *message, uint32_t sender_ms, uint32_t arrival)
+{
+	const uint32_t elapsed = arrival - _clock.last_arrival;
+
+	if (!_clock.synced || elapsed > _RESYNC_US) {
+		_clock.sender_ms = sender_ms;
+		_clock.offset = arrival - sender_ms * 1000;
+		_clock.synced = true;
+	}
+	_clock.last_arrival = arrival;
+
+	/* unwrap, allowing messages slightly out of order */
+	int32_t delta = (sender_ms - _clock.sender_ms) & _TIMESTAMP_MASK;
+	if (delta > _TIMESTAMP_MASK / 2) {
+		delta -= _TIMESTAMP_MASK + 1;
+	}
+	_clock.sender_ms += delta;
+
+	const uint32_t transit = arrival - _clock.sender_ms * 1000;
+	int32_t jitter = (int32_t)(transit - _clock.offset);
+	if (jitter < 0) {
+		_clock.offset = transit;
+		jitter = 0;
+	} else {
+		_clock.offset += MIN((uint32_t)jitter, elapsed >> _OFFSET_RISE_SHIFT);
+	}
+
+	/* arrived later than the delay allows for, played as soon as possible */
+	if (jitter > CONFIG_BLE_MIDI_DELAY_US) {
+		message->timestamp = arrival;
+		_stats.late++;
+	} else {
+		message->timestamp = arrival - jitter + CONFIG_BLE_MIDI_DELAY_US;
+	}
+
+	if (!midi_queue_put(&_queue, message)) {
+		LOG_WRN("BLE MIDI queue full, message dropped");
+	}
+
+	_stats.messages++;
+	_stats.jitter_sum += jitter;
+	_stats.jitter_max = MAX(_stats.jitter_max, (uint32_t)jitter);
+
+	if (_stats.messages == _STATS_MESSAGES) {
+		LOG_INF("BLE MIDI arrival jitter mean %u us, max %u us, scheduling delay %u us, %u late",
+			_stats.jitter_sum / _stats.messages, _stats.jitter_max, CONFIG_BLE_MIDI_DELAY_US,
+			_stats.late);
+		memset(&_stats, 0, sizeof(_stats));
+	}
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _BLE_MIDI_H_
+#define _BLE_MIDI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "midi.h"
+
+/**@brief Register the connection callbacks of the BLE MIDI peripheral
+ *
+ * @return 0 if successful, error otherwise
+ */
+int ble_midi_init(void);
+
+/**@brief Start advertising the BLE MIDI service, restarted after each disconnect
+ *
+ * @return 0 if successful, error otherwise
+ */
+int ble_midi_start(void);
+
+/**@brief Get the next received message due before a time, from the audio processing context
+ *
+ * Messages are due a fixed delay, CONFIG_BLE_MIDI_DELAY_US, after the time they were sent,
+ * reconstructed from the BLE MIDI timestamps. The due time is in the timestamp of the message.
+ *
+ * @param before	Audio sync timer time in us
+ * @param message	Message to fill
+ *
+ * @return true if a message was due
+ */
+bool ble_midi_get(uint32_t before, struct midi_message *message);
+
+#endif /* _BLE_MIDI_H_ */
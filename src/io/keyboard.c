@@ -0,0 +1,173 @@
+#include "keyboard.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+#include "macros_common.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(keyboard, CONFIG_LOG_KEYBOARD_LEVEL);
+
+#define DT_DRV_COMPAT app_key_matrix
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "the keyboard requires one app,key-matrix node");
+
+#define _ROWS DT_INST_PROP_LEN(0, row_gpios)
+#define _COLUMNS DT_INST_PROP_LEN(0, col_gpios)
+
+BUILD_ASSERT(_ROWS * _COLUMNS <= 8 * sizeof(keyboard_keys_t), "too many keys for keyboard_keys_t");
+BUILD_ASSERT((CONFIG_KEYBOARD_QUEUE_SIZE & (CONFIG_KEYBOARD_QUEUE_SIZE - 1)) == 0, "keyboard queue size must be a power of two");
+
+#define _GPIO_SPEC(node_id, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx),
+
+static const struct gpio_dt_spec _rows[] = {
+    DT_INST_FOREACH_PROP_ELEM(0, row_gpios, _GPIO_SPEC)
+};
+
+static const struct gpio_dt_spec _columns[] = {
+    DT_INST_FOREACH_PROP_ELEM(0, col_gpios, _GPIO_SPEC)
+};
+
+/* debounced state, and a two bit counter per key of the scans the keys have differed from it */
+static keyboard_keys_t _state;
+static keyboard_keys_t _count0;
+static keyboard_keys_t _count1;
+
+/* single producer, the scan timer, and single consumer. Neither side locks or waits */
+static struct keyboard_change _queue[CONFIG_KEYBOARD_QUEUE_SIZE];
+static atomic_t _queue_head;
+static atomic_t _queue_tail;
+
+/* changes waiting while the queue is full, merged with the changes of the following scans */
+static struct keyboard_change _pending;
+
+static void _scan(struct k_timer* timer);
+static keyboard_keys_t _matrix_read(void);
+static bool _queue_put(const struct keyboard_change* change);
+
+K_TIMER_DEFINE(_scan_timer, _scan, NULL);
+
+int keyboard_init(void)
+{
+    int ret;
+
+    for (int i = 0; i < ARRAY_SIZE(_rows); i++) {
+        if (!device_is_ready(_rows[i].port)) {
+            return -ENODEV;
+        }
+
+        ret = gpio_pin_configure_dt(&_rows[i], GPIO_OUTPUT_INACTIVE);
+        RETURN_ON_ERR(ret);
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(_columns); i++) {
+        /* the columns of a row are read together */
+        if (_columns[i].port != _columns[0].port) {
+            LOG_ERR("keyboard columns must be on the same GPIO port");
+            return -EINVAL;
+        }
+
+        ret = gpio_pin_configure_dt(&_columns[i], GPIO_INPUT);
+        RETURN_ON_ERR(ret);
+    }
+
+    _state = 0;
+    _count0 = 0;
+    _count1 = 0;
+    _pending = (struct keyboard_change){0};
+
+    k_timer_start(&_scan_timer, K_MSEC(CONFIG_KEYBOARD_SCAN_PERIOD_MS), K_MSEC(CONFIG_KEYBOARD_SCAN_PERIOD_MS));
+
+    LOG_INF("keyboard of %d keys", _ROWS * _COLUMNS);
+
+    return 0;
+}
+
+bool keyboard_get(struct keyboard_change* change)
+{
+    __ASSERT_NO_MSG(change != NULL);
+
+    const uint32_t tail = atomic_get(&_queue_tail);
+    if (tail == (uint32_t)atomic_get(&_queue_head)) {
+        return false;
+    }
+
+    *change = _queue[tail & (CONFIG_KEYBOARD_QUEUE_SIZE - 1)];
+
+    /* the slot is handed back to the producer after it is read */
+    atomic_set(&_queue_tail, tail + 1);
+
+    return true;
+}
+
+static void _scan(struct k_timer* timer)
+{
+    ARG_UNUSED(timer);
+
+    const keyboard_keys_t sample = _matrix_read();
+
+    /* keys whose count reaches four consecutive scans different from the debounced state toggle. A scan
+     * equal to the state clears the count */
+    const keyboard_keys_t delta = sample ^ _state;
+    _count1 = (_count1 ^ _count0) & delta;
+    _count0 = ~_count0 & delta;
+
+    const keyboard_keys_t toggle = delta & ~(_count0 | _count1);
+    _state ^= toggle;
+
+    /* a key toggling back while its change is pending has not changed for the consumer */
+    const keyboard_keys_t undone = _pending.pressed | _pending.released;
+    _pending.pressed = (_pending.pressed | (toggle & _state)) & ~(undone & toggle);
+    _pending.released = (_pending.released | (toggle & ~_state)) & ~(undone & toggle);
+
+    if ((_pending.pressed | _pending.released) == 0) {
+        return;
+    }
+
+    if (_queue_put(&_pending)) {
+        _pending = (struct keyboard_change){0};
+    }
+}
+
+static keyboard_keys_t _matrix_read(void)
+{
+    keyboard_keys_t keys = 0;
+
+    for (int row = 0; row < _ROWS; row++) {
+        gpio_port_value_t value;
+
+        (void)gpio_pin_set_dt(&_rows[row], 1);
+        k_busy_wait(CONFIG_KEYBOARD_SETTLE_US);
+        const int ret = gpio_port_get(_columns[0].port, &value);
+        (void)gpio_pin_set_dt(&_rows[row], 0);
+
+        if (ret != 0) {
+            /* read as unchanged */
+            return _state;
+        }
+
+        for (int column = 0; column < _COLUMNS; column++) {
+            if (value & BIT(_columns[column].pin)) {
+                keys |= (keyboard_keys_t)1 << (row * _COLUMNS + column);
+            }
+        }
+    }
+
+    return keys;
+}
+
+static bool _queue_put(const struct keyboard_change* change)
+{
+    const uint32_t head = atomic_get(&_queue_head);
+
+    if (head - (uint32_t)atomic_get(&_queue_tail) == CONFIG_KEYBOARD_QUEUE_SIZE) {
+        return false;
+    }
+
+    _queue[head & (CONFIG_KEYBOARD_QUEUE_SIZE - 1)] = *change;
+
+    /* published after the change is written */
+    atomic_set(&_queue_head, head + 1);
+
+    return true;
+}
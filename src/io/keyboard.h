@@ -0,0 +1,35 @@
+/**
+ * @file keyboard.h
+ * @author Rein Gundersen Bentdal
+ * @brief Key matrix of the app,key-matrix devicetree node, scanned from a timer. Each scan reads the column
+ *  port once per row, debounces all keys together with vertical counters, and queues the changes of the scan
+ *  as one entry. While the queue is full, the latest state of each key is kept, so a key pressed and released
+ *  again in that time is not seen
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _KEYBOARD_H_
+#define _KEYBOARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* one bit per key, the index of a key is row * columns + column */
+typedef uint64_t keyboard_keys_t;
+
+struct keyboard_change {
+    keyboard_keys_t pressed;
+    keyboard_keys_t released;
+};
+
+/* keys pressed at init are reported as pressed by the first changes */
+int keyboard_init(void);
+
+/* from a single consumer, the audio processing context. Returns false if no change is pending */
+bool keyboard_get(struct keyboard_change* change);
+
+#endif
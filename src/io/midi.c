@@ -0,0 +1,136 @@
+#include "midi.h"
+
+#include <zephyr/kernel.h>
+
+#define _STATUS_BIT 0x80
+#define _SYSEX_START 0xF0
+#define _REAL_TIME_FIRST 0xF8
+
+void midi_parser_init(struct midi_parser* parser)
+{
+    __ASSERT_NO_MSG(parser != NULL);
+
+    parser->running_status = 0;
+    parser->count = 0;
+}
+
+/* number of data bytes following a channel status byte */
+static inline uint8_t _data_length(uint8_t status)
+{
+    switch (status & 0xF0) {
+        case MIDI_PROGRAM_CHANGE:
+        case MIDI_CHANNEL_PRESSURE:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+bool midi_parser_feed(struct midi_parser* parser, uint8_t byte, struct midi_message* message)
+{
+    __ASSERT_NO_MSG(parser != NULL);
+    __ASSERT_NO_MSG(message != NULL);
+
+    if (byte >= _REAL_TIME_FIRST) {
+        /* single byte, leaves running status and any partial message untouched */
+        switch (byte) {
+            case MIDI_CLOCK:
+            case MIDI_START:
+            case MIDI_CONTINUE:
+            case MIDI_STOP:
+                message->type = byte;
+                message->channel = 0;
+                message->data[0] = 0;
+                message->data[1] = 0;
+                return true;
+            default:
+                /* active sensing and reset are not used */
+                return false;
+        }
+    }
+
+    if (byte >= _SYSEX_START) {
+        /* data bytes of system exclusive and system common messages are ignored until the next status */
+        parser->running_status = 0;
+        parser->count = 0;
+        return false;
+    }
+
+    if (byte & _STATUS_BIT) {
+        parser->running_status = byte;
+        parser->count = 0;
+        return false;
+    }
+
+    /* data byte without a status, such as after system exclusive */
+    if (parser->running_status == 0) {
+        return false;
+    }
+
+    parser->data[parser->count++] = byte;
+    if (parser->count < _data_length(parser->running_status)) {
+        return false;
+    }
+
+    /* the next data bytes may start a new message with the same status */
+    parser->count = 0;
+
+    message->type = parser->running_status & 0xF0;
+    message->channel = parser->running_status & 0x0F;
+    message->data[0] = parser->data[0];
+    message->data[1] = _data_length(parser->running_status) == 2 ? parser->data[1] : 0;
+
+    if (message->type == MIDI_NOTE_ON && message->data[1] == 0) {
+        message->type = MIDI_NOTE_OFF;
+    }
+
+    return true;
+}
+
+bool midi_queue_put(struct midi_queue* queue, const struct midi_message* message)
+{
+    __ASSERT_NO_MSG(queue != NULL);
+
+    const uint32_t head = atomic_get(&queue->head);
+    if (head - (uint32_t)atomic_get(&queue->tail) == queue->size) {
+        return false;
+    }
+
+    queue->buffer[head & (queue->size - 1)] = *message;
+
+    /* published after the message is written */
+    atomic_set(&queue->head, head + 1);
+
+    return true;
+}
+
+bool midi_queue_get(struct midi_queue* queue, struct midi_message* message)
+{
+    __ASSERT_NO_MSG(queue != NULL);
+
+    const uint32_t tail = atomic_get(&queue->tail);
+    if (tail == (uint32_t)atomic_get(&queue->head)) {
+        return false;
+    }
+
+    *message = queue->buffer[tail & (queue->size - 1)];
+
+    /* the slot is handed back to the producer after it is read */
+    atomic_set(&queue->tail, tail + 1);
+
+    return true;
+}
+
+bool midi_queue_peek(struct midi_queue* queue, struct midi_message* message)
+{
+    __ASSERT_NO_MSG(queue != NULL);
+
+    const uint32_t tail = atomic_get(&queue->tail);
+    if (tail == (uint32_t)atomic_get(&queue->head)) {
+        return false;
+    }
+
+    *message = queue->buffer[tail & (queue->size - 1)];
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file midi.h
+ * @author Rein Gundersen Bentdal
+ * @brief MIDI messages, a byte stream parser with running status, and a lock-free queue for delivering
+ *  messages from an input interrupt to the audio processing context
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _MIDI_H_
+#define _MIDI_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <zephyr/sys/atomic.h>
+
+enum midi_type {
+    /* channel messages, the channel is in the lower nibble of the status byte */
+    MIDI_NOTE_OFF = 0x80,
+    MIDI_NOTE_ON = 0x90,
+    MIDI_POLY_PRESSURE = 0xA0,
+    MIDI_CONTROL_CHANGE = 0xB0,
+    MIDI_PROGRAM_CHANGE = 0xC0,
+    MIDI_CHANNEL_PRESSURE = 0xD0,
+    MIDI_PITCH_BEND = 0xE0,
+
+    /* real time messages, may arrive between the bytes of any other message */
+    MIDI_CLOCK = 0xF8,
+    MIDI_START = 0xFA,
+    MIDI_CONTINUE = 0xFB,
+    MIDI_STOP = 0xFC,
+};
+
+struct midi_message {
+    /* audio_sync_timer time of arrival, in us */
+    uint32_t timestamp;
+    uint8_t type;
+    uint8_t channel;
+    uint8_t data[2];
+};
+
+/* pitch bend is sent as a 14-bit value centered on 0x2000 */
+#define MIDI_PITCH_BEND_CENTER 0x2000
+
+static inline int32_t midi_pitch_bend(const struct midi_message* message)
+{
+    return (int32_t)(message->data[0] | (message->data[1] << 7)) - MIDI_PITCH_BEND_CENTER;
+}
+
+struct midi_parser {
+    uint8_t running_status;
+    uint8_t data[2];
+    uint8_t count;
+};
+
+void midi_parser_init(struct midi_parser* parser);
+
+/* returns true when byte completes a message, which is written to message without a timestamp.
+ * Note on with velocity 0 is returned as note off. System exclusive and system common messages are
+ * skipped, and cancel running status as the specification requires */
+bool midi_parser_feed(struct midi_parser* parser, uint8_t byte, struct midi_message* message);
+
+/* single producer, single consumer. Neither side locks or waits */
+struct midi_queue {
+    struct midi_message* buffer;
+    uint32_t size;
+    atomic_t head;
+    atomic_t tail;
+};
+
+/* size must be a power of two */
+#define MIDI_QUEUE_DEFINE(name, size_)                                   \
+    BUILD_ASSERT(((size_) & ((size_) - 1)) == 0, "MIDI queue size must be a power of two"); \
+    static struct midi_message name##_buffer[size_];                     \
+    static struct midi_queue name = {.buffer = name##_buffer, .size = (size_)}
+
+/* returns false if the queue is full, and the message is dropped */
+bool midi_queue_put(struct midi_queue* queue, const struct midi_message* message);
+
+/* returns false if the queue is empty */
+bool midi_queue_get(struct midi_queue* queue, struct midi_message* message);
+
+/* as midi_queue_get, but the message is left in the queue */
+bool midi_queue_peek(struct midi_queue* queue, struct midi_message* message);
+
+#endif
@@ -0,0 +1,132 @@
+#include "midi_uart.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+
+#include "audio_sync_timer.h"
+#include "macros_common.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(midi, CONFIG_LOG_MIDI_LEVEL);
+
+BUILD_ASSERT(DT_HAS_CHOSEN(app_midi_uart), "MIDI input requires a UART chosen as app,midi-uart");
+
+static const struct device* _uart = DEVICE_DT_GET(DT_CHOSEN(app_midi_uart));
+
+MIDI_QUEUE_DEFINE(_queue, CONFIG_MIDI_UART_QUEUE_SIZE);
+
+/* real time messages waiting for their time, consumed by the UART interrupt */
+MIDI_QUEUE_DEFINE(_tx_queue, 8);
+
+static struct midi_parser _parser;
+static atomic_t _dropped;
+
+static void _uart_isr(const struct device* dev, void* user_data);
+static void _tx_process(const struct device* dev);
+static void _tx_alarm(void);
+
+int midi_uart_init(void)
+{
+    if (!device_is_ready(_uart)) {
+        LOG_ERR("MIDI UART not ready");
+        return -ENODEV;
+    }
+
+    midi_parser_init(&_parser);
+
+    int ret = uart_irq_callback_user_data_set(_uart, _uart_isr, NULL);
+    RETURN_ON_ERR(ret);
+
+    uart_irq_rx_enable(_uart);
+
+    return 0;
+}
+
+bool midi_uart_get(struct midi_message* message)
+{
+    __ASSERT_NO_MSG(message != NULL);
+
+    return midi_queue_get(&_queue, message);
+}
+
+uint32_t midi_uart_dropped(void)
+{
+    return atomic_get(&_dropped);
+}
+
+bool midi_uart_realtime_send(enum midi_type type, uint32_t time_us)
+{
+    __ASSERT(type >= MIDI_CLOCK, "only real time messages are sent at a time");
+
+    const struct midi_message message = {
+        .timestamp = time_us,
+        .type = type,
+    };
+
+    if (!midi_queue_put(&_tx_queue, &message)) {
+        return false;
+    }
+
+    /* the interrupt sends the message, or sets an alarm for it */
+    uart_irq_tx_enable(_uart);
+
+    return true;
+}
+
+static void _uart_isr(const struct device* dev, void* user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (uart_irq_update(dev) && uart_irq_tx_ready(dev)) {
+        _tx_process(dev);
+    }
+
+    while (uart_irq_update(dev) && uart_irq_rx_ready(dev)) {
+        uint8_t bytes[8];
+        const int count = uart_fifo_read(dev, bytes, sizeof(bytes));
+        if (count <= 0) {
+            break;
+        }
+
+        /* at 31250 baud the bytes of one read arrived within a few ms, they share one timestamp */
+        const uint32_t timestamp = audio_sync_timer_curr_time_get();
+
+        for (int i = 0; i < count; i++) {
+            struct midi_message message;
+            if (!midi_parser_feed(&_parser, bytes[i], &message)) {
+                continue;
+            }
+
+            message.timestamp = timestamp;
+            if (!midi_queue_put(&_queue, &message)) {
+                atomic_inc(&_dropped);
+            }
+        }
+    }
+}
+
+static void _tx_process(const struct device* dev)
+{
+    struct midi_message message;
+
+    if (!midi_queue_peek(&_tx_queue, &message)) {
+        uart_irq_tx_disable(dev);
+        return;
+    }
+
+    /* not due yet, the transmitter waits for the alarm */
+    if (audio_sync_timer_alarm_set(message.timestamp, _tx_alarm) == 0) {
+        uart_irq_tx_disable(dev);
+        return;
+    }
+
+    if (uart_fifo_fill(dev, &message.type, 1) == 1) {
+        (void)midi_queue_get(&_tx_queue, &message);
+    }
+}
+
+static void _tx_alarm(void)
+{
+    uart_irq_tx_enable(_uart);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file midi_uart.h
+ * @author Rein Gundersen Bentdal
+ * @brief MIDI on the UART chosen as app,midi-uart in the devicetree. Bytes are parsed in the UART
+ *  interrupt, and each message is stamped with the audio sync timer on arrival. Real time messages are
+ *  sent at a time of the audio sync timer
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _MIDI_UART_H_
+#define _MIDI_UART_H_
+
+#include <stdbool.h>
+
+#include "midi.h"
+
+/* the audio sync timer should be running, since it stamps the messages */
+int midi_uart_init(void);
+
+/* from a single consumer, the audio processing context. Returns false if no message is pending */
+bool midi_uart_get(struct midi_message* message);
+
+/* messages dropped because the queue was full, for diagnostics */
+uint32_t midi_uart_dropped(void);
+
+/* sends a single byte real time message, such as MIDI_CLOCK, starting at time_us of the audio sync timer.
+ * Times should be in order. From a single producer, returns false if too many messages are waiting */
+bool midi_uart_realtime_send(enum midi_type type, uint32_t time_us);
+
+#endif
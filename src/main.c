@@ -22,6 +22,14 @@
 #include "synthesizer.h"
 #include "led.h"
 
+#if CONFIG_MIDI_UART
+#include "midi_uart.h"
+#endif
+
+#if CONFIG_KEYBOARD
+#include "keyboard.h"
+#endif
+
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(main, CONFIG_LOG_MAIN_LEVEL);
 
@@ -76,6 +84,16 @@ void main(void)
   ret = button_init();
   ERR_CHK_MSG(ret, "failed to initialize buttons");
 
+#if CONFIG_KEYBOARD
+  ret = keyboard_init();
+  ERR_CHK_MSG(ret, "failed to initialize keyboard");
+#endif
+
+#if CONFIG_MIDI_UART
+  ret = midi_uart_init();
+  ERR_CHK_MSG(ret, "failed to initialize MIDI input");
+#endif
+
   LOG_DBG("initialization finished");
 
   while (1) {
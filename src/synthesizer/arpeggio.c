@@ -1,128 +1,189 @@
 #include "arpeggio.h"
 
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+
 #include "tick_provider.h"
+#include "event_calendar.h"
+#include "lfsr.h"
+
+#define _NOTE_MAX 127
+
+struct arpeggio_note {
+    uint8_t note;
+    uint8_t velocity;
+};
+
+/* every held note in every octave, and twice that for up and down */
+#define _POOL_MAX (CONFIG_MAX_NOTES * ARPEGGIO_OCTAVES_MAX)
+#define _SEQUENCE_NOTES_MAX (2 * _POOL_MAX)
+
+BUILD_ASSERT(_SEQUENCE_NOTES_MAX <= UINT8_MAX, "steps are counted in 8 bits");
 
-static int _tick_count = 0;
+/* step i plays notes [i * notes_per_step, (i + 1) * notes_per_step) */
+struct arpeggio_sequence {
+    struct arpeggio_note notes[_SEQUENCE_NOTES_MAX];
+    uint8_t length;
+    uint8_t notes_per_step;
+};
 
-static struct keys _keys;
+static struct keys* _keys;
 
-static int _notes[CONFIG_MAX_NOTES] = {0};
-static int _notes_active_length = 0;
+/* held notes in the order they were played, owned by the writers */
+static struct arpeggio_note _held[CONFIG_MAX_NOTES];
+static size_t _held_length = 0;
 
-static int _arp_current_note = 0;
-static int _arp_current_note_idx = 0;
+static enum arpeggio_mode _mode = ARPEGGIO_MODE_UP;
+static uint8_t _octaves = 3;
+static uint32_t _random_state = LFSR_SEED;
 
-static struct k_mutex _mutex;
+/* writers run on the audio work queue as well, from MIDI and the sequencer, so they only hold a spinlock
+ * around the short rebuild of the sequence, as param_store does */
+static struct k_spinlock _write_lock;
 
-static bool _arp_enabled = false;
+/* triple buffer of step sequences, as in param_store. Writers build a sequence in their own buffer
+ * and publish it, the tick takes the latest published without waiting */
+static struct arpeggio_sequence _sequences[3];
 
-#define MAX_OCTAVES 3
-static uint32_t _arp_current_octave = 0;
+#define _PUBLISHED_INDEX_MASK 0x3
+#define _PUBLISHED_NEW BIT(2)
+
+static atomic_t _published;
+static uint8_t _write_index;
+static uint8_t _read_index;
+
+/* tick context */
+static bool _running = false;
+static uint32_t _tick_count = 0;
+static uint8_t _step = 0;
 
 static uint32_t _divider;
+static uint8_t _gate = 100;
+static uint32_t _gate_ticks;
 
-static void _remove_note(uint32_t index);
-static void _remove_first_note(void);
+static void _sequence_publish(void);
+static void _sequence_build(struct arpeggio_sequence* sequence);
+static void _sequence_acquire(void);
+static void _note_schedule(const struct arpeggio_note* note);
+static void _event_handle(const struct calendar_event* event);
+static void _gate_update(void);
 
-void arpeggio_init(key_play_cb play_cb, key_stop_cb stop_cb) {
-    __ASSERT_NO_MSG(play_cb != NULL);
-    __ASSERT_NO_MSG(stop_cb != NULL);
-    
-    k_mutex_init(&_mutex);
+void arpeggio_init(struct keys* keys) {
+    __ASSERT_NO_MSG(keys != NULL);
 
-    keys_init(&_keys, play_cb, stop_cb);
+    _keys = keys;
+
+    for (int i = 0; i < ARRAY_SIZE(_sequences); i++) {
+        _sequences[i].length = 0;
+        _sequences[i].notes_per_step = 1;
+    }
+    _write_index = 0;
+    _read_index = 1;
+    atomic_set(&_published, 2);
 
     _divider = PULSES_PER_QUARTER_NOTE;
+    _gate_update();
 }
 
-void arpeggio_note_add(int note) {
-    k_mutex_lock(&_mutex, K_FOREVER);
+void arpeggio_note_add(int note, uint8_t velocity) {
+    __ASSERT(note >= 0 && note <= _NOTE_MAX, "note out of range");
 
-    if (_notes_active_length == CONFIG_MAX_NOTES) {
-        _remove_first_note();
-        _notes_active_length--;
+    k_spinlock_key_t key = k_spin_lock(&_write_lock);
+
+    /* the oldest note makes room */
+    if (_held_length == CONFIG_MAX_NOTES) {
+        memmove(&_held[0], &_held[1], (CONFIG_MAX_NOTES - 1) * sizeof(_held[0]));
+        _held_length--;
     }
 
-    _notes[_notes_active_length] = note;
-    _notes_active_length++;
+    _held[_held_length] = (struct arpeggio_note) {
+        .note = note,
+        .velocity = velocity,
+    };
+    _held_length++;
 
-    /* restart arpeggio if first note */
-    if (_arp_enabled == false) {
-        _tick_count = 0;
-        _arp_enabled = true;
-        _arp_current_octave = 0;
-    }
+    _sequence_publish();
 
-    k_mutex_unlock(&_mutex);
+    k_spin_unlock(&_write_lock, key);
 }
 
 void arpeggio_note_remove(int note) {
-    k_mutex_lock(&_mutex, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&_write_lock);
 
-    for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
-        if (_notes[i] == note) {
-            _remove_note(i);
-            _notes_active_length--;
-
-            /* if removed note was last and current arp note was last, the next arp note has to loop back to first note */
-            if (_arp_current_note_idx == _notes_active_length) {
-                _arp_current_note_idx = 0;
-            }
-            
-            /* decrement next note if next note was shifted backwards */
-            else if (_arp_current_note_idx > i) {
-                _arp_current_note_idx--;
-            }
+    for (size_t i = 0; i < _held_length; i++) {
+        if (_held[i].note == note) {
+            memmove(&_held[i], &_held[i + 1], (_held_length - i - 1) * sizeof(_held[0]));
+            _held_length--;
 
+            _sequence_publish();
             break;
         }
     }
 
-    k_mutex_unlock(&_mutex);
+    k_spin_unlock(&_write_lock, key);
+}
+
+void arpeggio_set_mode(enum arpeggio_mode mode) {
+    __ASSERT(mode >= 0 && mode < ARPEGGIO_MODE_NUM, "arpeggio mode out of range");
+
+    k_spinlock_key_t key = k_spin_lock(&_write_lock);
+    _mode = mode;
+    _sequence_publish();
+    k_spin_unlock(&_write_lock, key);
+}
+
+void arpeggio_set_octaves(uint8_t octaves) {
+    __ASSERT(octaves >= 1 && octaves <= ARPEGGIO_OCTAVES_MAX, "octaves out of range");
+
+    k_spinlock_key_t key = k_spin_lock(&_write_lock);
+    _octaves = octaves;
+    _sequence_publish();
+    k_spin_unlock(&_write_lock, key);
+}
+
+void arpeggio_set_gate(uint8_t percent) {
+    __ASSERT(percent >= 1 && percent <= 100, "gate out of range");
+
+    _gate = percent;
+    _gate_update();
 }
 
 void arpeggio_tick(void) {
-    if (_arp_enabled == false) return;
+    _sequence_acquire();
+
+    const struct arpeggio_sequence* sequence = &_sequences[_read_index];
+
+    if (_running == false) {
+        if (sequence->length == 0) return;
+
+        /* restart arpeggio on the first note */
+        _running = true;
+        _tick_count = 0;
+        _step = 0;
+    }
 
     if (_tick_count == 0) {
 
-        /* stop last played note */
-        if (_arp_current_note != 0) {
-            keys_stop(&_keys, _arp_current_note);
+        /* stop when there are no held notes left, the last notes end by their gate */
+        if (sequence->length == 0) {
+            _running = false;
+            return;
         }
 
-        k_mutex_lock(&_mutex, K_FOREVER);
-
-        /* dont play new note if there are no active notes */
-        if (_notes_active_length == 0) {
-            _arp_enabled = false;
-            _arp_current_note = 0;
-        } 
-        
-        /* play next active note */
-        else {
-
-            /* increment to next note to play */
-            _arp_current_note_idx++;
-            if (_arp_current_note_idx == _notes_active_length) {
-                _arp_current_note_idx = 0;
-
-                _arp_current_octave++;
-                if (_arp_current_octave == MAX_OCTAVES) {
-                    _arp_current_octave = 0;
-                }
-            }
-            _arp_current_note = _notes[_arp_current_note_idx] + 12*_arp_current_octave;
-            
-            keys_play(&_keys, _arp_current_note);
+        const struct arpeggio_note* notes = &sequence->notes[_step * sequence->notes_per_step];
+        for (int i = 0; i < sequence->notes_per_step; i++) {
+            _note_schedule(&notes[i]);
         }
 
-        k_mutex_unlock(&_mutex);
+        _step++;
+        if (_step == sequence->length) {
+            _step = 0;
+        }
     }
 
     _tick_count++;
-    if (_tick_count == _divider) {
+    if (_tick_count >= _divider) {
         _tick_count = 0;
     }
 }
@@ -131,20 +192,152 @@ void arpeggio_set_divider(uint32_t divider) {
     __ASSERT_NO_MSG(divider != 0);
 
     _divider = divider;
+    _gate_update();
 
     /* make sure tick count is not larger than divider */
     _tick_count = 0;
 }
 
-static void _remove_note(uint32_t index) {
-    __ASSERT(index < CONFIG_MAX_NOTES, "index out of range");
+/* should be called with _write_lock held */
+static void _sequence_publish(void) {
+    _sequence_build(&_sequences[_write_index]);
 
-    for (int i = index + 1; i < CONFIG_MAX_NOTES; i++) {
-        _notes[i-1] =  _notes[i];
+    /* the previously published sequence is written next, unless the tick took it */
+    const atomic_val_t previous = atomic_set(&_published, _write_index | _PUBLISHED_NEW);
+    _write_index = previous & _PUBLISHED_INDEX_MASK;
+}
+
+static void _sequence_build(struct arpeggio_sequence* sequence) {
+    struct arpeggio_note ordered[CONFIG_MAX_NOTES];
+    memcpy(ordered, _held, _held_length * sizeof(_held[0]));
+
+    /* insertion sort by pitch, there are only a few notes */
+    if (_mode != ARPEGGIO_MODE_AS_PLAYED) {
+        for (size_t i = 1; i < _held_length; i++) {
+            const struct arpeggio_note note = ordered[i];
+            size_t j = i;
+            while (j > 0 && ordered[j - 1].note > note.note) {
+                ordered[j] = ordered[j - 1];
+                j--;
+            }
+            ordered[j] = note;
+        }
+    }
+
+    /* held notes repeated for each octave, leaving out octaves above the MIDI range */
+    struct arpeggio_note pool[_POOL_MAX];
+    size_t pool_length = 0;
+    size_t octaves = 0;
+    for (size_t octave = 0; octave < _octaves; octave++) {
+        bool complete = true;
+        for (size_t i = 0; i < _held_length; i++) {
+            const int note = ordered[i].note + 12 * octave;
+            if (note > _NOTE_MAX) {
+                complete = false;
+                continue;
+            }
+            pool[pool_length++] = (struct arpeggio_note) {
+                .note = note,
+                .velocity = ordered[i].velocity,
+            };
+        }
+        if (complete) {
+            octaves++;
+        }
+    }
+
+    sequence->notes_per_step = 1;
+
+    switch (_mode) {
+        case ARPEGGIO_MODE_UP:
+        case ARPEGGIO_MODE_AS_PLAYED:
+            memcpy(sequence->notes, pool, pool_length * sizeof(pool[0]));
+            sequence->length = pool_length;
+            break;
+        case ARPEGGIO_MODE_DOWN:
+            for (size_t i = 0; i < pool_length; i++) {
+                sequence->notes[i] = pool[pool_length - 1 - i];
+            }
+            sequence->length = pool_length;
+            break;
+        case ARPEGGIO_MODE_UP_DOWN: {
+            memcpy(sequence->notes, pool, pool_length * sizeof(pool[0]));
+            size_t length = pool_length;
+            for (size_t i = 1; i + 1 < pool_length; i++) {
+                sequence->notes[length++] = pool[pool_length - 1 - i];
+            }
+            sequence->length = length;
+            break;
+        }
+        case ARPEGGIO_MODE_RANDOM:
+            /* the whole sequence is drawn, so the loop is long enough not to be heard as one */
+            if (pool_length == 0) {
+                sequence->length = 0;
+                break;
+            }
+            for (size_t i = 0; i < _SEQUENCE_NOTES_MAX; i++) {
+                sequence->notes[i] = pool[lfsr_next(&_random_state) % pool_length];
+            }
+            sequence->length = _SEQUENCE_NOTES_MAX;
+            break;
+        case ARPEGGIO_MODE_CHORD:
+            /* only complete octaves, which are the first ones in the pool */
+            memcpy(sequence->notes, pool, octaves * _held_length * sizeof(pool[0]));
+            sequence->notes_per_step = MAX(_held_length, 1);
+            sequence->length = _held_length > 0 ? octaves : 0;
+            break;
+        default:
+            sequence->length = 0;
+            break;
     }
-    _notes[CONFIG_MAX_NOTES-1] = 0;
 }
 
-static void _remove_first_note(void) {
-    _remove_note(0);
-}
\ No newline at end of file
+static void _sequence_acquire(void) {
+    if ((atomic_get(&_published) & _PUBLISHED_NEW) == 0) {
+        return;
+    }
+
+    const atomic_val_t previous = atomic_set(&_published, _read_index);
+    _read_index = previous & _PUBLISHED_INDEX_MASK;
+
+    /* continue from the same position, if the new sequence is long enough */
+    if (_step >= _sequences[_read_index].length) {
+        _step = 0;
+    }
+}
+
+/* played at the frame of this tick, and stopped at the frame of the tick ending the gate */
+static void _note_schedule(const struct arpeggio_note* note) {
+    struct calendar_event event = {
+        .handler = _event_handle,
+        .type = CALENDAR_EVENT_NOTE_OFF,
+        .note = note->note,
+    };
+
+    /* the note off is scheduled first, a full calendar leaves the step silent rather than a note hanging */
+    if (event_calendar_schedule(_gate_ticks, 0, &event) != 0) {
+        return;
+    }
+
+    event.type = CALENDAR_EVENT_NOTE_ON;
+    event.velocity = note->velocity;
+    (void)event_calendar_schedule(0, 0, &event);
+}
+
+static void _event_handle(const struct calendar_event* event) {
+    switch (event->type) {
+        case CALENDAR_EVENT_NOTE_ON:
+            keys_play(_keys, event->note, event->velocity);
+            break;
+        case CALENDAR_EVENT_NOTE_OFF:
+            keys_stop(_keys, event->note);
+            break;
+        default:
+            break;
+    }
+}
+
+static void _gate_update(void) {
+    /* at a full gate, the notes end at the frame the next step starts, before it plays */
+    _gate_ticks = MAX(_divider * _gate / 100, 1);
+}
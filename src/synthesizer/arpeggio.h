@@ -17,13 +17,39 @@
 
 #include "key_assign.h"
 
-void arpeggio_init(key_play_cb play_cb, key_stop_cb stop_cb);
-
-void arpeggio_note_add(int note);
+#define ARPEGGIO_OCTAVES_MAX 4
+
+enum arpeggio_mode {
+    ARPEGGIO_MODE_UP,
+    ARPEGGIO_MODE_DOWN,
+    ARPEGGIO_MODE_UP_DOWN,      /* highest and lowest notes are not repeated at the turns */
+    ARPEGGIO_MODE_AS_PLAYED,
+    ARPEGGIO_MODE_RANDOM,
+    ARPEGGIO_MODE_CHORD,        /* all held notes on each step, one octave per step */
+    ARPEGGIO_MODE_NUM,
+};
+
+/* notes are played on the voices assigned by keys */
+void arpeggio_init(struct keys* keys);
+
+/* changes to the held notes and settings build a new step sequence, which is picked up by the next
+ * tick. Should not be called from the tick context */
+void arpeggio_note_add(int note, uint8_t velocity);
 void arpeggio_note_remove(int note);
 
+void arpeggio_set_mode(enum arpeggio_mode mode);
+
+/* number of octaves the held notes are repeated in, from 1 to ARPEGGIO_OCTAVES_MAX */
+void arpeggio_set_octaves(uint8_t octaves);
+
+/* time each step is played, in percent of the step from 1 to 100 */
+void arpeggio_set_gate(uint8_t percent);
+
+/* once for each tick, from the audio processing context. Schedules the notes of the next step and the
+ * end of their gate in the event calendar */
 void arpeggio_tick(void);
 
+/* ticks per step */
 void arpeggio_set_divider(uint32_t divider);
 
-#endif
\ No newline at end of file
+#endif
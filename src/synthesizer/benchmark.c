@@ -0,0 +1,463 @@
+#include "benchmark.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/timing/timing.h>
+
+#include "audio_process.h"
+#include "integer_math.h"
+
+#include "dsp/control_rate.h"
+#include "dsp/oscillator.h"
+#include "dsp/wavetable.h"
+#include "dsp/fm_voice.h"
+#include "dsp/pluck_voice.h"
+#include "dsp/drum_voice.h"
+#include "dsp/unison_osc.h"
+#include "dsp/effect_echo.h"
+#include "dsp/stereo.h"
+#include "dsp/graph.h"
+#include "dsp/effect_envelope.h"
+#include "dsp/filter_lowpass.h"
+#include "patch.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(synth_benchmark, CONFIG_LOG_SYNTH_BENCHMARK_LEVEL);
+
+/* each case is run for a number of frames, the average is reported */
+#define _FRAMES 8
+
+/* roughly middle C, independent of the pitch tables */
+#define _PHASE_INCREMENT (UINT32_MAX / 366)
+
+#define _VOICES_MAX (5 * UNISON_VOICES)
+
+/* short delay for the bus benchmark, the cost does not depend on the length */
+#define _ECHO_FRAMES 1024
+
+struct benchmark_case {
+    const char* name;
+    int voices;
+    void (*setup)(int voices);
+    bool (*process)(int voice, fixed16* block, size_t block_size);
+};
+
+static struct oscillator _osc;
+static struct wavetable_osc _wavetable;
+static struct fm_voice _fm;
+static struct pluck_voice _plucks[_VOICES_MAX];
+static struct drum_voice _drum;
+static struct oscillator _saws[_VOICES_MAX];
+static struct unison_osc _unisons[5];
+static struct effect_echo _echo;
+static stereo16 _echo_buf[_ECHO_FRAMES];
+static struct stereo32 _echo_buf_q31[_ECHO_FRAMES];
+
+static void _osc_setup(int voices);
+static bool _osc_triangle_process(int voice, fixed16* block, size_t block_size);
+static bool _osc_sine_process(int voice, fixed16* block, size_t block_size);
+static void _wavetable_setup(int voices);
+static bool _wavetable_process(int voice, fixed16* block, size_t block_size);
+static void _fm_stack_2_setup(int voices);
+static void _fm_stack_3_setup(int voices);
+static void _fm_stack_4_setup(int voices);
+static void _fm_pairs_4_setup(int voices);
+static bool _fm_process(int voice, fixed16* block, size_t block_size);
+static void _pluck_setup(int voices);
+static bool _pluck_process(int voice, fixed16* block, size_t block_size);
+static void _saw_setup(int voices);
+static bool _saw_process(int voice, fixed16* block, size_t block_size);
+static void _unison_setup(int voices);
+static bool _unison_process(int voice, fixed16* block, size_t block_size);
+static bool _unison_stereo_process(int voice, fixed16* block, size_t block_size);
+
+static void _drum_hit_costs(uint64_t budget);
+static void _bus_costs(uint64_t budget);
+static void _bus_report(const char* name, uint32_t cycles, uint64_t budget);
+#if CONFIG_SYNTH_GRAPH
+static void _graph_costs(uint64_t budget);
+#endif
+#if CONFIG_SYNTH_PATCH
+static void _patch_costs(uint64_t budget);
+#endif
+
+static const struct benchmark_case _cases[] = {
+    {"osc triangle", 1, _osc_setup, _osc_triangle_process},
+    {"osc sine", 1, _osc_setup, _osc_sine_process},
+    {"wavetable", 1, _wavetable_setup, _wavetable_process},
+    {"fm 2 op stack", 1, _fm_stack_2_setup, _fm_process},
+    {"fm 3 op stack", 1, _fm_stack_3_setup, _fm_process},
+    {"fm 4 op stack", 1, _fm_stack_4_setup, _fm_process},
+    {"fm 4 op pairs", 1, _fm_pairs_4_setup, _fm_process},
+    {"pluck", 5, _pluck_setup, _pluck_process},
+    {"pluck", 10, _pluck_setup, _pluck_process},
+    {"pluck", 20, _pluck_setup, _pluck_process},
+    /* supersaw on 5 keys, as separate oscillators and as one unison kernel per key */
+    {"osc sawtooth", 5 * UNISON_VOICES, _saw_setup, _saw_process},
+    {"unison", 5, _unison_setup, _unison_process},
+    {"unison stereo", 5, _unison_setup, _unison_stereo_process},
+};
+
+/* room for stereo frames, mono cases only use the first half */
+static stereo16 _block[AUDIO_BLOCK_FRAMES];
+static stereo16 _bus[AUDIO_BLOCK_FRAMES];
+static struct stereo32 _bus_q31[AUDIO_BLOCK_FRAMES];
+static int32_t _pcm32[AUDIO_BLOCK_SIZE];
+
+void synthesizer_benchmark_run(void)
+{
+    timing_init();
+    timing_start();
+
+    const uint64_t budget = (uint64_t)timing_freq_get_mhz() * CONFIG_AUDIO_FRAME_DURATION_US;
+    LOG_INF("frame budget: %u cycles, %u frames", (uint32_t)budget, AUDIO_BLOCK_FRAMES);
+
+    for (size_t c = 0; c < ARRAY_SIZE(_cases); c++) {
+        const struct benchmark_case* bench = &_cases[c];
+
+        __ASSERT(bench->voices <= _VOICES_MAX, "too many benchmark voices");
+        bench->setup(bench->voices);
+
+        timing_t start = timing_counter_get();
+        for (int frame = 0; frame < _FRAMES; frame++) {
+            /* voices are processed one control period at a time, as in the synthesizer */
+            for (int voice = 0; voice < bench->voices; voice++) {
+                for (size_t offset = 0; offset < AUDIO_BLOCK_FRAMES; offset += CONTROL_RATE_SAMPLES) {
+                    (void)bench->process(voice, (fixed16*)(_block + offset), CONTROL_RATE_SAMPLES);
+                }
+            }
+        }
+        timing_t end = timing_counter_get();
+
+        const uint32_t cycles = timing_cycles_get(&start, &end) / _FRAMES;
+        const uint32_t permille = (uint64_t)cycles * 1000 / budget;
+
+        const uint32_t cycles_per_voice = cycles / bench->voices;
+
+        LOG_INF("%s x%d: %u cycles per voice, %u.%u%% of frame, %u voices max",
+            bench->name, bench->voices, cycles_per_voice, permille / 10, permille % 10,
+            (uint32_t)(budget / MAX(cycles_per_voice, 1)));
+    }
+
+    _drum_hit_costs(budget);
+    _bus_costs(budget);
+#if CONFIG_SYNTH_GRAPH
+    _graph_costs(budget);
+#endif
+#if CONFIG_SYNTH_PATCH
+    _patch_costs(budget);
+#endif
+
+    timing_stop();
+}
+
+/* percussion is reported per hit, from trigger until the voice is silent */
+static void _drum_hit_costs(uint64_t budget)
+{
+    static const char* const names[DRUM_TYPE_NUM] = {
+        [DRUM_KICK] = "kick",
+        [DRUM_SNARE] = "snare",
+        [DRUM_HAT] = "hat",
+    };
+
+    for (int type = 0; type < DRUM_TYPE_NUM; type++) {
+        drum_voice_init(&_drum);
+        drum_voice_trigger(&_drum, type, FIXED16_LITERAL(0.8));
+
+        uint32_t samples = 0;
+
+        timing_t start = timing_counter_get();
+        while (drum_voice_process(&_drum, (fixed16*)_block, CONTROL_RATE_SAMPLES)) {
+            samples += CONTROL_RATE_SAMPLES;
+        }
+        timing_t end = timing_counter_get();
+
+        const uint32_t cycles = timing_cycles_get(&start, &end);
+        const uint32_t cycles_per_frame = (uint64_t)cycles * AUDIO_BLOCK_FRAMES / MAX(samples, 1);
+        const uint32_t permille = (uint64_t)cycles_per_frame * 1000 / budget;
+
+        LOG_INF("%s: %u cycles per hit over %u samples, %u.%u%% of frame while sounding",
+            names[type], cycles, samples, permille / 10, permille % 10);
+    }
+}
+
+/* bus modules per frame, in both sample formats of CONFIG_SYNTH_BUS_FORMAT */
+static void _bus_costs(uint64_t budget)
+{
+    const stereo16 gains = stereo_pan_gains(FIXED16_LITERAL(0.3));
+    timing_t start, end;
+
+#define _BUS_CASE(name, statement)                                                   \
+    start = timing_counter_get();                                                    \
+    for (int frame = 0; frame < _FRAMES; frame++) {                                  \
+        statement;                                                                   \
+    }                                                                                \
+    end = timing_counter_get();                                                      \
+    _bus_report(name, timing_cycles_get(&start, &end) / _FRAMES, budget)
+
+    _BUS_CASE("mix panned q15", stereo_mix_panned(_bus, (fixed16*)_block, AUDIO_BLOCK_FRAMES, gains));
+    _BUS_CASE("mix panned q31", stereo32_mix_panned(_bus_q31, (fixed16*)_block, AUDIO_BLOCK_FRAMES, gains));
+    _BUS_CASE("mix stereo q15", stereo_mix(_bus, _block, AUDIO_BLOCK_FRAMES));
+    _BUS_CASE("mix stereo q31", stereo32_mix(_bus_q31, _block, AUDIO_BLOCK_FRAMES));
+
+    effect_echo_init(&_echo, _echo_buf, ARRAY_SIZE(_echo_buf));
+    effect_echo_set_feedback(&_echo, FIXED16_LITERAL(0.4));
+    _BUS_CASE("echo q15",
+        for (size_t offset = 0; offset < AUDIO_BLOCK_FRAMES; offset += CONTROL_RATE_SAMPLES) {
+            (void)effect_echo_process(&_echo, _bus + offset, CONTROL_RATE_SAMPLES);
+        });
+
+    effect_echo_init_q31(&_echo, _echo_buf_q31, ARRAY_SIZE(_echo_buf_q31));
+    effect_echo_set_feedback(&_echo, FIXED16_LITERAL(0.4));
+    _BUS_CASE("echo q31",
+        for (size_t offset = 0; offset < AUDIO_BLOCK_FRAMES; offset += CONTROL_RATE_SAMPLES) {
+            (void)effect_echo_process_q31(&_echo, _bus_q31 + offset, CONTROL_RATE_SAMPLES);
+        });
+
+    /* 16-bit output from the packed bus needs no conversion */
+    _BUS_CASE("pcm16 from q31", stereo32_to_pcm16(_bus_q31, (int16_t*)_block, AUDIO_BLOCK_FRAMES));
+    _BUS_CASE("pcm32 from q15", stereo16_to_pcm32(_bus, _pcm32, AUDIO_BLOCK_FRAMES));
+    _BUS_CASE("pcm24 from q31", stereo32_to_pcm32(_bus_q31, _pcm32, AUDIO_BLOCK_FRAMES, 24));
+
+#undef _BUS_CASE
+}
+
+static void _bus_report(const char* name, uint32_t cycles, uint64_t budget)
+{
+    const uint32_t permille = (uint64_t)cycles * 1000 / budget;
+    LOG_INF("%s: %u cycles, %u.%u%% of frame", name, cycles, permille / 10, permille % 10);
+}
+
+#if CONFIG_SYNTH_GRAPH
+/* four filtered voices into a mixer and an echo, the voice chain of the synthesizer as a graph */
+static void _graph_costs(uint64_t budget)
+{
+    graph_clear();
+
+    const int mixer = graph_node_add(GRAPH_NODE_MIXER);
+    const int echo = graph_node_add(GRAPH_NODE_ECHO);
+    effect_echo_init(&graph_node_get(echo)->echo, _echo_buf, ARRAY_SIZE(_echo_buf));
+    effect_echo_set_feedback(&graph_node_get(echo)->echo, FIXED16_LITERAL(0.4));
+    (void)graph_connect(mixer, echo, GRAPH_GAINS_UNITY);
+    graph_set_output(echo);
+
+    for (int i = 0; i < GRAPH_INPUTS_MAX; i++) {
+        const int osc = graph_node_add(GRAPH_NODE_OSCILLATOR);
+        const int envelope = graph_node_add(GRAPH_NODE_ENVELOPE);
+        const int lowpass = graph_node_add(GRAPH_NODE_LOWPASS);
+
+        struct graph_node* node = graph_node_get(osc);
+        node->waveform = GRAPH_WAVEFORM_TRIANGLE;
+        osc_set_phase_increment(&node->oscillator, _PHASE_INCREMENT * (i + 1));
+        osc_set_amplitude(&node->oscillator, FLOAT_TO_FIXED16(0.2f));
+
+        effect_envelope_set_period(&graph_node_get(envelope)->envelope, 150);
+        effect_envelope_set_mode(&graph_node_get(envelope)->envelope, ENVELOPE_MODE_LOOP);
+        effect_envelope_start(&graph_node_get(envelope)->envelope);
+        filter_lowpass_set_cutoff(&graph_node_get(lowpass)->lowpass, FIXED16_LITERAL(0.6));
+
+        (void)graph_connect(osc, envelope, 0);
+        (void)graph_connect(envelope, lowpass, 0);
+        (void)graph_connect(lowpass, mixer, stereo_pan_gains(FLOAT_TO_FIXED16(-0.6f + 0.4f * i)));
+    }
+
+    if (graph_update() != 0) {
+        LOG_WRN("graph benchmark not scheduled");
+        graph_clear();
+        return;
+    }
+
+    timing_t start = timing_counter_get();
+    for (int frame = 0; frame < _FRAMES; frame++) {
+        (void)graph_process(AUDIO_BLOCK_FRAMES);
+    }
+    timing_t end = timing_counter_get();
+
+    LOG_INF("graph of %d nodes on %zu buffers:", 2 + 3 * GRAPH_INPUTS_MAX, graph_buffers_used());
+    _bus_report("graph", timing_cycles_get(&start, &end) / _FRAMES, budget);
+
+    graph_clear();
+}
+#endif
+
+#if CONFIG_SYNTH_PATCH
+static struct oscillator _generic_osc[CONFIG_MAX_NOTES];
+static struct effect_envelope _generic_envelopes[CONFIG_MAX_NOTES];
+static struct filter_lowpass _generic_lowpass[CONFIG_MAX_NOTES];
+static stereo16 _generic_pan_gains[CONFIG_MAX_NOTES];
+
+/* the default patch.yaml on all voices, compiled and as the generic voice loop of the synthesizer
+ * with indexed state, control rate sub blocks and pan gains looked up per voice */
+static void _patch_costs(uint64_t budget)
+{
+    for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
+        const fixed16 pan = CONFIG_MAX_NOTES > 1 ? FIXED16_LITERAL(-0.6) + 2 * FIXED16_LITERAL(0.6) * i / (CONFIG_MAX_NOTES - 1) : 0;
+
+        osc_init(&_generic_osc[i]);
+        osc_set_phase_increment(&_generic_osc[i], _PHASE_INCREMENT * (i + 1));
+        osc_set_amplitude(&_generic_osc[i], FLOAT_TO_FIXED16(1.0f / CONFIG_MAX_NOTES));
+        effect_envelope_init(&_generic_envelopes[i]);
+        effect_envelope_set_period(&_generic_envelopes[i], 150);
+        effect_envelope_set_duty_cycle(&_generic_envelopes[i], 0.1f);
+        effect_envelope_set_mode(&_generic_envelopes[i], ENVELOPE_MODE_ONE_SHOT);
+        effect_envelope_set_floor(&_generic_envelopes[i], 0.2f);
+        effect_envelope_start(&_generic_envelopes[i]);
+        filter_lowpass_init(&_generic_lowpass[i]);
+        filter_lowpass_set_cutoff(&_generic_lowpass[i], FIXED16_LITERAL(0.6));
+        _generic_pan_gains[i] = stereo_pan_gains(pan);
+
+        patch_note_on(i, _PHASE_INCREMENT * (i + 1), FLOAT_TO_FIXED16(1.0f / CONFIG_MAX_NOTES));
+    }
+
+    effect_echo_init(&_echo, _echo_buf, ARRAY_SIZE(_echo_buf));
+    effect_echo_set_feedback(&_echo, FIXED16_LITERAL(0.4));
+
+    timing_t start = timing_counter_get();
+    for (int frame = 0; frame < _FRAMES; frame++) {
+        for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
+            if (!effect_envelope_is_active(&_generic_envelopes[i])) continue;
+
+            fixed16* voice = (fixed16*)_block;
+            for (size_t offset = 0; offset < AUDIO_BLOCK_FRAMES; offset += CONTROL_RATE_SAMPLES) {
+                (void)osc_process_triangle(&_generic_osc[i], voice + offset, CONTROL_RATE_SAMPLES);
+                (void)filter_lowpass_process(&_generic_lowpass[i], voice + offset, CONTROL_RATE_SAMPLES);
+            }
+            (void)effect_envelope_process(&_generic_envelopes[i], voice, AUDIO_BLOCK_FRAMES);
+            stereo_mix_panned(_bus, voice, AUDIO_BLOCK_FRAMES, _generic_pan_gains[i]);
+        }
+        for (size_t offset = 0; offset < AUDIO_BLOCK_FRAMES; offset += CONTROL_RATE_SAMPLES) {
+            (void)effect_echo_process(&_echo, _bus + offset, CONTROL_RATE_SAMPLES);
+        }
+    }
+    timing_t end = timing_counter_get();
+    const uint32_t generic = timing_cycles_get(&start, &end) / _FRAMES;
+
+    start = timing_counter_get();
+    for (int frame = 0; frame < _FRAMES; frame++) {
+        patch_voices_process(_bus, AUDIO_BLOCK_FRAMES);
+        patch_bus_process(_bus, AUDIO_BLOCK_FRAMES);
+    }
+    end = timing_counter_get();
+    const uint32_t patch = timing_cycles_get(&start, &end) / _FRAMES;
+
+    LOG_INF("%d voices of %s:", CONFIG_MAX_NOTES, CONFIG_SYNTH_PATCH_FILE);
+    _bus_report("generic voice loop", generic, budget);
+    _bus_report("compiled patch", patch, budget);
+
+    const uint32_t speedup = (uint64_t)generic * 100 / MAX(patch, 1);
+    LOG_INF("compiled patch speedup: %u.%02ux", speedup / 100, speedup % 100);
+
+    for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
+        patch_note_off(i);
+    }
+}
+#endif
+
+static void _osc_setup(int voices)
+{
+    osc_init(&_osc);
+    osc_set_phase_increment(&_osc, _PHASE_INCREMENT);
+    osc_set_amplitude(&_osc, FLOAT_TO_FIXED16(0.5f));
+}
+
+static bool _osc_triangle_process(int voice, fixed16* block, size_t block_size)
+{
+    return osc_process_triangle(&_osc, block, block_size);
+}
+
+static bool _osc_sine_process(int voice, fixed16* block, size_t block_size)
+{
+    return osc_process_sine(&_osc, block, block_size);
+}
+
+static void _wavetable_setup(int voices)
+{
+    wavetable_osc_init(&_wavetable, &wavetable_basic);
+    wavetable_osc_set_phase_increment(&_wavetable, _PHASE_INCREMENT);
+    wavetable_osc_set_amplitude(&_wavetable, FLOAT_TO_FIXED16(0.5f));
+
+    /* between two frames, the slower crossfading path */
+    wavetable_osc_set_morph(&_wavetable, UINT16_MAX / 2);
+}
+
+static bool _wavetable_process(int voice, fixed16* block, size_t block_size)
+{
+    return wavetable_osc_process(&_wavetable, block, block_size);
+}
+
+static void _fm_setup(uint8_t operators, enum fm_algorithm algorithm)
+{
+    fm_voice_init(&_fm, operators, algorithm);
+    for (int i = 1; i < operators; i++) {
+        fm_voice_set_operator(&_fm, i, (float)(i + 1), FLOAT_TO_FIXED16(0.3f));
+    }
+    fm_voice_set_phase_increment(&_fm, _PHASE_INCREMENT);
+    fm_voice_set_amplitude(&_fm, FLOAT_TO_FIXED16(0.5f));
+    fm_voice_start(&_fm);
+}
+
+static void _fm_stack_2_setup(int voices) { _fm_setup(2, FM_ALGORITHM_STACK); }
+static void _fm_stack_3_setup(int voices) { _fm_setup(3, FM_ALGORITHM_STACK); }
+static void _fm_stack_4_setup(int voices) { _fm_setup(4, FM_ALGORITHM_STACK); }
+static void _fm_pairs_4_setup(int voices) { _fm_setup(4, FM_ALGORITHM_PAIRS); }
+
+static bool _fm_process(int voice, fixed16* block, size_t block_size)
+{
+    return fm_voice_process(&_fm, block, block_size);
+}
+
+static void _pluck_setup(int voices)
+{
+    /* delay lines of the previous case are returned first */
+    for (int i = 0; i < _VOICES_MAX; i++) {
+        pluck_voice_release(&_plucks[i]);
+    }
+
+    for (int i = 0; i < voices; i++) {
+        pluck_voice_init(&_plucks[i]);
+        pluck_voice_set_amplitude(&_plucks[i], FLOAT_TO_FIXED16(0.5f));
+
+        /* spread across an octave, the delay lines share the pool */
+        if (!pluck_voice_start(&_plucks[i], _PHASE_INCREMENT + i * (_PHASE_INCREMENT / voices))) {
+            LOG_WRN("delay pool exhausted at pluck voice %d", i);
+        }
+    }
+}
+
+static bool _pluck_process(int voice, fixed16* block, size_t block_size)
+{
+    return pluck_voice_process(&_plucks[voice], block, block_size);
+}
+
+static void _saw_setup(int voices)
+{
+    for (int i = 0; i < voices; i++) {
+        osc_init(&_saws[i]);
+        osc_set_phase_increment(&_saws[i], _PHASE_INCREMENT + i * 1000);
+        osc_set_amplitude(&_saws[i], FLOAT_TO_FIXED16(0.1f));
+    }
+}
+
+static bool _saw_process(int voice, fixed16* block, size_t block_size)
+{
+    return osc_process_sawtooth(&_saws[voice], block, block_size);
+}
+
+static void _unison_setup(int voices)
+{
+    for (int i = 0; i < voices; i++) {
+        unison_osc_init(&_unisons[i]);
+        unison_osc_set_phase_increment(&_unisons[i], _PHASE_INCREMENT + i * 1000);
+        unison_osc_set_amplitude(&_unisons[i], FLOAT_TO_FIXED16(0.5f));
+        unison_osc_start(&_unisons[i]);
+    }
+}
+
+static bool _unison_process(int voice, fixed16* block, size_t block_size)
+{
+    return unison_osc_process(&_unisons[voice], block, block_size);
+}
+
+static bool _unison_stereo_process(int voice, fixed16* block, size_t block_size)
+{
+    return unison_osc_process_stereo(&_unisons[voice], (stereo16*)block, block_size);
+}
@@ -0,0 +1,18 @@
+/**
+ * @file benchmark.h
+ * @author Rein Gundersen Bentdal
+ * @brief Cycle count of the voice kernels and bus modules, reported against the budget of one audio frame
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SYNTHESIZER_BENCHMARK_H_
+#define _SYNTHESIZER_BENCHMARK_H_
+
+/* blocking, should be called before audio processing is started */
+void synthesizer_benchmark_run(void);
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file adpcm.h
+ * @author Rein Gundersen Bentdal
+ * @brief IMA ADPCM decoder, 4-bit nibbles with the low nibble of each byte first
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _ADPCM_H_
+#define _ADPCM_H_
+
+#include <stdint.h>
+
+#include "integer_math.h"
+
+struct adpcm_state {
+    int32_t predictor;
+    int32_t step_index;
+};
+
+extern const int16_t adpcm_step_table[89];
+extern const int8_t adpcm_index_table[16];
+
+static inline fixed16 adpcm_decode(struct adpcm_state* state, uint8_t nibble) __attribute__((always_inline, unused));
+static inline fixed16 adpcm_decode(struct adpcm_state* state, uint8_t nibble) {
+    const int32_t step = adpcm_step_table[state->step_index];
+
+    int32_t diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+
+    int32_t predictor = state->predictor + ((nibble & 8) ? -diff : diff);
+    if (predictor > INT16_MAX) predictor = INT16_MAX;
+    if (predictor < INT16_MIN) predictor = INT16_MIN;
+
+    int32_t step_index = state->step_index + adpcm_index_table[nibble];
+    if (step_index < 0) step_index = 0;
+    if (step_index > 88) step_index = 88;
+
+    state->predictor = predictor;
+    state->step_index = step_index;
+
+    return predictor;
+}
+
+/* nibble of sample n in a packed stream */
+static inline uint8_t adpcm_nibble(const uint8_t* data, uint32_t n) __attribute__((always_inline, unused));
+static inline uint8_t adpcm_nibble(const uint8_t* data, uint32_t n) {
+    const uint8_t byte = data[n >> 1];
+    return (n & 1) ? byte >> 4 : byte & 0x0F;
+}
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * @file control_rate.h
+ * @author Rein Gundersen Bentdal
+ * @brief Helpers for parameters updated at control rate and ramped linearly at audio rate
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _CONTROL_RATE_H_
+#define _CONTROL_RATE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "integer_math.h"
+
+/* number of audio samples between each evaluation of modulation sources */
+#define CONTROL_RATE_SAMPLES CONFIG_SYNTH_CONTROL_RATE_SAMPLES
+
+/* multiplies the block with a gain linearly ramped from start to end */
+static inline void control_rate_gain_ramp(fixed16* block, size_t block_size, fixed16 start, fixed16 end) __attribute__((always_inline, unused));
+static inline void control_rate_gain_ramp(fixed16* block, size_t block_size, fixed16 start, fixed16 end)
+{
+    /* unity gain, nothing to do */
+    if (start == INT16_MAX && end == INT16_MAX) {
+        return;
+    }
+
+    int32_t gain = (int32_t)start << 16;
+    const int32_t gain_ramp = (((int32_t)end - start) << 16) / (int32_t)block_size;
+
+    for (size_t i = 0; i < block_size; i++) {
+        block[i] = FIXED_MULTIPLY(block[i], gain >> 16);
+        gain += gain_ramp;
+    }
+}
+
+/* clamps a modulated value to the unipolar range [0, 1] */
+static inline fixed16 control_rate_clamp_unipolar(int32_t val) __attribute__((always_inline, unused));
+static inline fixed16 control_rate_clamp_unipolar(int32_t val)
+{
+    if (val < 0) return 0;
+    if (val > INT16_MAX) return INT16_MAX;
+    return val;
+}
+
+#endif
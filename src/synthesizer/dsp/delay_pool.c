@@ -0,0 +1,84 @@
+#include "delay_pool.h"
+
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#define _GRANULES (CONFIG_SYNTH_DELAY_POOL_SAMPLES / DELAY_POOL_GRANULE_SAMPLES)
+#define _WORDS ((_GRANULES + 31) / 32)
+
+BUILD_ASSERT(CONFIG_SYNTH_DELAY_POOL_SAMPLES % DELAY_POOL_GRANULE_SAMPLES == 0, "delay pool must be a whole number of granules");
+
+static fixed16 _pool[CONFIG_SYNTH_DELAY_POOL_SAMPLES];
+
+/* one bit per granule, set when in use */
+static uint32_t _used[_WORDS];
+
+static inline size_t _granules(size_t samples);
+static inline bool _is_used(size_t granule);
+static void _mark(size_t first, size_t count, bool used);
+
+fixed16* delay_pool_alloc(size_t samples)
+{
+    __ASSERT_NO_MSG(samples > 0);
+
+    const size_t count = _granules(samples);
+
+    /* first fit */
+    size_t run = 0;
+    for (size_t granule = 0; granule < _GRANULES; granule++) {
+        run = _is_used(granule) ? 0 : run + 1;
+
+        if (run == count) {
+            const size_t first = granule + 1 - count;
+            _mark(first, count, true);
+
+            fixed16* buffer = &_pool[first * DELAY_POOL_GRANULE_SAMPLES];
+            memset(buffer, 0, count * DELAY_POOL_GRANULE_SAMPLES * sizeof(buffer[0]));
+            return buffer;
+        }
+    }
+
+    return NULL;
+}
+
+void delay_pool_free(fixed16* buffer, size_t samples)
+{
+    if (buffer == NULL) {
+        return;
+    }
+
+    __ASSERT(buffer >= _pool && buffer < _pool + ARRAY_SIZE(_pool), "buffer not from delay pool");
+
+    const size_t first = (buffer - _pool) / DELAY_POOL_GRANULE_SAMPLES;
+    _mark(first, _granules(samples), false);
+}
+
+size_t delay_pool_available(void)
+{
+    size_t available = 0;
+    for (size_t granule = 0; granule < _GRANULES; granule++) {
+        if (!_is_used(granule)) available += DELAY_POOL_GRANULE_SAMPLES;
+    }
+    return available;
+}
+
+static inline size_t _granules(size_t samples)
+{
+    return (samples + DELAY_POOL_GRANULE_SAMPLES - 1) / DELAY_POOL_GRANULE_SAMPLES;
+}
+
+static inline bool _is_used(size_t granule)
+{
+    return _used[granule / 32] & (1u << (granule % 32));
+}
+
+static void _mark(size_t first, size_t count, bool used)
+{
+    for (size_t granule = first; granule < first + count; granule++) {
+        if (used) {
+            _used[granule / 32] |= 1u << (granule % 32);
+        } else {
+            _used[granule / 32] &= ~(1u << (granule % 32));
+        }
+    }
+}
@@ -0,0 +1,32 @@
+/**
+ * @file delay_pool.h
+ * @author Rein Gundersen Bentdal
+ * @brief Shared memory pool for short per-voice delay lines, sized by CONFIG_SYNTH_DELAY_POOL_SAMPLES
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _DELAY_POOL_H_
+#define _DELAY_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "integer_math.h"
+
+/* allocations are rounded up to a whole number of granules */
+#define DELAY_POOL_GRANULE_SAMPLES 64
+
+/* returns NULL if there is no contiguous space left. Memory is zeroed */
+fixed16* delay_pool_alloc(size_t samples);
+
+/* samples must be the same as given to delay_pool_alloc */
+void delay_pool_free(fixed16* buffer, size_t samples);
+
+/* number of free samples, for diagnostics */
+size_t delay_pool_available(void);
+
+#endif
@@ -0,0 +1,153 @@
+#include "drum_voice.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "waveforms.h"
+#include "lfsr.h"
+#include "pitch_table.h"
+#include "control_rate.h"
+
+#define SAMPLES_PER_MSEC (CONFIG_AUDIO_SAMPLE_RATE_HZ / 1000.0)
+
+/* per control period coefficient decaying to 1/e after ms, first order approximation */
+#define _DECAY(ms) FIXED16_LITERAL(1.0 - CONTROL_RATE_SAMPLES / ((ms) * SAMPLES_PER_MSEC))
+
+/* amplitude where the hit is considered finished */
+#define _SILENT 8
+
+struct drum_preset {
+    uint8_t note_start;
+    uint8_t note_end;
+    fixed16 pitch_decay;
+    fixed16 tone_level;
+
+    fixed16 filter_coefficient;
+    bool highpass;
+    fixed16 noise_level;
+
+    fixed16 amplitude_decay;
+};
+
+static const struct drum_preset _kit[DRUM_TYPE_NUM] = {
+    [DRUM_KICK] = {
+        .note_start = 55, .note_end = 33, .pitch_decay = _DECAY(25), .tone_level = FIXED16_LITERAL(1.0),
+        .filter_coefficient = FIXED16_LITERAL(0.05), .highpass = false, .noise_level = FIXED16_LITERAL(0.0),
+        .amplitude_decay = _DECAY(150),
+    },
+    [DRUM_SNARE] = {
+        .note_start = 57, .note_end = 54, .pitch_decay = _DECAY(10), .tone_level = FIXED16_LITERAL(0.4),
+        .filter_coefficient = FIXED16_LITERAL(0.5), .highpass = false, .noise_level = FIXED16_LITERAL(0.7),
+        .amplitude_decay = _DECAY(60),
+    },
+    [DRUM_HAT] = {
+        .note_start = 0, .note_end = 0, .pitch_decay = 0, .tone_level = FIXED16_LITERAL(0.0),
+        .filter_coefficient = FIXED16_LITERAL(0.3), .highpass = true, .noise_level = FIXED16_LITERAL(0.8),
+        .amplitude_decay = _DECAY(20),
+    },
+};
+
+void drum_voice_init(struct drum_voice* voice)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    *voice = (struct drum_voice) {
+        .active = false,
+        .noise = LFSR_SEED,
+    };
+}
+
+void drum_voice_trigger(struct drum_voice* voice, enum drum_type type, fixed16 level)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT(type < DRUM_TYPE_NUM, "drum type out of range");
+
+    const struct drum_preset* preset = &_kit[type];
+
+    voice->active = true;
+
+    voice->phase_accumulate = 0;
+    voice->phase_increment = note_phase_increment[preset->note_start];
+    voice->phase_increment_end = note_phase_increment[preset->note_end];
+    voice->pitch_decay = preset->pitch_decay;
+    voice->tone_level = preset->tone_level;
+
+    voice->filter_state = 0;
+    voice->filter_coefficient = preset->filter_coefficient;
+    voice->highpass = preset->highpass;
+    voice->noise_level = preset->noise_level;
+
+    voice->amplitude = level;
+    voice->amplitude_decay = preset->amplitude_decay;
+}
+
+bool drum_voice_process(struct drum_voice* voice, fixed16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (!voice->active) {
+        return false;
+    }
+
+    /* envelopes advance once per call, expected to be one control period */
+    const fixed16 amplitude_end = FIXED_MULTIPLY(voice->amplitude, voice->amplitude_decay);
+    int32_t amplitude = (int32_t)voice->amplitude << 16;
+    const int32_t amplitude_ramp = (((int32_t)amplitude_end - voice->amplitude) << 16) / (int32_t)block_size;
+
+    uint32_t phase_accumulate = voice->phase_accumulate;
+    const uint32_t phase_increment = voice->phase_increment;
+    const fixed16 tone_level = voice->tone_level;
+
+    uint32_t noise = voice->noise;
+    int32_t filter_state = voice->filter_state;
+    const int32_t filter_coefficient = voice->filter_coefficient;
+    const fixed16 noise_level = voice->noise_level;
+    const bool highpass = voice->highpass;
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        const fixed16 tone = sine_sample(phase_accumulate);
+        phase_accumulate += phase_increment;
+
+        const fixed16 white = lfsr_next(&noise) >> 16;
+        filter_state += (filter_coefficient * (white - filter_state)) >> 15;
+        const fixed16 filtered = highpass ? saturate16(white - filter_state) : filter_state;
+
+        const int32_t sample = FIXED_MULTIPLY(tone, tone_level) + FIXED_MULTIPLY(filtered, noise_level);
+        block[i] = FIXED_MULTIPLY(saturate16(sample), amplitude >> 16);
+
+        amplitude += amplitude_ramp;
+    }
+
+    voice->phase_accumulate = phase_accumulate;
+    voice->phase_increment = voice->phase_increment_end +
+        (((int64_t)voice->phase_increment - voice->phase_increment_end) * voice->pitch_decay >> 15);
+    voice->noise = noise;
+    voice->filter_state = filter_state;
+    voice->amplitude = amplitude_end;
+
+    if (amplitude_end < _SILENT) {
+        voice->active = false;
+    }
+
+    return true;
+}
+
+enum drum_type drum_type_from_note(uint8_t note)
+{
+    switch (note) {
+        case 35:
+        case 36:
+            return DRUM_KICK;
+        case 38:
+        case 40:
+            return DRUM_SNARE;
+        case 42:
+        case 44:
+        case 46:
+            return DRUM_HAT;
+        default:
+            return DRUM_TYPE_NUM;
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file drum_voice.h
+ * @author Rein Gundersen Bentdal
+ * @brief Synthesized percussion. A pitch swept sine and one-pole filtered LFSR noise, with every
+ *  coefficient taken from a constant kit table when triggered
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _DRUM_VOICE_H_
+#define _DRUM_VOICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+
+enum drum_type {
+    DRUM_KICK,
+    DRUM_SNARE,
+    DRUM_HAT,
+    DRUM_TYPE_NUM,
+};
+
+struct drum_voice {
+    bool active;
+
+    /* tone, the increment decays towards its end value once per control period */
+    uint32_t phase_accumulate;
+    uint32_t phase_increment;
+    uint32_t phase_increment_end;
+    fixed16 pitch_decay;
+    fixed16 tone_level;
+
+    /* noise, lowpassed or highpassed by a one-pole filter */
+    uint32_t noise;
+    int32_t filter_state;
+    fixed16 filter_coefficient;
+    bool highpass;
+    fixed16 noise_level;
+
+    /* exponential amplitude decay, linearly ramped across each control period */
+    fixed16 amplitude;
+    fixed16 amplitude_decay;
+};
+
+void drum_voice_init(struct drum_voice* voice);
+
+void drum_voice_trigger(struct drum_voice* voice, enum drum_type type, fixed16 level);
+
+/* returns false when the voice is silent */
+bool drum_voice_process(struct drum_voice* voice, fixed16* block, size_t block_size);
+
+/* general MIDI percussion mapping, returns DRUM_TYPE_NUM for unmapped notes */
+enum drum_type drum_type_from_note(uint8_t note);
+
+#endif
@@ -0,0 +1,92 @@
+#include "effect_drift.h"
+
+#include <zephyr/kernel.h>
+#include <math.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "lfsr.h"
+#include "pitch_table.h"
+#include "control_rate.h"
+
+/* the prototype filters at 0.1 of nyquist with 32 interpolated values per point */
+#define _PROTOTYPE_SEGMENT 32
+#define _PROTOTYPE_CUTOFF 0.1f
+
+#define _Q30(x) ((int32_t)((x) * (1 << 30)))
+
+/* fractional bits kept in the filter output state. With the cutoff far below the control rate the
+ * DC gain of the feedback path is large, and truncating to whole samples would bias the output */
+#define _STATE_FRACTION_BITS 14
+
+static inline int32_t _random_point(struct effect_drift* drift);
+
+void effect_drift_init(struct effect_drift* drift, uint32_t seed)
+{
+    __ASSERT_NO_MSG(drift != NULL);
+
+    *drift = (struct effect_drift) {
+        .noise = seed != 0 ? seed : LFSR_SEED,
+    };
+
+    drift->point_next = _random_point(drift);
+
+    effect_drift_set_rate(drift, 2.0f);
+}
+
+void effect_drift_set_rate(struct effect_drift* drift, float points_per_second)
+{
+    __ASSERT_NO_MSG(drift != NULL);
+    __ASSERT(points_per_second > 0, "drift rate must be positive");
+
+    const float control_rate_hz = (float)pitch_table_sample_rate_hz / CONTROL_RATE_SAMPLES;
+
+    drift->segment = MAX((uint32_t)(control_rate_hz / points_per_second), 1);
+    drift->position = 0;
+
+    /* keeps the cutoff relative to the point rate as in the prototype, bilinear transform.
+     * Double precision as the poles are very close to 1 for slow rates */
+    const double cutoff = MIN(_PROTOTYPE_CUTOFF * _PROTOTYPE_SEGMENT / drift->segment, 0.9);
+    const double k = tan(M_PI * cutoff / 2);
+    const double norm = 1 / (1 + M_SQRT2 * k + k * k);
+
+    drift->b0 = _Q30(k * k * norm);
+    drift->b1 = 2 * drift->b0;
+    drift->b2 = drift->b0;
+    drift->a1 = _Q30(2 * (k * k - 1) * norm);
+    drift->a2 = _Q30((1 - M_SQRT2 * k + k * k) * norm);
+}
+
+fixed16 effect_drift_next(struct effect_drift* drift)
+{
+    __ASSERT_NO_MSG(drift != NULL);
+
+    if (drift->position == drift->segment) {
+        drift->position = 0;
+        drift->point = drift->point_next;
+        drift->point_next = _random_point(drift);
+    }
+
+    /* linear interpolation towards the next point */
+    const int32_t x = drift->point + (drift->point_next - drift->point) * (int32_t)drift->position / (int32_t)drift->segment;
+    drift->position++;
+
+    const int64_t feedforward = (int64_t)drift->b0 * x + (int64_t)drift->b1 * drift->x1 + (int64_t)drift->b2 * drift->x2;
+    const int64_t feedback = (int64_t)drift->a1 * drift->y1 + (int64_t)drift->a2 * drift->y2;
+    const int64_t acc = feedforward * (1 << _STATE_FRACTION_BITS) - feedback;
+    const int32_t y = (acc + (1 << 29)) >> 30;
+
+    drift->x2 = drift->x1;
+    drift->x1 = x;
+    drift->y2 = drift->y1;
+    drift->y1 = y;
+
+    return saturate16(y >> _STATE_FRACTION_BITS);
+}
+
+/* random integer in [-32, 32), cubed into the 16-bit range. Favours small values with rare large excursions */
+static inline int32_t _random_point(struct effect_drift* drift)
+{
+    const int32_t r = (int32_t)(lfsr_next(&drift->noise) >> 26) - 32;
+    return r * r * r;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file effect_drift.h
+ * @author Rein Gundersen Bentdal
+ * @brief Smooth random modulation source for analog style drift, from the prototype in scripts/drift.py.
+ *  Cubed random points are linearly interpolated and smoothed by a 2nd order Butterworth lowpass,
+ *  all evaluated at control rate
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _EFFECT_DRIFT_H_
+#define _EFFECT_DRIFT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "integer_math.h"
+
+struct effect_drift {
+    uint32_t noise;
+
+    /* linear interpolation between random points, position counts control periods */
+    int32_t point;
+    int32_t point_next;
+    uint32_t segment;
+    uint32_t position;
+
+    /* biquad in direct form 1, coefficients in Q30 and output state with extra fractional bits */
+    int32_t b0, b1, b2, a1, a2;
+    int32_t x1, x2, y1, y2;
+};
+
+/* instances with different seeds drift independently */
+void effect_drift_init(struct effect_drift* drift, uint32_t seed);
+
+/* number of random points per second, the lowpass cutoff follows */
+void effect_drift_set_rate(struct effect_drift* drift, float points_per_second);
+
+/* control rate interface, returns the next value in the range [-1, 1] */
+fixed16 effect_drift_next(struct effect_drift* drift);
+
+#endif
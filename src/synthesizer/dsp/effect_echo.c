@@ -6,7 +6,7 @@
 #include "dsp_instructions.h"
 #include "integer_math.h"
 
-void effect_echo_init(struct effect_echo* this, fixed16* buffer, size_t buffer_size) {
+void effect_echo_init(struct effect_echo* this, stereo16* buffer, size_t buffer_size) {
     __ASSERT_NO_MSG(this != NULL);
 
     /* initialize buffer to only zeros */
@@ -18,23 +18,33 @@ void effect_echo_init(struct effect_echo* this, fixed16* buffer, size_t buffer_s
         .head_index = 0,
         .tail_index = 0,
         .feedback_gain = FLOAT_TO_FIXED16(0.5),
+        .feedback_gain_target = FLOAT_TO_FIXED16(0.5),
     };
 }
 
-bool effect_echo_process(struct effect_echo* this, fixed16* block, size_t block_size) {
+bool effect_echo_process(struct effect_echo* this, stereo16* block, size_t block_size) {
     __ASSERT_NO_MSG(this != NULL);
     __ASSERT_NO_MSG(block != NULL);
 
     /* if no feedback, the module will have no effect on the signal */
-    if (this->feedback_gain == 0) {
+    if (this->feedback_gain == 0 && this->feedback_gain_target == 0) {
         return true;
     }
 
+    /* gain in upper 16 bit, lower 16 bit accumulates the fractional ramp */
+    int32_t feedback_gain = (int32_t)this->feedback_gain << 16;
+    const int32_t feedback_gain_ramp = (((int32_t)this->feedback_gain_target - this->feedback_gain) << 16) / (int32_t)block_size;
+
     for (int i = 0; i < block_size; i++) {
 
-        const fixed16 feedback_sample = FIXED_MULTIPLY(this->buffer[this->tail_index], this->feedback_gain);
+        /* left of the delayed sample is fed back to the right channel and right to the left */
+        const stereo16 delayed = this->buffer[this->tail_index];
+        const int32_t feedback_right = multiply_16bx16b(delayed, feedback_gain >> 16);
+        const int32_t feedback_left = multiply_16tx16b(delayed, feedback_gain >> 16);
+        feedback_gain += feedback_gain_ramp;
 
-        const fixed16 output_sample = FIXED_ADD_SATURATE(block[i], feedback_sample);
+        const stereo16 feedback_sample = pack_16t_16t((uint32_t)feedback_right << 1, (uint32_t)feedback_left << 1);
+        const stereo16 output_sample = signed_add_16_and_16(block[i], feedback_sample);
 
         this->buffer[this->head_index] = output_sample;
 
@@ -52,6 +62,68 @@ bool effect_echo_process(struct effect_echo* this, fixed16* block, size_t block_
         }
     }
 
+    this->feedback_gain = this->feedback_gain_target;
+
+    return true;
+}
+
+void effect_echo_init_q31(struct effect_echo* this, struct stereo32* buffer, size_t buffer_size) {
+    __ASSERT_NO_MSG(this != NULL);
+
+    memset(buffer, 0, buffer_size*sizeof(buffer[0]));
+
+    *this = (struct effect_echo){
+        .buffer_q31 = buffer,
+        .buffer_size = buffer_size,
+        .head_index = 0,
+        .tail_index = 0,
+        .feedback_gain = FLOAT_TO_FIXED16(0.5),
+        .feedback_gain_target = FLOAT_TO_FIXED16(0.5),
+    };
+}
+
+bool effect_echo_process_q31(struct effect_echo* this, struct stereo32* block, size_t block_size) {
+    __ASSERT_NO_MSG(this != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (this->feedback_gain == 0 && this->feedback_gain_target == 0) {
+        return true;
+    }
+
+    /* the gain with its fractional ramp is used as a Q31 value */
+    int32_t feedback_gain = (int32_t)this->feedback_gain << 16;
+    const int32_t feedback_gain_ramp = (((int32_t)this->feedback_gain_target - this->feedback_gain) << 16) / (int32_t)block_size;
+
+    for (int i = 0; i < block_size; i++) {
+
+        /* accumulated at half scale to leave room for the sum, then doubled with saturation */
+        const struct stereo32 delayed = this->buffer_q31[this->tail_index];
+        const int32_t left = multiply_accumulate_32x32_rshift32_rounded(block[i].left >> 1, delayed.right, feedback_gain);
+        const int32_t right = multiply_accumulate_32x32_rshift32_rounded(block[i].right >> 1, delayed.left, feedback_gain);
+        feedback_gain += feedback_gain_ramp;
+
+        const struct stereo32 output_sample = {
+            .left = add_32_saturate(left, left),
+            .right = add_32_saturate(right, right),
+        };
+
+        this->buffer_q31[this->head_index] = output_sample;
+
+        block[i] = output_sample;
+
+        this->tail_index++;
+        if (this->tail_index == this->buffer_size) {
+            this->tail_index = 0;
+        }
+
+        this->head_index++;
+        if (this->head_index == this->buffer_size) {
+            this->head_index = 0;
+        }
+    }
+
+    this->feedback_gain = this->feedback_gain_target;
+
     return true;
 }
 
@@ -73,4 +145,11 @@ void effect_echo_set_feedback(struct effect_echo* this, fixed16 magnitute) {
     __ASSERT_NO_MSG(this != NULL);
 
     this->feedback_gain = magnitute;
+    this->feedback_gain_target = magnitute;
+}
+
+void effect_echo_set_feedback_target(struct effect_echo* this, fixed16 magnitute) {
+    __ASSERT_NO_MSG(this != NULL);
+
+    this->feedback_gain_target = magnitute;
 }
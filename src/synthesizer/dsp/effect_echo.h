@@ -1,7 +1,7 @@
 /**
  * @file effect_echo.h
  * @author Rein Gundersen Bentdal
- * @brief Audio echo/delay effect
+ * @brief Stereo ping-pong echo/delay effect on one interleaved ring buffer
  * @date 2023-01-24
  * 
  * Copyright (c) 2023 Nordic Semiconductor ASA
@@ -16,22 +16,38 @@
 #include <stdbool.h>
 
 #include "integer_math.h"
+#include "stereo.h"
 
+/* each repeat swaps the channels of the delayed signal, a sound panned to one side bounces across */
 struct effect_echo {
-    fixed16* buffer;
+    /* packed or Q31 frames, depending on which init was used */
+    union {
+        stereo16* buffer;
+        struct stereo32* buffer_q31;
+    };
     size_t buffer_size;
     uint32_t head_index;
     uint32_t tail_index;
 
     fixed16 feedback_gain;
+
+    /* feedback_gain is linearly ramped towards this value across the next processed block */
+    fixed16 feedback_gain_target;
 };
 
-void effect_echo_init(struct effect_echo*, fixed16* buffer, size_t buffer_size);
+void effect_echo_init(struct effect_echo*, stereo16* buffer, size_t buffer_size);
+
+bool effect_echo_process(struct effect_echo*, stereo16* block, size_t block_size);
 
-bool effect_echo_process(struct effect_echo*, fixed16* block, size_t block_size);
+/* Q31 variant, feedback is accumulated without truncation to 16 bits on each repeat */
+void effect_echo_init_q31(struct effect_echo*, struct stereo32* buffer, size_t buffer_size);
+
+bool effect_echo_process_q31(struct effect_echo*, struct stereo32* block, size_t block_size);
 
 void effect_echo_set_delay(struct effect_echo*, uint32_t delay_ms);
 
 void effect_echo_set_feedback(struct effect_echo*, fixed16 magnitute);
 
+void effect_echo_set_feedback_target(struct effect_echo*, fixed16 magnitute);
+
 #endif
\ No newline at end of file
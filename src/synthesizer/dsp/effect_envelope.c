@@ -12,6 +12,7 @@ LOG_MODULE_DECLARE(dsp, CONFIG_LOG_DSP_LEVEL);
 /* calculates the envelope magnitude to apply at a spesific position */
 static int16_t _calculate_envelope_magnitude(struct effect_envelope *this, float position);
 static inline void _set_envelope_state(struct effect_envelope *this, enum envelope_state state);
+static inline bool _envelope_process(struct effect_envelope *this, fixed16 *block, size_t block_size, const size_t channels) __attribute__((always_inline));
 
 void effect_envelope_init(struct effect_envelope *this)
 {
@@ -138,6 +139,18 @@ bool effect_envelope_is_active(struct effect_envelope *this)
 }
 
 bool effect_envelope_process(struct effect_envelope *this, fixed16 *block, size_t block_size)
+{
+    return _envelope_process(this, block, block_size, 1);
+}
+
+bool effect_envelope_process_stereo(struct effect_envelope *this, stereo16 *block, size_t block_size)
+{
+    /* the same magnitude for both samples of a frame */
+    return _envelope_process(this, (fixed16 *)block, block_size, 2);
+}
+
+/* block holds block_size frames of interleaved channels, the constant channel count is unrolled */
+static inline bool _envelope_process(struct effect_envelope *this, fixed16 *block, size_t block_size, const size_t channels)
 {
     __ASSERT_NO_MSG(this != NULL);
 
@@ -185,9 +198,12 @@ bool effect_envelope_process(struct effect_envelope *this, fixed16 *block, size_
             const int32_t start_scale = start_magnitude * (0x10000 - scale);
             const int32_t magnitude = (start_scale + end_scale) >> 16;
 
-            int32_t sample_L = ((int16_t*)block)[i];
-            sample_L = (sample_L * magnitude) >> 15;
-            block[i] = sample_L;
+            for (size_t c = 0; c < channels; c++)
+            {
+                int32_t sample = block[i * channels + c];
+                sample = (sample * magnitude) >> 15;
+                block[i * channels + c] = sample;
+            }
         }
         this->phase_accumulator = accumulator_upper;
         this->magnitude_next = end_magnitude;
@@ -206,9 +222,12 @@ bool effect_envelope_process(struct effect_envelope *this, fixed16 *block, size_
             const int32_t start_scale = start * (0x10000 - scale);
             const int32_t magnitude = (start_scale + end_scale) >> 16;
 
-            int32_t sample_L = ((int16_t*)block)[i];
-            sample_L = (sample_L * magnitude) >> 15;
-            block[i] = sample_L;
+            for (size_t c = 0; c < channels; c++)
+            {
+                int32_t sample = block[i * channels + c];
+                sample = (sample * magnitude) >> 15;
+                block[i * channels + c] = sample;
+            }
         }
 
         if (end > FADE_OUT_THRESHOLD)
@@ -228,9 +247,12 @@ bool effect_envelope_process(struct effect_envelope *this, fixed16 *block, size_
         const int32_t magnitude = this->magnitude_next;
         for (int i = 0; i < block_size; i++)
         {
-            int32_t sample_L = ((int16_t*)block)[i];
-            sample_L = (sample_L * magnitude) >> 15;
-            block[i] = sample_L;
+            for (size_t c = 0; c < channels; c++)
+            {
+                int32_t sample = block[i * channels + c];
+                sample = (sample * magnitude) >> 15;
+                block[i * channels + c] = sample;
+            }
         }
         break;
     }
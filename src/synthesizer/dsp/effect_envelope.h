@@ -16,6 +16,7 @@
 #include <stdbool.h>
 
 #include "integer_math.h"
+#include "stereo.h"
 
 /* the fade out magnitude where the audio is interpreted as silent */
 #define FADE_OUT_THRESHOLD 1
@@ -55,6 +56,9 @@ struct effect_envelope {
 void effect_envelope_init(struct effect_envelope* this);
 bool effect_envelope_process(struct effect_envelope* this, fixed16* block, size_t block_size);
 
+/* as effect_envelope_process, for voices rendered in stereo */
+bool effect_envelope_process_stereo(struct effect_envelope* this, stereo16* block, size_t block_size);
+
 void effect_envelope_start(struct effect_envelope* this);
 void effect_envelope_end(struct effect_envelope* this);
 
@@ -28,12 +28,11 @@ void effect_modulation_set_freq(struct effect_modulation *mod, float freq)
 	__ASSERT_NO_MSG(mod != NULL);
 	__ASSERT(freq >= 0 && freq < CONFIG_AUDIO_SAMPLE_RATE_HZ / 2, "effect modulation frequency out of range");
 
-	mod->phase_increment = (freq / CONFIG_AUDIO_SAMPLE_RATE_HZ / 2) * UINT32_MAX;
+	mod->phase_increment = (freq / CONFIG_AUDIO_SAMPLE_RATE_HZ) * UINT32_MAX;
 }
 
 bool effect_modulation_process(struct effect_modulation *mod, fixed16* block, size_t block_size)
 {
-	BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2, "modulation only support 16-bit");
 	__ASSERT_NO_MSG(mod != NULL);
 	__ASSERT_NO_MSG(mod != NULL);
 
@@ -43,12 +42,12 @@ bool effect_modulation_process(struct effect_modulation *mod, fixed16* block, si
 
 	for (uint32_t i = 0; i < block_size; i++)
 	{
-		/* upper 8 bit as 256-value sample index */
-		uint32_t wave_index = mod->phase_accumulate >> 24;
+		/* upper bits as sample index */
+		uint32_t wave_index = SINE_INDEX(mod->phase_accumulate);
 
 		/* interpolate between the two samples for better audio quality */
-		const uint16_t interpolate_pos = (mod->phase_accumulate >> 8) & UINT16_MAX; // 16 bit scale value
-		const fixed16 modulation_sample = FIXED_INTERPOLATE_AND_SCALE(sinus_samples[wave_index], sinus_samples[wave_index+1], interpolate_pos, mod->magnitude);
+		const uint16_t interpolate_pos = SINE_INTERPOLATE_POS(mod->phase_accumulate); // 16 bit scale value
+		const fixed16 modulation_sample = SINE_INTERPOLATE_AND_SCALE(sinus_samples[wave_index], sinus_samples[wave_index+1], interpolate_pos, mod->magnitude);
 
         /* multiply modulation with waveform */
 		block[i] = FIXED_MULTIPLY(block[i], modulation_sample);
@@ -58,4 +57,16 @@ bool effect_modulation_process(struct effect_modulation *mod, fixed16* block, si
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+fixed16 effect_modulation_next(struct effect_modulation *mod, size_t samples)
+{
+	__ASSERT_NO_MSG(mod != NULL);
+
+	const fixed16 modulation_sample = sine_sample(mod->phase_accumulate);
+
+	/* skip the phase forward to the next control period */
+	mod->phase_accumulate += mod->phase_increment * samples;
+
+	return UFIXED_MULTIPLY(modulation_sample, mod->magnitude);
+}
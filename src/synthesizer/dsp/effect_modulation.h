@@ -36,6 +36,9 @@ struct effect_modulation
 void effect_modulation_init(struct effect_modulation* mod);
 bool effect_modulation_process(struct effect_modulation* mod, fixed16* block, size_t block_size);
 
+/* control rate interface, returns the current LFO value and advances the phase by the given number of samples */
+fixed16 effect_modulation_next(struct effect_modulation* mod, size_t samples);
+
 /* config */
 void effect_modulation_set_amplitude(struct effect_modulation* mod, ufixed16 magnitude);
 void effect_modulation_set_freq(struct effect_modulation* mod, float freq);
\ No newline at end of file
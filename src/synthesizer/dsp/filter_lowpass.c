@@ -0,0 +1,80 @@
+#include "filter_lowpass.h"
+
+#include <zephyr/kernel.h>
+
+#include "integer_math.h"
+
+void filter_lowpass_init(struct filter_lowpass* this) {
+    __ASSERT_NO_MSG(this != NULL);
+
+    *this = (struct filter_lowpass) {
+        .state = 0,
+        .state_right = 0,
+        .cutoff = INT16_MAX,
+        .cutoff_target = INT16_MAX,
+    };
+}
+
+void filter_lowpass_set_cutoff(struct filter_lowpass* this, fixed16 cutoff) {
+    __ASSERT_NO_MSG(this != NULL);
+    __ASSERT(cutoff >= 0, "lowpass cutoff out of range");
+
+    this->cutoff = cutoff;
+    this->cutoff_target = cutoff;
+}
+
+void filter_lowpass_set_cutoff_target(struct filter_lowpass* this, fixed16 cutoff) {
+    __ASSERT_NO_MSG(this != NULL);
+    __ASSERT(cutoff >= 0, "lowpass cutoff out of range");
+
+    this->cutoff_target = cutoff;
+}
+
+bool filter_lowpass_process(struct filter_lowpass* this, fixed16* block, size_t block_size) {
+    __ASSERT_NO_MSG(this != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    /* cutoff in upper 16 bit, lower 16 bit accumulates the fractional ramp */
+    int32_t cutoff = (int32_t)this->cutoff << 16;
+    const int32_t cutoff_ramp = (((int32_t)this->cutoff_target - this->cutoff) << 16) / (int32_t)block_size;
+
+    int32_t state = this->state;
+
+    for (int i = 0; i < block_size; i++) {
+        /* y[n] = y[n-1] + a*(x[n] - y[n-1]) */
+        state += ((cutoff >> 16) * (block[i] - state)) >> 15;
+        block[i] = state;
+
+        cutoff += cutoff_ramp;
+    }
+
+    this->state = state;
+    this->cutoff = this->cutoff_target;
+
+    return true;
+}
+
+bool filter_lowpass_process_stereo(struct filter_lowpass* this, stereo16* block, size_t block_size) {
+    __ASSERT_NO_MSG(this != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    int32_t cutoff = (int32_t)this->cutoff << 16;
+    const int32_t cutoff_ramp = (((int32_t)this->cutoff_target - this->cutoff) << 16) / (int32_t)block_size;
+
+    int32_t state_left = this->state;
+    int32_t state_right = this->state_right;
+
+    for (int i = 0; i < block_size; i++) {
+        state_left += ((cutoff >> 16) * (STEREO_LEFT(block[i]) - state_left)) >> 15;
+        state_right += ((cutoff >> 16) * (STEREO_RIGHT(block[i]) - state_right)) >> 15;
+        block[i] = stereo_pack(state_left, state_right);
+
+        cutoff += cutoff_ramp;
+    }
+
+    this->state = state_left;
+    this->state_right = state_right;
+    this->cutoff = this->cutoff_target;
+
+    return true;
+}
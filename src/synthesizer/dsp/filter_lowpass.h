@@ -0,0 +1,46 @@
+/**
+ * @file filter_lowpass.h
+ * @author Rein Gundersen Bentdal
+ * @brief One-pole lowpass filter with a cutoff which may be ramped at control rate
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _FILTER_LOWPASS_H_
+#define _FILTER_LOWPASS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+#include "stereo.h"
+
+struct filter_lowpass {
+    int32_t state;
+
+    /* second channel, only used by stereo processing */
+    int32_t state_right;
+
+    /* normalized one-pole coefficient, 1 passes the signal unfiltered */
+    fixed16 cutoff;
+    fixed16 cutoff_target;
+};
+
+void filter_lowpass_init(struct filter_lowpass*);
+
+/* sets the cutoff immediately */
+void filter_lowpass_set_cutoff(struct filter_lowpass*, fixed16 cutoff);
+
+/* cutoff is linearly ramped towards target across the next processed block */
+void filter_lowpass_set_cutoff_target(struct filter_lowpass*, fixed16 cutoff);
+
+bool filter_lowpass_process(struct filter_lowpass*, fixed16* block, size_t block_size);
+
+/* both channels filtered with the same cutoff */
+bool filter_lowpass_process_stereo(struct filter_lowpass*, stereo16* block, size_t block_size);
+
+#endif
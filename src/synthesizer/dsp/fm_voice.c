@@ -0,0 +1,252 @@
+#include "fm_voice.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "waveforms.h"
+#include "control_rate.h"
+
+#define SAMPLES_PER_MSEC (CONFIG_AUDIO_SAMPLE_RATE_HZ / 1000.f)
+#define CONTROL_PERIODS_PER_MSEC (SAMPLES_PER_MSEC / CONTROL_RATE_SAMPLES)
+
+/* ratio given in Q8.8 */
+#define _RATIO_FRACTION_BITS 8
+
+/* phase offset from a modulator sample scaled by its index */
+#define _PHASE_MODULATION(sample, level) ((uint32_t)(int32_t)FIXED_MULTIPLY(sample, level) << FM_PHASE_MODULATION_SHIFT)
+
+static inline fixed16 _envelope_next(struct fm_envelope* envelope);
+static void _kernel_stack_2(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size);
+static void _kernel_stack_3(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size);
+static void _kernel_stack_4(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size);
+static void _kernel_pairs_4(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size);
+
+void fm_voice_init(struct fm_voice* voice, uint8_t operator_count, enum fm_algorithm algorithm)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT(operator_count >= 2 && operator_count <= FM_OPERATORS_MAX, "fm voice supports 2 to 4 operators");
+    __ASSERT(algorithm != FM_ALGORITHM_PAIRS || operator_count == 4, "paired algorithm requires 4 operators");
+
+    *voice = (struct fm_voice) {
+        .operator_count = operator_count,
+        .algorithm = algorithm,
+        .magnitude = FLOAT_TO_FIXED16(1.0),
+    };
+
+    for (int i = 0; i < FM_OPERATORS_MAX; i++) {
+        fm_voice_set_operator(voice, i, 1.0f, FLOAT_TO_FIXED16(i == 0 ? 1.0f : 0.0f));
+        fm_voice_set_operator_envelope(voice, i, 0.0f, 0.0f, FLOAT_TO_FIXED16(1.0f));
+    }
+}
+
+void fm_voice_start(struct fm_voice* voice)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    for (int i = 0; i < voice->operator_count; i++) {
+        struct fm_operator* op = &voice->operators[i];
+
+        op->phase_accumulate = 0;
+        op->envelope.level = 0;
+        op->envelope.attack = true;
+    }
+}
+
+void fm_voice_set_amplitude(struct fm_voice* voice, fixed16 magnitude)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    voice->magnitude = magnitude;
+}
+
+void fm_voice_set_phase_increment(struct fm_voice* voice, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    for (int i = 0; i < voice->operator_count; i++) {
+        struct fm_operator* op = &voice->operators[i];
+        op->phase_increment = ((uint64_t)phase_increment * op->ratio) >> _RATIO_FRACTION_BITS;
+    }
+}
+
+void fm_voice_set_operator(struct fm_voice* voice, int op, float ratio, fixed16 index)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT(op >= 0 && op < FM_OPERATORS_MAX, "operator out of range");
+    __ASSERT(ratio > 0.0f && ratio < 256.0f, "operator ratio out of range");
+
+    voice->operators[op].ratio = (uint16_t)(ratio * (1 << _RATIO_FRACTION_BITS) + 0.5f);
+    voice->operators[op].index = index;
+}
+
+void fm_voice_set_operator_envelope(struct fm_voice* voice, int op, float attack_ms, float decay_ms, fixed16 sustain)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT(op >= 0 && op < FM_OPERATORS_MAX, "operator out of range");
+    __ASSERT(sustain >= 0, "sustain level must be positive");
+
+    struct fm_envelope* envelope = &voice->operators[op].envelope;
+
+    /* linear attack */
+    const float attack_periods = attack_ms * CONTROL_PERIODS_PER_MSEC;
+    envelope->attack_step = attack_periods < 1.0f ? INT16_MAX : (fixed16)(INT16_MAX / attack_periods + 1.0f);
+
+    /* exponential decay, reaching ~37% of the distance to sustain after decay_ms */
+    const float decay_periods = decay_ms * CONTROL_PERIODS_PER_MSEC;
+    envelope->decay_coefficient = decay_periods < 1.0f ? INT16_MAX : (fixed16)(INT16_MAX / decay_periods + 1.0f);
+
+    envelope->sustain = sustain;
+}
+
+bool fm_voice_process(struct fm_voice* voice, fixed16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (voice->magnitude == 0) {
+        return false;
+    }
+
+    /* operator levels are evaluated once per call, which is expected to be one control period */
+    fixed16 levels[FM_OPERATORS_MAX];
+    for (int i = 0; i < voice->operator_count; i++) {
+        struct fm_operator* op = &voice->operators[i];
+        levels[i] = FIXED_MULTIPLY(op->index, _envelope_next(&op->envelope));
+    }
+
+    /* carrier levels include the voice amplitude */
+    levels[0] = FIXED_MULTIPLY(levels[0], voice->magnitude);
+
+    switch (voice->algorithm) {
+        case FM_ALGORITHM_STACK:
+            switch (voice->operator_count) {
+                case 2: _kernel_stack_2(voice->operators, levels, block, block_size); break;
+                case 3: _kernel_stack_3(voice->operators, levels, block, block_size); break;
+                case 4: _kernel_stack_4(voice->operators, levels, block, block_size); break;
+            }
+            break;
+        case FM_ALGORITHM_PAIRS:
+            levels[2] = FIXED_MULTIPLY(levels[2], voice->magnitude);
+            _kernel_pairs_4(voice->operators, levels, block, block_size);
+            break;
+    }
+
+    return true;
+}
+
+static inline fixed16 _envelope_next(struct fm_envelope* envelope)
+{
+    int32_t level = envelope->level;
+
+    if (envelope->attack) {
+        level += envelope->attack_step;
+        if (level >= INT16_MAX) {
+            level = INT16_MAX;
+            envelope->attack = false;
+        }
+    } else {
+        level += ((envelope->sustain - level) * envelope->decay_coefficient) >> 15;
+    }
+
+    envelope->level = level;
+    return level;
+}
+
+/* all operators of an algorithm are advanced in the same loop, keeping phases in registers
+ * and writing only the carrier output */
+
+static void _kernel_stack_2(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size)
+{
+    uint32_t phase_0 = ops[0].phase_accumulate, phase_1 = ops[1].phase_accumulate;
+    const uint32_t increment_0 = ops[0].phase_increment, increment_1 = ops[1].phase_increment;
+    const fixed16 level_0 = levels[0], level_1 = levels[1];
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        const fixed16 s1 = sine_sample(phase_1);
+        const fixed16 s0 = sine_sample(phase_0 + _PHASE_MODULATION(s1, level_1));
+        block[i] = FIXED_MULTIPLY(s0, level_0);
+
+        phase_0 += increment_0;
+        phase_1 += increment_1;
+    }
+
+    ops[0].phase_accumulate = phase_0;
+    ops[1].phase_accumulate = phase_1;
+}
+
+static void _kernel_stack_3(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size)
+{
+    uint32_t phase_0 = ops[0].phase_accumulate, phase_1 = ops[1].phase_accumulate, phase_2 = ops[2].phase_accumulate;
+    const uint32_t increment_0 = ops[0].phase_increment, increment_1 = ops[1].phase_increment, increment_2 = ops[2].phase_increment;
+    const fixed16 level_0 = levels[0], level_1 = levels[1], level_2 = levels[2];
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        const fixed16 s2 = sine_sample(phase_2);
+        const fixed16 s1 = sine_sample(phase_1 + _PHASE_MODULATION(s2, level_2));
+        const fixed16 s0 = sine_sample(phase_0 + _PHASE_MODULATION(s1, level_1));
+        block[i] = FIXED_MULTIPLY(s0, level_0);
+
+        phase_0 += increment_0;
+        phase_1 += increment_1;
+        phase_2 += increment_2;
+    }
+
+    ops[0].phase_accumulate = phase_0;
+    ops[1].phase_accumulate = phase_1;
+    ops[2].phase_accumulate = phase_2;
+}
+
+static void _kernel_stack_4(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size)
+{
+    uint32_t phase_0 = ops[0].phase_accumulate, phase_1 = ops[1].phase_accumulate;
+    uint32_t phase_2 = ops[2].phase_accumulate, phase_3 = ops[3].phase_accumulate;
+    const uint32_t increment_0 = ops[0].phase_increment, increment_1 = ops[1].phase_increment;
+    const uint32_t increment_2 = ops[2].phase_increment, increment_3 = ops[3].phase_increment;
+    const fixed16 level_0 = levels[0], level_1 = levels[1], level_2 = levels[2], level_3 = levels[3];
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        const fixed16 s3 = sine_sample(phase_3);
+        const fixed16 s2 = sine_sample(phase_2 + _PHASE_MODULATION(s3, level_3));
+        const fixed16 s1 = sine_sample(phase_1 + _PHASE_MODULATION(s2, level_2));
+        const fixed16 s0 = sine_sample(phase_0 + _PHASE_MODULATION(s1, level_1));
+        block[i] = FIXED_MULTIPLY(s0, level_0);
+
+        phase_0 += increment_0;
+        phase_1 += increment_1;
+        phase_2 += increment_2;
+        phase_3 += increment_3;
+    }
+
+    ops[0].phase_accumulate = phase_0;
+    ops[1].phase_accumulate = phase_1;
+    ops[2].phase_accumulate = phase_2;
+    ops[3].phase_accumulate = phase_3;
+}
+
+static void _kernel_pairs_4(struct fm_operator* ops, const fixed16* levels, fixed16* block, size_t block_size)
+{
+    uint32_t phase_0 = ops[0].phase_accumulate, phase_1 = ops[1].phase_accumulate;
+    uint32_t phase_2 = ops[2].phase_accumulate, phase_3 = ops[3].phase_accumulate;
+    const uint32_t increment_0 = ops[0].phase_increment, increment_1 = ops[1].phase_increment;
+    const uint32_t increment_2 = ops[2].phase_increment, increment_3 = ops[3].phase_increment;
+    const fixed16 level_0 = levels[0], level_1 = levels[1], level_2 = levels[2], level_3 = levels[3];
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        const fixed16 s1 = sine_sample(phase_1);
+        const fixed16 s3 = sine_sample(phase_3);
+        const fixed16 s0 = sine_sample(phase_0 + _PHASE_MODULATION(s1, level_1));
+        const fixed16 s2 = sine_sample(phase_2 + _PHASE_MODULATION(s3, level_3));
+        block[i] = saturate16(FIXED_MULTIPLY(s0, level_0) + FIXED_MULTIPLY(s2, level_2));
+
+        phase_0 += increment_0;
+        phase_1 += increment_1;
+        phase_2 += increment_2;
+        phase_3 += increment_3;
+    }
+
+    ops[0].phase_accumulate = phase_0;
+    ops[1].phase_accumulate = phase_1;
+    ops[2].phase_accumulate = phase_2;
+    ops[3].phase_accumulate = phase_3;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file fm_voice.h
+ * @author Rein Gundersen Bentdal
+ * @brief 2-4 operator FM (phase modulation) voice built on the shared sine table
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _FM_VOICE_H_
+#define _FM_VOICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+
+#define FM_OPERATORS_MAX 4
+
+/* modulator output of 1 shifts the carrier phase by one full period */
+#define FM_PHASE_MODULATION_SHIFT 17
+
+/* operator 0 is always a carrier */
+enum fm_algorithm {
+    FM_ALGORITHM_STACK, /* N-1 -> ... -> 1 -> 0 */
+    FM_ALGORITHM_PAIRS, /* 1 -> 0 and 3 -> 2, with 0 and 2 as carriers. Requires 4 operators */
+};
+
+/* attack/decay/sustain envelope evaluated at control rate */
+struct fm_envelope {
+    fixed16 level;
+    bool attack;
+
+    fixed16 attack_step;
+    fixed16 decay_coefficient;
+    fixed16 sustain;
+};
+
+struct fm_operator {
+    uint32_t phase_accumulate;
+    uint32_t phase_increment;
+
+    /* frequency ratio to the voice pitch, Q8.8 */
+    uint16_t ratio;
+
+    /* modulation index for modulators, output level for carriers */
+    fixed16 index;
+
+    struct fm_envelope envelope;
+};
+
+struct fm_voice {
+    struct fm_operator operators[FM_OPERATORS_MAX];
+    uint8_t operator_count;
+    enum fm_algorithm algorithm;
+
+    fixed16 magnitude;
+};
+
+void fm_voice_init(struct fm_voice* voice, uint8_t operator_count, enum fm_algorithm algorithm);
+
+/* resets phases and operator envelopes */
+void fm_voice_start(struct fm_voice* voice);
+
+bool fm_voice_process(struct fm_voice* voice, fixed16* block, size_t block_size);
+
+/* config */
+void fm_voice_set_amplitude(struct fm_voice* voice, fixed16 magnitude);
+
+/* sets the increment of every operator from the voice increment and the operator ratio */
+void fm_voice_set_phase_increment(struct fm_voice* voice, uint32_t phase_increment);
+
+void fm_voice_set_operator(struct fm_voice* voice, int op, float ratio, fixed16 index);
+void fm_voice_set_operator_envelope(struct fm_voice* voice, int op, float attack_ms, float decay_ms, fixed16 sustain);
+
+#endif
@@ -0,0 +1,496 @@
+#include "graph.h"
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <string.h>
+
+#include "audio_process.h"
+#include "dsp_instructions.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(dsp, CONFIG_LOG_DSP_LEVEL);
+
+#define _NONE UINT8_MAX
+
+/* mixers take one step per input, other nodes one step */
+#define _STEPS_MAX (CONFIG_SYNTH_GRAPH_NODES * GRAPH_INPUTS_MAX)
+
+BUILD_ASSERT(CONFIG_SYNTH_GRAPH_NODES < _NONE, "node indices are stored in 8 bits");
+BUILD_ASSERT(CONFIG_SYNTH_GRAPH_BUFFERS <= 32, "free buffers are tracked in one word");
+
+/* processes a node, or adds one input of a mixer to its output */
+struct _step {
+    uint8_t node;
+    uint8_t input;
+};
+
+enum _visit_state {
+    _UNVISITED,
+    _VISITING,
+    _VISITED,
+};
+
+static struct graph_node _nodes[CONFIG_SYNTH_GRAPH_NODES];
+static uint8_t _output = _NONE;
+
+/* execution order, every node comes after its inputs */
+static struct _step _schedule[_STEPS_MAX];
+static size_t _schedule_size;
+
+static bool _changed = true;
+static int _status;
+static size_t _buffers_used;
+
+/* scratch blocks, mono nodes only use the first half */
+static stereo16 _buffers[CONFIG_SYNTH_GRAPH_BUFFERS][AUDIO_BLOCK_FRAMES];
+
+static int _visit(uint8_t index, uint8_t* state);
+static int _format(struct graph_node* node);
+static int _assign_buffers(void);
+static int _buffer_alloc(uint32_t* used);
+static inline void _buffer_release(uint32_t* used, const struct graph_node* source, size_t step);
+static inline bool _in_place(const struct graph_node* node);
+static inline bool _oscillator_process(struct graph_node* node, fixed16* block, size_t block_size);
+static void _mixer_process(struct graph_node* node, uint8_t input_index, stereo16* block, size_t block_size);
+static void _effect_process(struct graph_node* node, stereo16* block, size_t block_size);
+
+void graph_clear(void)
+{
+    memset(_nodes, 0, sizeof(_nodes));
+    _output = _NONE;
+    _changed = true;
+}
+
+int graph_node_add(enum graph_node_type type)
+{
+    __ASSERT(type < GRAPH_NODE_TYPE_NUM, "graph node type out of range");
+
+    for (int i = 0; i < CONFIG_SYNTH_GRAPH_NODES; i++) {
+        struct graph_node* node = &_nodes[i];
+        if (node->used) continue;
+
+        *node = (struct graph_node) {
+            .type = type,
+            .used = true,
+        };
+
+        switch (type) {
+            case GRAPH_NODE_OSCILLATOR:
+                osc_init(&node->oscillator);
+                node->waveform = GRAPH_WAVEFORM_SINE;
+                break;
+            case GRAPH_NODE_ENVELOPE:
+                effect_envelope_init(&node->envelope);
+                break;
+            case GRAPH_NODE_LOWPASS:
+                filter_lowpass_init(&node->lowpass);
+                break;
+            case GRAPH_NODE_MODULATION:
+                effect_modulation_init(&node->modulation);
+                break;
+            default:
+                break;
+        }
+
+        _changed = true;
+        return i;
+    }
+
+    return -ENOMEM;
+}
+
+void graph_node_remove(int node)
+{
+    __ASSERT(node >= 0 && node < CONFIG_SYNTH_GRAPH_NODES && _nodes[node].used, "graph node does not exist");
+
+    for (int i = 0; i < CONFIG_SYNTH_GRAPH_NODES; i++) {
+        if (!_nodes[i].used) continue;
+
+        /* all connections, the same source may be connected more than once */
+        for (int input = _nodes[i].input_count - 1; input >= 0; input--) {
+            if (_nodes[i].inputs[input] == node) {
+                graph_disconnect(node, i);
+            }
+        }
+    }
+
+    if (_output == node) {
+        _output = _NONE;
+    }
+
+    _nodes[node].used = false;
+    _changed = true;
+}
+
+struct graph_node* graph_node_get(int node)
+{
+    __ASSERT(node >= 0 && node < CONFIG_SYNTH_GRAPH_NODES && _nodes[node].used, "graph node does not exist");
+
+    return &_nodes[node];
+}
+
+int graph_connect(int source, int destination, stereo16 gains)
+{
+    __ASSERT(source >= 0 && source < CONFIG_SYNTH_GRAPH_NODES && _nodes[source].used, "graph node does not exist");
+    __ASSERT(destination >= 0 && destination < CONFIG_SYNTH_GRAPH_NODES && _nodes[destination].used, "graph node does not exist");
+
+    struct graph_node* node = &_nodes[destination];
+
+    const uint8_t inputs_max =
+        node->type == GRAPH_NODE_MIXER ? GRAPH_INPUTS_MAX :
+        node->type == GRAPH_NODE_OSCILLATOR ? 0 : 1;
+
+    if (node->input_count >= inputs_max) {
+        return -ENOSPC;
+    }
+
+    node->inputs[node->input_count] = source;
+    node->input_gains[node->input_count] = gains;
+    node->input_count++;
+
+    _changed = true;
+    return 0;
+}
+
+void graph_disconnect(int source, int destination)
+{
+    __ASSERT(destination >= 0 && destination < CONFIG_SYNTH_GRAPH_NODES && _nodes[destination].used, "graph node does not exist");
+
+    struct graph_node* node = &_nodes[destination];
+
+    for (int i = 0; i < node->input_count; i++) {
+        if (node->inputs[i] != source) continue;
+
+        /* keeps the order of the remaining inputs */
+        node->input_count--;
+        memmove(&node->inputs[i], &node->inputs[i + 1], (node->input_count - i) * sizeof(node->inputs[0]));
+        memmove(&node->input_gains[i], &node->input_gains[i + 1], (node->input_count - i) * sizeof(node->input_gains[0]));
+
+        _changed = true;
+        return;
+    }
+}
+
+void graph_set_output(int node)
+{
+    __ASSERT(node >= 0 && node < CONFIG_SYNTH_GRAPH_NODES && _nodes[node].used, "graph node does not exist");
+
+    _output = node;
+    _changed = true;
+}
+
+int graph_update(void)
+{
+    if (!_changed) {
+        return _status;
+    }
+
+    _changed = false;
+    _schedule_size = 0;
+    _buffers_used = 0;
+    _status = 0;
+
+    if (_output != _NONE) {
+        uint8_t state[CONFIG_SYNTH_GRAPH_NODES] = {_UNVISITED};
+
+        _status = _visit(_output, state);
+
+        if (_status == 0 && !_nodes[_output].stereo) {
+            _status = -EINVAL;
+        }
+
+        if (_status == 0) {
+            _status = _assign_buffers();
+        }
+    }
+
+    if (_status != 0) {
+        LOG_WRN("graph not processed (%d)", _status);
+        _schedule_size = 0;
+    } else {
+        LOG_DBG("graph scheduled in %zu steps on %zu buffers", _schedule_size, _buffers_used);
+    }
+
+    return _status;
+}
+
+const stereo16* graph_process(size_t block_size)
+{
+    __ASSERT(block_size <= AUDIO_BLOCK_FRAMES, "block size larger than the graph buffers");
+
+    if (graph_update() != 0 || _schedule_size == 0) {
+        return NULL;
+    }
+
+    for (size_t step = 0; step < _schedule_size; step++) {
+        struct graph_node* node = &_nodes[_schedule[step].node];
+        stereo16* block = _buffers[node->buffer];
+
+        switch (node->type) {
+            case GRAPH_NODE_OSCILLATOR:
+                node->silent = !_oscillator_process(node, (fixed16*)block, block_size);
+                break;
+            case GRAPH_NODE_MIXER:
+                _mixer_process(node, _schedule[step].input, block, block_size);
+                break;
+            default:
+                _effect_process(node, block, block_size);
+                break;
+        }
+    }
+
+    const struct graph_node* output = &_nodes[_output];
+    return output->silent ? NULL : _buffers[output->buffer];
+}
+
+size_t graph_buffers_used(void)
+{
+    return _buffers_used;
+}
+
+/* depth first, appending each node to the schedule after its inputs. Mixers add each input as soon as
+ * it is ready, so only the sum is kept alive rather than all of the inputs */
+static int _visit(uint8_t index, uint8_t* state)
+{
+    if (state[index] == _VISITED) {
+        return 0;
+    }
+    if (state[index] == _VISITING) {
+        /* feedback is only supported inside modules, such as the echo */
+        return -EINVAL;
+    }
+
+    state[index] = _VISITING;
+
+    struct graph_node* node = &_nodes[index];
+    const bool mixer = node->type == GRAPH_NODE_MIXER;
+
+    for (int i = 0; i < node->input_count; i++) {
+        const int ret = _visit(node->inputs[i], state);
+        if (ret != 0) return ret;
+
+        if (mixer) {
+            _schedule[_schedule_size++] = (struct _step) {index, i};
+        }
+    }
+
+    state[index] = _VISITED;
+
+    const int ret = _format(node);
+    if (ret != 0) return ret;
+
+    /* a mixer without inputs still has a silent output */
+    if (!mixer || node->input_count == 0) {
+        _schedule[_schedule_size++] = (struct _step) {index, _NONE};
+    }
+
+    return 0;
+}
+
+/* channel format of the node output, given the formats of its inputs */
+static int _format(struct graph_node* node)
+{
+    if (node->type == GRAPH_NODE_OSCILLATOR) {
+        node->stereo = false;
+        return 0;
+    }
+
+    if (node->type == GRAPH_NODE_MIXER) {
+        node->stereo = true;
+        return 0;
+    }
+
+    /* effects process their single input in place */
+    if (node->input_count != 1) {
+        return -EINVAL;
+    }
+
+    const bool stereo = _nodes[node->inputs[0]].stereo;
+
+    switch (node->type) {
+        case GRAPH_NODE_ALLPASS:
+        case GRAPH_NODE_MODULATION:
+            if (stereo) return -EINVAL;
+            break;
+        case GRAPH_NODE_ECHO:
+            if (!stereo) return -EINVAL;
+            break;
+        default:
+            break;
+    }
+
+    node->stereo = stereo;
+    return 0;
+}
+
+/* linear scan over the schedule. A buffer is free again after the last step reading it, and nodes
+ * processing in place take over the buffer of an input which is not read afterwards */
+static int _assign_buffers(void)
+{
+    for (size_t step = 0; step < _schedule_size; step++) {
+        const struct _step* s = &_schedule[step];
+        struct graph_node* node = &_nodes[s->node];
+
+        node->last_use = step;
+
+        if (s->input != _NONE) {
+            _nodes[node->inputs[s->input]].last_use = step;
+        } else if (_in_place(node)) {
+            _nodes[node->inputs[0]].last_use = step;
+        }
+    }
+
+    /* the output is read after the graph has been processed */
+    _nodes[_output].last_use = UINT16_MAX;
+
+    uint32_t used = 0;
+
+    for (size_t step = 0; step < _schedule_size; step++) {
+        const struct _step* s = &_schedule[step];
+        struct graph_node* node = &_nodes[s->node];
+
+        /* later inputs of a mixer are added to the buffer taken at its first */
+        if (s->input != _NONE && s->input > 0) {
+            _buffer_release(&used, &_nodes[node->inputs[s->input]], step);
+            continue;
+        }
+
+        if (_in_place(node) && _nodes[node->inputs[0]].last_use == step) {
+            node->buffer = _nodes[node->inputs[0]].buffer;
+            node->copy_input = false;
+            continue;
+        }
+
+        const int buffer = _buffer_alloc(&used);
+        if (buffer < 0) return buffer;
+
+        node->buffer = buffer;
+        node->copy_input = _in_place(node);
+
+        /* released after the buffer of this node is taken, the input is read while it is written */
+        if (node->input_count > 0) {
+            _buffer_release(&used, &_nodes[node->inputs[s->input != _NONE ? s->input : 0]], step);
+        }
+    }
+
+    return 0;
+}
+
+static int _buffer_alloc(uint32_t* used)
+{
+    for (int i = 0; i < CONFIG_SYNTH_GRAPH_BUFFERS; i++) {
+        if (*used & BIT(i)) continue;
+
+        *used |= BIT(i);
+        _buffers_used = MAX(_buffers_used, (size_t)i + 1);
+        return i;
+    }
+
+    return -ENOMEM;
+}
+
+static inline void _buffer_release(uint32_t* used, const struct graph_node* source, size_t step)
+{
+    if (source->last_use == step) {
+        *used &= ~BIT(source->buffer);
+    }
+}
+
+static inline bool _in_place(const struct graph_node* node)
+{
+    return node->type != GRAPH_NODE_OSCILLATOR && node->type != GRAPH_NODE_MIXER;
+}
+
+static inline bool _oscillator_process(struct graph_node* node, fixed16* block, size_t block_size)
+{
+    switch (node->waveform) {
+        case GRAPH_WAVEFORM_SINE:
+            return osc_process_sine(&node->oscillator, block, block_size);
+        case GRAPH_WAVEFORM_TRIANGLE:
+            return osc_process_triangle(&node->oscillator, block, block_size);
+        case GRAPH_WAVEFORM_SAWTOOTH:
+            return osc_process_sawtooth(&node->oscillator, block, block_size);
+    }
+
+    return false;
+}
+
+static void _mixer_process(struct graph_node* node, uint8_t input_index, stereo16* block, size_t block_size)
+{
+    /* the first input starts a new sum */
+    if (input_index == 0 || input_index == _NONE) {
+        node->silent = true;
+    }
+
+    if (input_index == _NONE) {
+        return;
+    }
+
+    const struct graph_node* input = &_nodes[node->inputs[input_index]];
+    if (input->silent) {
+        return;
+    }
+
+    if (node->silent) {
+        memset(block, 0, block_size * sizeof(block[0]));
+        node->silent = false;
+    }
+
+    const stereo16* source = _buffers[input->buffer];
+    const stereo16 gains = node->input_gains[input_index];
+
+    if (!input->stereo) {
+        stereo_mix_panned(block, (const fixed16*)source, block_size, gains);
+    } else if (gains == GRAPH_GAINS_UNITY) {
+        stereo_mix(block, source, block_size);
+    } else {
+        for (size_t i = 0; i < block_size; i++) {
+            block[i] = signed_add_16_and_16(block[i], stereo_multiply(source[i], gains));
+        }
+    }
+}
+
+static void _effect_process(struct graph_node* node, stereo16* block, size_t block_size)
+{
+    const struct graph_node* input = &_nodes[node->inputs[0]];
+    const size_t block_bytes = block_size * (node->stereo ? sizeof(stereo16) : sizeof(fixed16));
+
+    if (input->silent) {
+        /* nothing to scale, the output stays silent */
+        if (node->type == GRAPH_NODE_ENVELOPE || node->type == GRAPH_NODE_MODULATION) {
+            node->silent = true;
+            return;
+        }
+
+        /* filters and delays keep sounding after their input */
+        memset(block, 0, block_bytes);
+    } else if (node->copy_input) {
+        memcpy(block, _buffers[input->buffer], block_bytes);
+    }
+
+    node->silent = false;
+
+    switch (node->type) {
+        case GRAPH_NODE_ENVELOPE:
+            node->silent = node->stereo
+                ? !effect_envelope_process_stereo(&node->envelope, block, block_size)
+                : !effect_envelope_process(&node->envelope, (fixed16*)block, block_size);
+            break;
+        case GRAPH_NODE_LOWPASS:
+            if (node->stereo) {
+                (void)filter_lowpass_process_stereo(&node->lowpass, block, block_size);
+            } else {
+                (void)filter_lowpass_process(&node->lowpass, (fixed16*)block, block_size);
+            }
+            break;
+        case GRAPH_NODE_ALLPASS:
+            (void)filter_allpass_process(&node->allpass, (fixed16*)block, block_size);
+            break;
+        case GRAPH_NODE_MODULATION:
+            (void)effect_modulation_process(&node->modulation, (fixed16*)block, block_size);
+            break;
+        case GRAPH_NODE_ECHO:
+            (void)effect_echo_process(&node->echo, block, block_size);
+            break;
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file graph.h
+ * @author Rein Gundersen Bentdal
+ * @brief Node graph of DSP modules connected at runtime. Nodes are taken from a static pool, the
+ *  execution order and the scratch buffers of the nodes are computed once each time the graph changes
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _GRAPH_H_
+#define _GRAPH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+#include "oscillator.h"
+#include "effect_envelope.h"
+#include "effect_modulation.h"
+#include "effect_echo.h"
+#include "filter_allpass.h"
+#include "filter_lowpass.h"
+#include "stereo.h"
+
+/* inputs of a mixer, other node types have at most one */
+#define GRAPH_INPUTS_MAX 4
+
+enum graph_node_type {
+    GRAPH_NODE_OSCILLATOR,  /* mono source */
+    GRAPH_NODE_ENVELOPE,    /* mono or stereo, silent while the envelope is */
+    GRAPH_NODE_LOWPASS,     /* mono or stereo */
+    GRAPH_NODE_ALLPASS,     /* mono */
+    GRAPH_NODE_MODULATION,  /* mono, amplitude modulation */
+    GRAPH_NODE_ECHO,        /* stereo */
+    GRAPH_NODE_MIXER,       /* mono inputs are panned, stereo inputs are scaled per channel. Output is stereo */
+    GRAPH_NODE_TYPE_NUM,
+};
+
+enum graph_waveform {
+    GRAPH_WAVEFORM_SINE,
+    GRAPH_WAVEFORM_TRIANGLE,
+    GRAPH_WAVEFORM_SAWTOOTH,
+};
+
+struct graph_node {
+    uint8_t type;
+    bool used;
+
+    uint8_t inputs[GRAPH_INPUTS_MAX];
+    uint8_t input_count;
+
+    /* packed gains of each mixer input, from stereo_pan_gains */
+    stereo16 input_gains[GRAPH_INPUTS_MAX];
+
+    /* set by the schedule. Nodes processing in place copy their input unless they are its last reader */
+    bool stereo;
+    bool copy_input;
+    uint8_t buffer;
+    uint16_t last_use;
+
+    /* set while processing, when the output block holds no audio */
+    bool silent;
+
+    /* module of the node. Echo and allpass are initialized with their delay memory by the owner */
+    union {
+        struct {
+            struct oscillator oscillator;
+            uint8_t waveform;
+        };
+        struct effect_envelope envelope;
+        struct filter_lowpass lowpass;
+        struct filter_allpass allpass;
+        struct effect_modulation modulation;
+        struct effect_echo echo;
+    };
+};
+
+/* removes all nodes */
+void graph_clear(void);
+
+/* returns the node index, or -ENOMEM if the pool is exhausted. The module is initialized with its defaults */
+int graph_node_add(enum graph_node_type type);
+
+/* also removes the connections from the node */
+void graph_node_remove(int node);
+
+/* for configuring the module of a node */
+struct graph_node* graph_node_get(int node);
+
+/* unity gain on both channels, for stereo mixer inputs */
+#define GRAPH_GAINS_UNITY (((stereo16)INT16_MAX << 16) | INT16_MAX)
+
+/* returns -ENOSPC if the destination has no free inputs. gains are only used by mixers */
+int graph_connect(int source, int destination, stereo16 gains);
+
+void graph_disconnect(int source, int destination);
+
+/* node whose output is returned by graph_process, only nodes it depends on are processed. The output must be stereo */
+void graph_set_output(int node);
+
+/* computes the schedule and scratch buffers if the graph has changed since last time.
+ * Returns -EINVAL for cycles or unsupported channel formats, and -ENOMEM if the scratch buffers are
+ * not enough. graph_process updates the graph itself, this is for checking a new graph up front */
+int graph_update(void);
+
+/* returns the stereo output block, or NULL if the output is silent or the graph is invalid.
+ * Not thread safe with changes to the graph, which should be made from the processing context */
+const stereo16* graph_process(size_t block_size);
+
+/* number of scratch buffers used by the current schedule, for diagnostics */
+size_t graph_buffers_used(void);
+
+#endif
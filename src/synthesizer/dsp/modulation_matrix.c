@@ -0,0 +1,36 @@
+#include "modulation_matrix.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+
+void modulation_matrix_init(struct modulation_matrix* this, const struct modulation_route* routes, size_t routes_size) {
+    __ASSERT_NO_MSG(this != NULL);
+    __ASSERT_NO_MSG(routes != NULL || routes_size == 0);
+
+    *this = (struct modulation_matrix) {
+        .routes = routes,
+        .routes_size = routes_size,
+    };
+
+    for (int i = 0; i < routes_size; i++) {
+        __ASSERT(routes[i].source < MODULATION_SOURCE_NUM, "modulation route source out of range");
+        __ASSERT(routes[i].destination < MODULATION_DESTINATION_NUM, "modulation route destination out of range");
+    }
+}
+
+void modulation_matrix_process(struct modulation_matrix* this) {
+    __ASSERT_NO_MSG(this != NULL);
+
+    int32_t sum[MODULATION_DESTINATION_NUM] = {0};
+
+    for (int i = 0; i < this->routes_size; i++) {
+        const struct modulation_route* route = &this->routes[i];
+        sum[route->destination] += FIXED_MULTIPLY(this->sources[route->source], route->depth);
+    }
+
+    for (int i = 0; i < MODULATION_DESTINATION_NUM; i++) {
+        this->destinations[i] = saturate16(sum[i]);
+    }
+}
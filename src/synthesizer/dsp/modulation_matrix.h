@@ -0,0 +1,68 @@
+/**
+ * @file modulation_matrix.h
+ * @author Rein Gundersen Bentdal
+ * @brief Static routing of control rate modulation sources to synthesizer parameters
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _MODULATION_MATRIX_H_
+#define _MODULATION_MATRIX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "integer_math.h"
+
+enum modulation_source {
+    MODULATION_SOURCE_LFO1,
+    MODULATION_SOURCE_LFO2,
+    MODULATION_SOURCE_DRIFT,
+    MODULATION_SOURCE_VELOCITY, /* unipolar, set at note on */
+    MODULATION_SOURCE_NUM,
+};
+
+/* destination values are bipolar offsets in the range [-1, 1], interpreted by the owner of the parameter */
+enum modulation_destination {
+    MODULATION_DESTINATION_AMPLITUDE,
+    MODULATION_DESTINATION_PITCH,
+    MODULATION_DESTINATION_FILTER_CUTOFF,
+    MODULATION_DESTINATION_ECHO_FEEDBACK,
+    MODULATION_DESTINATION_WAVETABLE_MORPH,
+    MODULATION_DESTINATION_NUM,
+};
+
+struct modulation_route {
+    uint8_t source;
+    uint8_t destination;
+    fixed16 depth;
+};
+
+struct modulation_matrix {
+    const struct modulation_route* routes;
+    size_t routes_size;
+
+    fixed16 sources[MODULATION_SOURCE_NUM];
+    fixed16 destinations[MODULATION_DESTINATION_NUM];
+};
+
+/* routes are not copied, and should typically be a static const table shared between instances */
+void modulation_matrix_init(struct modulation_matrix*, const struct modulation_route* routes, size_t routes_size);
+
+/* sums all routes into their destinations. Should be called once per control period */
+void modulation_matrix_process(struct modulation_matrix*);
+
+static inline void modulation_matrix_set_source(struct modulation_matrix* this, enum modulation_source source, fixed16 value) __attribute__((always_inline, unused));
+static inline void modulation_matrix_set_source(struct modulation_matrix* this, enum modulation_source source, fixed16 value) {
+    this->sources[source] = value;
+}
+
+static inline fixed16 modulation_matrix_get(const struct modulation_matrix* this, enum modulation_destination destination) __attribute__((always_inline, unused));
+static inline fixed16 modulation_matrix_get(const struct modulation_matrix* this, enum modulation_destination destination) {
+    return this->destinations[destination];
+}
+
+#endif
@@ -10,6 +10,12 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(dsp, CONFIG_LOG_DSP_LEVEL);
 
+/* per sample change of phase_increment to reach the target at the end of the block */
+static inline int32_t _phase_increment_ramp(const struct oscillator* osc, size_t block_size)
+{
+  return (int32_t)(osc->phase_increment_target - osc->phase_increment) / (int32_t)block_size;
+}
+
 void osc_init(struct oscillator* osc)
 {
   __ASSERT_NO_MSG(osc != NULL);
@@ -18,6 +24,7 @@ void osc_init(struct oscillator* osc)
     .magnitude = FLOAT_TO_FIXED16(1.0),
     .phase_accumulate = 0,
     .phase_increment = 0,
+    .phase_increment_target = 0,
   };
 }
 
@@ -33,12 +40,28 @@ void osc_set_freq(struct oscillator* osc, float freq)
   __ASSERT_NO_MSG(osc != NULL);
   __ASSERT(freq >= 0 && freq < CONFIG_AUDIO_SAMPLE_RATE_HZ / 2, "oscillator frequency block of range");
 
-  osc->phase_increment = (freq / CONFIG_AUDIO_SAMPLE_RATE_HZ / 2) * UINT32_MAX;
+  osc->phase_increment = (freq / CONFIG_AUDIO_SAMPLE_RATE_HZ) * UINT32_MAX;
+  osc->phase_increment_target = osc->phase_increment;
+}
+
+void osc_set_phase_increment(struct oscillator* osc, uint32_t phase_increment)
+{
+  __ASSERT_NO_MSG(osc != NULL);
+  __ASSERT(phase_increment < UINT32_MAX / 2, "oscillator phase increment out of range");
+
+  osc->phase_increment = phase_increment;
+  osc->phase_increment_target = phase_increment;
+}
+
+void osc_set_phase_increment_target(struct oscillator* osc, uint32_t phase_increment)
+{
+  __ASSERT_NO_MSG(osc != NULL);
+
+  osc->phase_increment_target = phase_increment;
 }
 
 bool osc_process_sine(struct oscillator* osc, fixed16* block, size_t block_size)
 {
-  BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2, "oscillator only support 16-bit");
   __ASSERT_NO_MSG(osc != NULL);
   __ASSERT_NO_MSG(block != NULL);
 
@@ -46,25 +69,33 @@ bool osc_process_sine(struct oscillator* osc, fixed16* block, size_t block_size)
     return false;
   }
 
+  const int32_t phase_increment_ramp = _phase_increment_ramp(osc, block_size);
+
   for (uint32_t i = 0; i < block_size; i++) {
-    /* upper 8 bit as 256-value sample index */
-    uint32_t wave_index = osc->phase_accumulate >> 24;
+    /* upper bits as sample index */
+    uint32_t wave_index = SINE_INDEX(osc->phase_accumulate);
 
+#if CONFIG_SYNTH_SINE_INTERPOLATION
     /* interpolate between the two samples for better audio quality */
-    uint32_t interpolate_pos = (osc->phase_accumulate >> 8) & UINT16_MAX;
+    uint32_t interpolate_pos = SINE_INTERPOLATE_POS(osc->phase_accumulate);
 
-    block[i] = FIXED_INTERPOLATE_AND_SCALE(sinus_samples[wave_index], sinus_samples[wave_index + 1], interpolate_pos, osc->magnitude);
+    block[i] = SINE_INTERPOLATE_AND_SCALE(sinus_samples[wave_index], sinus_samples[wave_index + 1], interpolate_pos, osc->magnitude);
+#else
+    /* table is large enough for the nearest sample to be sufficient */
+    block[i] = SINE_SCALE(sinus_samples[wave_index], osc->magnitude);
+#endif
 
     /* increment waveform phase */
     osc->phase_accumulate += osc->phase_increment;
+    osc->phase_increment += phase_increment_ramp;
   }
+  osc->phase_increment = osc->phase_increment_target;
 
   return true;
 }
 
 bool osc_process_sinecrush(struct oscillator* osc, fixed16* block, size_t block_size)
 {
-  BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2, "oscillator only support 16-bit");
   __ASSERT_NO_MSG(osc != NULL);
   __ASSERT_NO_MSG(block != NULL);
 
@@ -72,25 +103,28 @@ bool osc_process_sinecrush(struct oscillator* osc, fixed16* block, size_t block_
     return false;
   }
 
+  const int32_t phase_increment_ramp = _phase_increment_ramp(osc, block_size);
+
   for (uint32_t i = 0; i < block_size; i++) {
-    /* upper 8 bit as 256-value sample index */
-    uint32_t wave_index = osc->phase_accumulate >> 24;
+    /* upper bits as sample index */
+    uint32_t wave_index = SINE_INDEX(osc->phase_accumulate);
 
     /* interpolate between the two samples for better audio quality */
-    uint32_t interpolate_pos = (osc->phase_accumulate >> 8) & UINT16_MAX;
+    uint32_t interpolate_pos = SINE_INTERPOLATE_POS(osc->phase_accumulate);
 
-    block[i] = FIXED_INTERPOLATE_AND_SCALE(sinus_samples[wave_index + 1], sinus_samples[wave_index], interpolate_pos, osc->magnitude);
+    block[i] = SINE_INTERPOLATE_AND_SCALE(sinus_samples[wave_index + 1], sinus_samples[wave_index], interpolate_pos, osc->magnitude);
 
     /* increment waveform phase */
     osc->phase_accumulate += osc->phase_increment;
+    osc->phase_increment += phase_increment_ramp;
   }
+  osc->phase_increment = osc->phase_increment_target;
 
   return true;
 }
 
 bool osc_process_triangle(struct oscillator* osc, fixed16* block, size_t block_size)
 {
-  BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2, "oscillator only support 16-bit");
   __ASSERT_NO_MSG(osc != NULL);
   __ASSERT_NO_MSG(block != NULL);
 
@@ -98,6 +132,8 @@ bool osc_process_triangle(struct oscillator* osc, fixed16* block, size_t block_s
     return false;
   }
 
+  const int32_t phase_increment_ramp = _phase_increment_ramp(osc, block_size);
+
   for (int i = 0; i < block_size; i++) {
     uint32_t phtop = osc->phase_accumulate >> 30;
     if (phtop == 1 || phtop == 2) {
@@ -106,13 +142,14 @@ bool osc_process_triangle(struct oscillator* osc, fixed16* block, size_t block_s
       block[i] = UFIXED_MULTIPLY((int32_t)osc->phase_accumulate >> 15, osc->magnitude);
     }
     osc->phase_accumulate += osc->phase_increment;
+    osc->phase_increment += phase_increment_ramp;
   }
+  osc->phase_increment = osc->phase_increment_target;
 
 	return true;
 }
 
 bool osc_process_sawtooth(struct oscillator* osc, fixed16* block, size_t block_size) {
-  BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2, "oscillator only support 16-bit");
   __ASSERT_NO_MSG(osc != NULL);
   __ASSERT_NO_MSG(block != NULL);
 
@@ -120,11 +157,15 @@ bool osc_process_sawtooth(struct oscillator* osc, fixed16* block, size_t block_s
     return false;
   }
 
+  const int32_t phase_increment_ramp = _phase_increment_ramp(osc, block_size);
+
   for (int i = 0; i < block_size; i++) {
     block[i] = signed_multiply_32x16t(osc->magnitude, osc->phase_accumulate);
 
     osc->phase_accumulate += osc->phase_increment;
+    osc->phase_increment += phase_increment_ramp;
   }
+  osc->phase_increment = osc->phase_increment_target;
 
   return true;
 }
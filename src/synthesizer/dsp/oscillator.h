@@ -30,6 +30,9 @@ struct oscillator
 	fixed16 magnitude;
 	uint32_t phase_increment;
 	uint32_t phase_accumulate;
+
+	/* phase_increment is linearly ramped towards this value across the next processed block */
+	uint32_t phase_increment_target;
 };
 
 /* standard interface */
@@ -43,5 +46,7 @@ bool osc_process_sawtooth(struct oscillator* osc, fixed16* block, size_t block_s
 /* config */
 void osc_set_amplitude(struct oscillator* osc, fixed16 magnitude);
 void osc_set_freq(struct oscillator* osc, float freq);
+void osc_set_phase_increment(struct oscillator* osc, uint32_t phase_increment);
+void osc_set_phase_increment_target(struct oscillator* osc, uint32_t phase_increment);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "pluck_voice.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "lfsr.h"
+#include "delay_pool.h"
+
+/* the two point average delays the loop by half a sample */
+#define _AVERAGE_DELAY_Q16 (1 << 15)
+
+/* the allpass is kept in the delay range [0.1, 1.1) samples, where it is well behaved */
+#define _ALLPASS_MIN_DELAY_Q16 6554
+
+void pluck_voice_init(struct pluck_voice* voice)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    *voice = (struct pluck_voice) {
+        .buffer = NULL,
+        .buffer_size = 0,
+        .magnitude = FLOAT_TO_FIXED16(1.0),
+        .damping = FLOAT_TO_FIXED16(0.996),
+        .noise = LFSR_SEED,
+    };
+}
+
+bool pluck_voice_start(struct pluck_voice* voice, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT_NO_MSG(phase_increment > 0);
+
+    /* loop period in samples, Q16 */
+    const uint64_t period = ((uint64_t)1 << 48) / phase_increment;
+
+    const uint32_t delay = (period - _AVERAGE_DELAY_Q16 - _ALLPASS_MIN_DELAY_Q16) >> 16;
+    const int32_t allpass_delay = period - _AVERAGE_DELAY_Q16 - ((uint64_t)delay << 16);
+
+    /* (1 - d) / (1 + d) */
+    const fixed16 allpass_coefficient = (int64_t)((1 << 16) - allpass_delay) * INT16_MAX / ((1 << 16) + allpass_delay);
+
+    if (delay != voice->buffer_size) {
+        pluck_voice_release(voice);
+
+        voice->buffer = delay_pool_alloc(delay);
+        if (voice->buffer == NULL) {
+            return false;
+        }
+        voice->buffer_size = delay;
+    }
+
+    voice->delay = delay;
+    voice->index = 0;
+    voice->previous = 0;
+    voice->allpass_coefficient = allpass_coefficient;
+    voice->allpass_input = 0;
+    voice->allpass_output = 0;
+
+    /* excitation, one period of white noise */
+    for (uint32_t i = 0; i < delay; i++) {
+        voice->buffer[i] = FIXED_MULTIPLY((fixed16)(lfsr_next(&voice->noise) >> 16), voice->magnitude);
+    }
+
+    return true;
+}
+
+void pluck_voice_release(struct pluck_voice* voice)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    delay_pool_free(voice->buffer, voice->buffer_size);
+    voice->buffer = NULL;
+    voice->buffer_size = 0;
+}
+
+void pluck_voice_set_amplitude(struct pluck_voice* voice, fixed16 magnitude)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+
+    voice->magnitude = magnitude;
+}
+
+void pluck_voice_set_damping(struct pluck_voice* voice, fixed16 damping)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT(damping >= 0, "damping must be positive");
+
+    voice->damping = damping;
+}
+
+bool pluck_voice_process(struct pluck_voice* voice, fixed16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(voice != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (voice->buffer == NULL) {
+        return false;
+    }
+
+    fixed16* buffer = voice->buffer;
+    const uint32_t delay = voice->delay;
+    const fixed16 damping = voice->damping;
+    const int32_t allpass_coefficient = voice->allpass_coefficient;
+
+    uint32_t index = voice->index;
+    fixed16 previous = voice->previous;
+    fixed16 allpass_input = voice->allpass_input;
+    fixed16 allpass_output = voice->allpass_output;
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        const fixed16 sample = buffer[index];
+
+        /* averaging lowpass with loop gain */
+        const fixed16 averaged = FIXED_MULTIPLY(((int32_t)sample + previous) >> 1, damping);
+
+        /* y[n] = c * (x[n] - y[n-1]) + x[n-1] */
+        allpass_output = saturate16(allpass_input + ((allpass_coefficient * ((int32_t)averaged - allpass_output)) >> 15));
+        allpass_input = averaged;
+        previous = sample;
+
+        buffer[index] = allpass_output;
+        block[i] = sample;
+
+        index++;
+        if (index == delay) {
+            index = 0;
+        }
+    }
+
+    voice->index = index;
+    voice->previous = previous;
+    voice->allpass_input = allpass_input;
+    voice->allpass_output = allpass_output;
+
+    return true;
+}
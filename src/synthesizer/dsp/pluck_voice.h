@@ -0,0 +1,59 @@
+/**
+ * @file pluck_voice.h
+ * @author Rein Gundersen Bentdal
+ * @brief Karplus-Strong plucked string. A noise burst circulates in a delay line through an averaging
+ *  lowpass and a fractional delay allpass, with delay memory taken from the shared delay pool
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PLUCK_VOICE_H_
+#define _PLUCK_VOICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+
+struct pluck_voice {
+    fixed16* buffer;
+    size_t buffer_size;
+    uint32_t delay;
+    uint32_t index;
+
+    /* previous delay line output, for the two point average */
+    fixed16 previous;
+
+    /* first order allpass tuning the fractional part of the period */
+    fixed16 allpass_coefficient;
+    fixed16 allpass_input;
+    fixed16 allpass_output;
+
+    fixed16 magnitude;
+
+    /* loop gain, sets the decay time together with the pitch */
+    fixed16 damping;
+
+    uint32_t noise;
+};
+
+void pluck_voice_init(struct pluck_voice* voice);
+
+/* allocates a delay line for the period of the phase increment and excites it with noise.
+ * Returns false if the delay pool is exhausted, in which case the voice is silent */
+bool pluck_voice_start(struct pluck_voice* voice, uint32_t phase_increment);
+
+/* returns the delay line to the pool */
+void pluck_voice_release(struct pluck_voice* voice);
+
+bool pluck_voice_process(struct pluck_voice* voice, fixed16* block, size_t block_size);
+
+/* config, amplitude takes effect from the next start */
+void pluck_voice_set_amplitude(struct pluck_voice* voice, fixed16 magnitude);
+void pluck_voice_set_damping(struct pluck_voice* voice, fixed16 damping);
+
+#endif
@@ -0,0 +1,193 @@
+#include "sample_player.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "pitch_table.h"
+
+static inline uint32_t _end(const struct sample_player* player);
+static inline bool _wrap(struct sample_player* player);
+static inline void _pcm_fetch(struct sample_player* player);
+static inline void _adpcm_fetch(struct sample_player* player);
+
+void sample_player_init(struct sample_player* player)
+{
+    __ASSERT_NO_MSG(player != NULL);
+
+    *player = (struct sample_player) {
+        .playing = false,
+        .magnitude = FLOAT_TO_FIXED16(1.0),
+    };
+}
+
+void sample_player_start(struct sample_player* player, const struct sample* sample, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(player != NULL);
+    __ASSERT_NO_MSG(sample != NULL);
+    __ASSERT(sample->length > 0, "empty sample");
+    __ASSERT(sample->mode != SAMPLE_MODE_LOOP ||
+        (sample->loop_start < sample->loop_end && sample->loop_end <= sample->length), "invalid loop points");
+    __ASSERT(sample->root_note < PITCH_NOTE_NUM, "root note out of range");
+    __ASSERT(sample->sample_rate_hz > 0, "sample rate not set");
+
+    player->sample = *sample;
+    player->playing = true;
+
+    player->index = 0;
+    player->phase_accumulate = 0;
+    player->current = 0;
+    player->next = 0;
+
+    player->decoder = (struct adpcm_state) {0, 0};
+    player->loop_decoder = player->decoder;
+    player->decoded = 0;
+    player->history[0] = 0;
+    player->history[1] = 0;
+    player->loop_sample = 0;
+
+    /* rate relative to the root note, corrected for the rate the sample was recorded at, is
+     * phase_increment * ratio / root. ratio / root is normalized to 32 significant bits and a shift */
+    const uint64_t ratio = ((uint64_t)sample->sample_rate_hz << 32) / pitch_table_sample_rate_hz;
+    const uint32_t root = note_phase_increment[sample->root_note];
+
+    int shift = __builtin_clzll(ratio);
+    uint64_t factor = (ratio << shift) / root;
+    while (factor > UINT32_MAX) {
+        factor >>= 1;
+        shift--;
+    }
+
+    player->rate_factor = factor;
+    player->rate_shift = shift;
+
+    sample_player_set_phase_increment(player, phase_increment);
+}
+
+void sample_player_set_amplitude(struct sample_player* player, fixed16 magnitude)
+{
+    __ASSERT_NO_MSG(player != NULL);
+
+    player->magnitude = magnitude;
+}
+
+void sample_player_set_phase_increment(struct sample_player* player, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(player != NULL);
+
+    /* playback rate in samples per frame, Q32.32 */
+    const uint64_t rate = ((uint64_t)phase_increment * player->rate_factor) >> player->rate_shift;
+
+    player->index_increment = rate >> 32;
+    player->phase_increment = (uint32_t)rate;
+}
+
+bool sample_player_process(struct sample_player* player, fixed16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(player != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (!player->playing || player->magnitude == 0) {
+        return false;
+    }
+
+    const bool adpcm = player->sample.format == SAMPLE_FORMAT_IMA_ADPCM;
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        if (adpcm) {
+            _adpcm_fetch(player);
+        } else {
+            _pcm_fetch(player);
+        }
+
+        block[i] = FIXED_INTERPOLATE_AND_SCALE(player->current, player->next, player->phase_accumulate >> 16, player->magnitude);
+
+        /* fractional part carries into the integer position */
+        const uint32_t phase_accumulate = player->phase_accumulate + player->phase_increment;
+        player->index += player->index_increment + (phase_accumulate < player->phase_accumulate);
+        player->phase_accumulate = phase_accumulate;
+
+        if (player->index >= _end(player) && !_wrap(player)) {
+            /* one shot finished, the rest of the block is silent */
+            for (i++; i < block_size; i++) {
+                block[i] = 0;
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+static inline uint32_t _end(const struct sample_player* player)
+{
+    return player->sample.mode == SAMPLE_MODE_LOOP ? player->sample.loop_end : player->sample.length;
+}
+
+/* returns false if playback has ended */
+static inline bool _wrap(struct sample_player* player)
+{
+    if (player->sample.mode != SAMPLE_MODE_LOOP) {
+        player->playing = false;
+        return false;
+    }
+
+    const uint32_t loop_length = player->sample.loop_end - player->sample.loop_start;
+    while (player->index >= player->sample.loop_end) {
+        player->index -= loop_length;
+    }
+
+    /* adpcm can not be decoded from an arbitrary position, restart from the state at the loop start */
+    if (player->sample.format == SAMPLE_FORMAT_IMA_ADPCM) {
+        player->decoder = player->loop_decoder;
+        player->decoded = player->sample.loop_start;
+    }
+
+    return true;
+}
+
+static inline void _pcm_fetch(struct sample_player* player)
+{
+    const fixed16* data = player->sample.data;
+    const uint32_t index = player->index;
+
+    uint32_t next = index + 1;
+    if (next >= _end(player)) {
+        next = player->sample.mode == SAMPLE_MODE_LOOP ? player->sample.loop_start : index;
+    }
+
+    player->current = data[index];
+    player->next = data[next];
+}
+
+static inline void _adpcm_fetch(struct sample_player* player)
+{
+    const uint8_t* data = player->sample.data;
+    const uint32_t end = _end(player);
+
+    /* decode until the history holds the sample at index and the one following it, within the sample or loop */
+    while (player->decoded <= player->index + 1 && player->decoded < end) {
+        if (player->decoded == player->sample.loop_start) {
+            player->loop_decoder = player->decoder;
+        }
+
+        player->history[1] = player->history[0];
+        player->history[0] = adpcm_decode(&player->decoder, adpcm_nibble(data, player->decoded));
+
+        if (player->decoded == player->sample.loop_start) {
+            player->loop_sample = player->history[0];
+        }
+
+        player->decoded++;
+    }
+
+    if (player->decoded > player->index + 1) {
+        player->current = player->history[1];
+        player->next = player->history[0];
+        return;
+    }
+
+    /* index is the last sample, as in _pcm_fetch the next is the loop start, or the last sample held */
+    player->current = player->history[0];
+    player->next = player->sample.mode == SAMPLE_MODE_LOOP ? player->loop_sample : player->history[0];
+}
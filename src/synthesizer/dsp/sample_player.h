@@ -0,0 +1,90 @@
+/**
+ * @file sample_player.h
+ * @author Rein Gundersen Bentdal
+ * @brief Playback of 16-bit PCM or IMA ADPCM samples read in place from memory mapped flash, at a
+ *  fractional rate with linear interpolation
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SAMPLE_PLAYER_H_
+#define _SAMPLE_PLAYER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+#include "adpcm.h"
+
+enum sample_format {
+    SAMPLE_FORMAT_PCM16,
+    SAMPLE_FORMAT_IMA_ADPCM,
+};
+
+enum sample_mode {
+    SAMPLE_MODE_ONE_SHOT,
+    SAMPLE_MODE_LOOP,
+};
+
+/* describes audio data which is not copied, typically pointing into flash */
+struct sample {
+    const void* data;
+
+    /* lengths and loop points in samples, the loop end is exclusive */
+    uint32_t length;
+    uint32_t loop_start;
+    uint32_t loop_end;
+
+    uint32_t sample_rate_hz;
+    uint8_t root_note;
+
+    enum sample_format format;
+    enum sample_mode mode;
+};
+
+struct sample_player {
+    struct sample sample;
+    bool playing;
+
+    fixed16 magnitude;
+
+    /* playback position, integer sample index and a 32-bit fraction as in the oscillator phase */
+    uint32_t index;
+    uint32_t phase_accumulate;
+    uint32_t index_increment;
+    uint32_t phase_increment;
+
+    /* playback rate for each unit of phase increment, rate = (phase_increment * rate_factor) >> rate_shift.
+     * Computed when started, so changes of pitch are one multiply */
+    uint32_t rate_factor;
+    uint8_t rate_shift;
+
+    /* the two samples interpolated between */
+    fixed16 current;
+    fixed16 next;
+
+    /* adpcm is decoded sequentially, decoded is the index of the next sample to decode. The last two
+     * decoded samples are kept, the latest first, and the sample at the loop start for the loop seam */
+    struct adpcm_state decoder;
+    struct adpcm_state loop_decoder;
+    uint32_t decoded;
+    fixed16 history[2];
+    fixed16 loop_sample;
+};
+
+void sample_player_init(struct sample_player* player);
+
+/* starts from the beginning of the sample, playing it at the pitch of the phase increment */
+void sample_player_start(struct sample_player* player, const struct sample* sample, uint32_t phase_increment);
+
+/* returns false when a one shot sample has finished */
+bool sample_player_process(struct sample_player* player, fixed16* block, size_t block_size);
+
+void sample_player_set_amplitude(struct sample_player* player, fixed16 magnitude);
+void sample_player_set_phase_increment(struct sample_player* player, uint32_t phase_increment);
+
+#endif
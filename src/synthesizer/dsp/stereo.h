@@ -0,0 +1,171 @@
+/**
+ * @file stereo.h
+ * @author Rein Gundersen Bentdal
+ * @brief Packed stereo samples, left and right fixed16 in one 32-bit word handled by the dual 16-bit instructions.
+ *  Q31 frames for the alternative bus format, and conversion to the PCM depth of the codec
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _STEREO_H_
+#define _STEREO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "waveforms.h"
+
+/* left channel in the lower and right channel in the upper 16 bits, the same layout as interleaved 16-bit PCM */
+typedef uint32_t stereo16;
+
+/* stereo frame with 32 bits per channel */
+struct stereo32 {
+    fixed32 left;
+    fixed32 right;
+};
+
+/* frame format of the synthesizer bus */
+#if CONFIG_SYNTH_BUS_Q31
+typedef struct stereo32 bus_frame;
+#else
+typedef stereo16 bus_frame;
+#endif
+
+#define STEREO_LEFT(sample) ((fixed16)((sample) & UINT16_MAX))
+#define STEREO_RIGHT(sample) ((fixed16)((sample) >> 16))
+
+static inline stereo16 stereo_pack(fixed16 left, fixed16 right) __attribute__((always_inline, unused));
+static inline stereo16 stereo_pack(fixed16 left, fixed16 right)
+{
+    return pack_16b_16b(right, left);
+}
+
+/* constant power gains for pan in [-1, 1], from hard left to hard right */
+static inline stereo16 stereo_pan_gains(fixed16 pan) __attribute__((always_inline, unused));
+static inline stereo16 stereo_pan_gains(fixed16 pan)
+{
+    /* pan angle from 0 to a quarter period, as a sine phase */
+    const uint32_t phase = (uint32_t)((int32_t)pan + INT16_MAX) << 14;
+
+    const fixed16 left = sine_sample(phase + (UINT32_MAX / 4 + 1));
+    const fixed16 right = sine_sample(phase);
+
+    /* gains are kept positive, the table may round slightly below zero at the ends */
+    return stereo_pack(left < 0 ? 0 : left, right < 0 ? 0 : right);
+}
+
+/* multiplies each channel with the matching channel of a packed gain, gains must be positive */
+static inline stereo16 stereo_multiply(stereo16 sample, stereo16 gains) __attribute__((always_inline, unused));
+static inline stereo16 stereo_multiply(stereo16 sample, stereo16 gains)
+{
+    const int32_t left = multiply_16bx16b(sample, gains);
+    const int32_t right = multiply_16tx16t(sample, gains);
+    return pack_16t_16t((uint32_t)right << 1, (uint32_t)left << 1);
+}
+
+/* adds a mono block to a stereo block, placed by packed pan gains */
+static inline void stereo_mix_panned(stereo16* destination, const fixed16* source, size_t block_size, stereo16 gains) __attribute__((always_inline, unused));
+static inline void stereo_mix_panned(stereo16* destination, const fixed16* source, size_t block_size, stereo16 gains)
+{
+    for (size_t i = 0; i < block_size; i++) {
+        const int32_t left = multiply_16bx16b(source[i], gains);
+        const int32_t right = multiply_16bx16t(source[i], gains);
+        destination[i] = signed_add_16_and_16(destination[i], pack_16t_16t((uint32_t)right << 1, (uint32_t)left << 1));
+    }
+}
+
+/* adds a stereo block to a stereo block, both channels in one saturating instruction */
+static inline void stereo_mix(stereo16* destination, const stereo16* source, size_t block_size) __attribute__((always_inline, unused));
+static inline void stereo_mix(stereo16* destination, const stereo16* source, size_t block_size)
+{
+    for (size_t i = 0; i < block_size; i++) {
+        destination[i] = signed_add_16_and_16(destination[i], source[i]);
+    }
+}
+
+/* multiplies both channels with a gain linearly ramped from start to end */
+static inline void stereo_gain_ramp(stereo16* block, size_t block_size, fixed16 start, fixed16 end) __attribute__((always_inline, unused));
+static inline void stereo_gain_ramp(stereo16* block, size_t block_size, fixed16 start, fixed16 end)
+{
+    /* unity gain, nothing to do */
+    if (start == INT16_MAX && end == INT16_MAX) {
+        return;
+    }
+
+    /* gain in upper 16 bit, lower 16 bit accumulates the fractional ramp */
+    int32_t gain = (int32_t)start << 16;
+    const int32_t gain_ramp = (((int32_t)end - start) << 16) / (int32_t)block_size;
+
+    for (size_t i = 0; i < block_size; i++) {
+        /* the same gain in both halves */
+        const uint32_t gains = (uint32_t)gain >> 16;
+        block[i] = stereo_multiply(block[i], gains | (gains << 16));
+        gain += gain_ramp;
+    }
+}
+
+/* adds a mono block to a Q31 stereo block, placed by packed pan gains. The products are exact in Q31 */
+static inline void stereo32_mix_panned(struct stereo32* destination, const fixed16* source, size_t block_size, stereo16 gains) __attribute__((always_inline, unused));
+static inline void stereo32_mix_panned(struct stereo32* destination, const fixed16* source, size_t block_size, stereo16 gains)
+{
+    for (size_t i = 0; i < block_size; i++) {
+        const int32_t left = multiply_16bx16b(source[i], gains);
+        const int32_t right = multiply_16bx16t(source[i], gains);
+        destination[i].left = add_32_saturate(destination[i].left, left * 2);
+        destination[i].right = add_32_saturate(destination[i].right, right * 2);
+    }
+}
+
+/* adds a packed stereo block to a Q31 stereo block */
+static inline void stereo32_mix(struct stereo32* destination, const stereo16* source, size_t block_size) __attribute__((always_inline, unused));
+static inline void stereo32_mix(struct stereo32* destination, const stereo16* source, size_t block_size)
+{
+    for (size_t i = 0; i < block_size; i++) {
+        destination[i].left = add_32_saturate(destination[i].left, FIXED16_TO_FIXED32(STEREO_LEFT(source[i])));
+        destination[i].right = add_32_saturate(destination[i].right, FIXED16_TO_FIXED32(STEREO_RIGHT(source[i])));
+    }
+}
+
+/* PCM conversion, pcm holds interleaved left and right samples. The packed format already is 16-bit PCM */
+
+/* rounds to 16 bits, saturating */
+static inline void stereo32_to_pcm16(const struct stereo32* frames, int16_t* pcm, size_t frame_count) __attribute__((always_inline, unused));
+static inline void stereo32_to_pcm16(const struct stereo32* frames, int16_t* pcm, size_t frame_count)
+{
+    for (size_t i = 0; i < frame_count; i++) {
+        pcm[2 * i] = add_32_saturate(frames[i].left, 1 << 15) >> 16;
+        pcm[2 * i + 1] = add_32_saturate(frames[i].right, 1 << 15) >> 16;
+    }
+}
+
+/* rounds to bits, left aligned in 32-bit containers. The codec reads 24-bit samples as full scale 32-bit
+ * ones, with the low byte zero */
+static inline void stereo32_to_pcm32(const struct stereo32* frames, int32_t* pcm, size_t frame_count, const int bits) __attribute__((always_inline, unused));
+static inline void stereo32_to_pcm32(const struct stereo32* frames, int32_t* pcm, size_t frame_count, const int bits)
+{
+    const int shift = 32 - bits;
+    const int32_t round = (1 << shift) >> 1;
+    const int32_t mask = ~((1 << shift) - 1);
+
+    for (size_t i = 0; i < frame_count; i++) {
+        pcm[2 * i] = add_32_saturate(frames[i].left, round) & mask;
+        pcm[2 * i + 1] = add_32_saturate(frames[i].right, round) & mask;
+    }
+}
+
+/* widens to 32 bits, left aligned as from stereo32_to_pcm32 */
+static inline void stereo16_to_pcm32(const stereo16* frames, int32_t* pcm, size_t frame_count) __attribute__((always_inline, unused));
+static inline void stereo16_to_pcm32(const stereo16* frames, int32_t* pcm, size_t frame_count)
+{
+    for (size_t i = 0; i < frame_count; i++) {
+        pcm[2 * i] = FIXED16_TO_FIXED32(STEREO_LEFT(frames[i]));
+        pcm[2 * i + 1] = FIXED16_TO_FIXED32(STEREO_RIGHT(frames[i]));
+    }
+}
+
+#endif
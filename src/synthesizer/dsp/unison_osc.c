@@ -0,0 +1,162 @@
+#include "unison_osc.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+#include "lfsr.h"
+
+BUILD_ASSERT(UNISON_VOICES >= 1 && UNISON_VOICES <= 8, "unison supports 1 to 8 phases");
+
+/* 2^(1/24) - 1, the outer phases at detune 1 are half a semitone from the center */
+#define _DETUNE_MAX_Q15 960
+
+/* 1/sqrt(n) for n phases, the sum of uncorrelated phases grows with the square root */
+static const fixed16 _normalize[8] = {32767, 23170, 18918, 16384, 14654, 13377, 12385, 11585};
+
+/* stereo channel of phase k, ordered by detune. Phases above the center are shifted by one to
+ * give both channels the same number of phases, each with both flat and sharp phases */
+#define _CENTER (UNISON_VOICES / 2)
+#define _HAS_CENTER (UNISON_VOICES % 2 == 1)
+#define _IS_CENTER(k) (_HAS_CENTER && (k) == _CENTER)
+#define _IS_LEFT(k) (_IS_CENTER(k) || ((k) < _CENTER ? (k) % 2 == 0 : ((k) + _HAS_CENTER) % 2 == 0))
+#define _IS_RIGHT(k) (_IS_CENTER(k) || !_IS_LEFT(k))
+
+/* phases per channel, including the center */
+#define _CHANNEL_PHASES (UNISON_VOICES / 2 + _HAS_CENTER)
+
+void unison_osc_init(struct unison_osc* osc)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    *osc = (struct unison_osc) {
+        .magnitude = FLOAT_TO_FIXED16(1.0),
+        .gain = _normalize[UNISON_VOICES - 1],
+        .detune = FLOAT_TO_FIXED16(0.3),
+        .noise = LFSR_SEED,
+    };
+}
+
+void unison_osc_start(struct unison_osc* osc)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        osc->phase_accumulate[k] = lfsr_next(&osc->noise);
+    }
+}
+
+void unison_osc_set_amplitude(struct unison_osc* osc, fixed16 magnitude)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    osc->magnitude = magnitude;
+    osc->gain = FIXED_MULTIPLY(magnitude, _normalize[UNISON_VOICES - 1]);
+}
+
+void unison_osc_set_detune(struct unison_osc* osc, fixed16 detune)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+    __ASSERT(detune >= 0, "detune must be positive");
+
+    osc->detune = detune;
+}
+
+void unison_osc_set_phase_increment(struct unison_osc* osc, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    if (UNISON_VOICES == 1) {
+        osc->phase_increment[0] = phase_increment;
+        return;
+    }
+
+    /* offset of the outermost phases, the rest are evenly spread in between */
+    const int64_t outer = ((int64_t)phase_increment * _DETUNE_MAX_Q15 * osc->detune) >> 30;
+
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        const int32_t position = 2 * k - (UNISON_VOICES - 1);
+        osc->phase_increment[k] = phase_increment + outer * position / (UNISON_VOICES - 1);
+    }
+}
+
+bool unison_osc_process(struct unison_osc* osc, fixed16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (osc->magnitude == 0) {
+        return false;
+    }
+
+    /* local copies with a constant length are unrolled, keeping the phases in registers */
+    uint32_t phase[UNISON_VOICES];
+    uint32_t increment[UNISON_VOICES];
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        phase[k] = osc->phase_accumulate[k];
+        increment[k] = osc->phase_increment[k];
+    }
+
+    const int32_t gain = osc->gain;
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        int32_t sum = 0;
+
+        for (int k = 0; k < UNISON_VOICES; k++) {
+            /* upper 16 bits of the phase as a sawtooth */
+            sum += (int32_t)phase[k] >> 16;
+            phase[k] += increment[k];
+        }
+
+        /* the sum of all phases times the Q15 gain exceeds 32 bits, smulwb keeps 48 bits of the product */
+        block[i] = saturate16(signed_multiply_32x16b(sum << 1, gain));
+    }
+
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        osc->phase_accumulate[k] = phase[k];
+    }
+
+    return true;
+}
+
+bool unison_osc_process_stereo(struct unison_osc* osc, stereo16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (osc->magnitude == 0) {
+        return false;
+    }
+
+    uint32_t phase[UNISON_VOICES];
+    uint32_t increment[UNISON_VOICES];
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        phase[k] = osc->phase_accumulate[k];
+        increment[k] = osc->phase_increment[k];
+    }
+
+    /* each channel at -3 dB, as a mono voice panned to the center */
+    const int32_t gain = FIXED_MULTIPLY(osc->magnitude, _normalize[2 * _CHANNEL_PHASES - 1]);
+
+    for (uint32_t i = 0; i < block_size; i++) {
+        int32_t sum_left = 0;
+        int32_t sum_right = 0;
+
+        /* channel selection is constant per phase and folded away when unrolled */
+        for (int k = 0; k < UNISON_VOICES; k++) {
+            const int32_t saw = (int32_t)phase[k] >> 16;
+            if (_IS_LEFT(k)) sum_left += saw;
+            if (_IS_RIGHT(k)) sum_right += saw;
+            phase[k] += increment[k];
+        }
+
+        block[i] = stereo_pack(saturate16(signed_multiply_32x16b(sum_left << 1, gain)),
+            saturate16(signed_multiply_32x16b(sum_right << 1, gain)));
+    }
+
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        osc->phase_accumulate[k] = phase[k];
+    }
+
+    return true;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file unison_osc.h
+ * @author Rein Gundersen Bentdal
+ * @brief Supersaw, CONFIG_SYNTH_UNISON_VOICES detuned sawtooth phases summed by one kernel
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _UNISON_OSC_H_
+#define _UNISON_OSC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+#include "stereo.h"
+
+#define UNISON_VOICES CONFIG_SYNTH_UNISON_VOICES
+
+struct unison_osc {
+    uint32_t phase_accumulate[UNISON_VOICES];
+    uint32_t phase_increment[UNISON_VOICES];
+
+    /* magnitude normalized by the number of phases */
+    fixed16 magnitude;
+    fixed16 gain;
+
+    /* 1 spreads the outer phases one semitone apart */
+    fixed16 detune;
+
+    uint32_t noise;
+};
+
+void unison_osc_init(struct unison_osc* osc);
+
+/* randomizes the phases, as free running oscillators would be */
+void unison_osc_start(struct unison_osc* osc);
+
+bool unison_osc_process(struct unison_osc* osc, fixed16* block, size_t block_size);
+
+/* phases alternate between the channels by detune, an odd center phase is played in both */
+bool unison_osc_process_stereo(struct unison_osc* osc, stereo16* block, size_t block_size);
+
+void unison_osc_set_amplitude(struct unison_osc* osc, fixed16 magnitude);
+
+/* detuned increments are derived from the center increment, expected to be called at control rate */
+void unison_osc_set_phase_increment(struct unison_osc* osc, uint32_t phase_increment);
+
+/* takes effect from the next call to unison_osc_set_phase_increment */
+void unison_osc_set_detune(struct unison_osc* osc, fixed16 detune);
+
+#endif
@@ -1,6 +1,7 @@
 /**
- * @file effect_envelope.h
+ * @file waveforms.h
  * @author Rein Gundersen Bentdal
+ * @brief Waveform tables, generated at build time by scripts/waveform_sine.py
  * @date 2022-09-01
  * 
  * Copyright (c) 2023 Nordic Semiconductor ASA
@@ -10,7 +11,61 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #include "integer_math.h"
 
+#define SINE_TABLE_BITS CONFIG_SYNTH_SINE_TABLE_BITS
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+
+/* upper bits of a 32-bit phase as table index */
+#define SINE_INDEX(phase) ((uint32_t)(phase) >> (32 - SINE_TABLE_BITS))
+
+/* the following 16 bits of the phase as interpolation position between index and index + 1 */
+#define SINE_INTERPOLATE_POS(phase) (((uint32_t)(phase) >> (16 - SINE_TABLE_BITS)) & UINT16_MAX)
+
+/* sample format of the table, CONFIG_SYNTH_SINE_TABLE_Q31 keeps the interpolation between samples in 32 bits */
+#if CONFIG_SYNTH_SINE_TABLE_Q31
+typedef fixed32 sine_table_sample;
+#else
+typedef fixed16 sine_table_sample;
+#endif
+
 // because of interpolation between two samples (i and i+1), one extra sample to prevent check for overflow
-static const fixed16 sinus_samples[257] = {0,804,1608,2410,3212,4011,4808,5602,6393,7179,7962,8739,9512,10278,11039,11793,12539,13279,14010,14732,15446,16151,16846,17530,18204,18868,19519,20159,20787,21403,22005,22594,23170,23731,24279,24811,25329,25832,26319,26790,27245,27683,28105,28510,28898,29268,29621,29956,30273,30571,30852,31113,31356,31580,31785,31971,32137,32285,32412,32521,32609,32678,32728,32757,32767,32757,32728,32678,32609,32521,32412,32285,32137,31971,31785,31580,31356,31113,30852,30571,30273,29956,29621,29268,28898,28510,28105,27683,27245,26790,26319,25832,25329,24811,24279,23731,23170,22594,22005,21403,20787,20159,19519,18868,18204,17530,16846,16151,15446,14732,14010,13279,12539,11793,11039,10278,9512,8739,7962,7179,6393,5602,4808,4011,3212,2410,1608,804,0,-804,-1608,-2410,-3212,-4011,-4808,-5602,-6393,-7179,-7962,-8739,-9512,-10278,-11039,-11793,-12539,-13279,-14010,-14732,-15446,-16151,-16846,-17530,-18204,-18868,-19519,-20159,-20787,-21403,-22005,-22594,-23170,-23731,-24279,-24811,-25329,-25832,-26319,-26790,-27245,-27683,-28105,-28510,-28898,-29268,-29621,-29956,-30273,-30571,-30852,-31113,-31356,-31580,-31785,-31971,-32137,-32285,-32412,-32521,-32609,-32678,-32728,-32757,-32767,-32757,-32728,-32678,-32609,-32521,-32412,-32285,-32137,-31971,-31785,-31580,-31356,-31113,-30852,-30571,-30273,-29956,-29621,-29268,-28898,-28510,-28105,-27683,-27245,-26790,-26319,-25832,-25329,-24811,-24279,-23731,-23170,-22594,-22005,-21403,-20787,-20159,-19519,-18868,-18204,-17530,-16846,-16151,-15446,-14732,-14010,-13279,-12539,-11793,-11039,-10278,-9512,-8739,-7962,-7179,-6393,-5602,-4808,-4011,-3212,-2410,-1608,-804,0};
+extern const sine_table_sample sinus_samples[SINE_TABLE_SIZE + 1];
+
+#if CONFIG_SYNTH_SINE_TABLE_Q31
+
+/* Q31 between a and b, in the same range as the interpolation of FIXED_INTERPOLATE_AND_SCALE */
+static inline fixed32 _sine_interpolate(fixed32 a, fixed32 b, ufixed16 pos) __attribute__((always_inline, unused));
+static inline fixed32 _sine_interpolate(fixed32 a, fixed32 b, ufixed16 pos)
+{
+    return a + (fixed32)(((int64_t)b - a) * pos >> 16);
+}
+
+#define SINE_INTERPOLATE_AND_SCALE(a, b, pos, magnitude) \
+    ((fixed16)multiply_32x32_rshift32(_sine_interpolate(a, b, pos), (int32_t)(magnitude)))
+#define SINE_SCALE(a, magnitude) ((fixed16)(((int64_t)(a) * (magnitude)) >> 31))
+#define SINE_INTERPOLATE(a, b, pos) ((fixed16)(_sine_interpolate(a, b, pos) >> 16))
+#define SINE_TO_FIXED16(a) ((fixed16)((a) >> 16))
+
+#else
+
+#define SINE_INTERPOLATE_AND_SCALE(a, b, pos, magnitude) FIXED_INTERPOLATE_AND_SCALE(a, b, pos, magnitude)
+#define SINE_SCALE(a, magnitude) FIXED_MULTIPLY(a, magnitude)
+#define SINE_INTERPOLATE(a, b, pos) FIXED_INTERPOLATE(a, b, pos)
+#define SINE_TO_FIXED16(a) (a)
+
+#endif
+
+/* sine value at the given phase, interpolated if configured */
+static inline fixed16 sine_sample(uint32_t phase) __attribute__((always_inline, unused));
+static inline fixed16 sine_sample(uint32_t phase)
+{
+    const uint32_t wave_index = SINE_INDEX(phase);
+#if CONFIG_SYNTH_SINE_INTERPOLATION
+    return SINE_INTERPOLATE(sinus_samples[wave_index], sinus_samples[wave_index + 1], SINE_INTERPOLATE_POS(phase));
+#else
+    return SINE_TO_FIXED16(sinus_samples[wave_index]);
+#endif
+}
@@ -0,0 +1,134 @@
+#include "wavetable.h"
+
+#include <zephyr/kernel.h>
+
+#include "dsp_instructions.h"
+#include "integer_math.h"
+
+/* content below nyquist of the render rate is alias free */
+#define _LEVEL_HEADROOM_BITS 0
+
+/* phase increments of bit length above this needs a level with fewer harmonics than level 0 */
+#define _LEVEL_0_INCREMENT_BITS (32 - WAVETABLE_BITS - _LEVEL_HEADROOM_BITS)
+
+static inline uint32_t _select_level(uint32_t phase_increment);
+static inline const fixed16* _frame(const struct wavetable* table, uint32_t level, uint32_t frame);
+
+void wavetable_osc_init(struct wavetable_osc* osc, const struct wavetable* table)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+    __ASSERT_NO_MSG(table != NULL);
+    __ASSERT(table->frames > 0, "wavetable without frames");
+
+    *osc = (struct wavetable_osc) {
+        .table = table,
+        .magnitude = FLOAT_TO_FIXED16(1.0),
+        .phase_increment = 0,
+        .phase_accumulate = 0,
+        .phase_increment_target = 0,
+        .morph = 0,
+    };
+}
+
+void wavetable_osc_set_amplitude(struct wavetable_osc* osc, fixed16 magnitude)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    osc->magnitude = magnitude;
+}
+
+void wavetable_osc_set_phase_increment(struct wavetable_osc* osc, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    osc->phase_increment = phase_increment;
+    osc->phase_increment_target = phase_increment;
+}
+
+void wavetable_osc_set_phase_increment_target(struct wavetable_osc* osc, uint32_t phase_increment)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    osc->phase_increment_target = phase_increment;
+}
+
+void wavetable_osc_set_morph(struct wavetable_osc* osc, uint16_t morph)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+
+    osc->morph = morph;
+}
+
+bool wavetable_osc_process(struct wavetable_osc* osc, fixed16* block, size_t block_size)
+{
+    __ASSERT_NO_MSG(osc != NULL);
+    __ASSERT_NO_MSG(block != NULL);
+
+    if (osc->magnitude == 0) {
+        return false;
+    }
+
+    const int32_t phase_increment_ramp = (int32_t)(osc->phase_increment_target - osc->phase_increment) / (int32_t)block_size;
+
+    /* mip level is selected once per block, from the highest frequency reached within the block */
+    const uint32_t level = _select_level(MAX(osc->phase_increment, osc->phase_increment_target));
+
+    /* frame position in upper 16 bit, crossfade between frame and frame + 1 in lower 16 bit */
+    const uint32_t morph_position = (uint32_t)osc->morph * (osc->table->frames - 1);
+    const uint32_t frame_index = morph_position >> 16;
+    const ufixed16 crossfade = morph_position & UINT16_MAX;
+
+    const fixed16* frame = _frame(osc->table, level, frame_index);
+
+    uint32_t phase_accumulate = osc->phase_accumulate;
+    uint32_t phase_increment = osc->phase_increment;
+
+    if (crossfade == 0) {
+        /* exactly on a frame, same cost as the interpolated sine oscillator */
+        for (uint32_t i = 0; i < block_size; i++) {
+            const uint32_t wave_index = phase_accumulate >> (32 - WAVETABLE_BITS);
+            const uint32_t interpolate_pos = (phase_accumulate >> (16 - WAVETABLE_BITS)) & UINT16_MAX;
+
+            block[i] = FIXED_INTERPOLATE_AND_SCALE(frame[wave_index], frame[wave_index + 1], interpolate_pos, osc->magnitude);
+
+            phase_accumulate += phase_increment;
+            phase_increment += phase_increment_ramp;
+        }
+    } else {
+        const fixed16* frame_next = _frame(osc->table, level, frame_index + 1);
+
+        for (uint32_t i = 0; i < block_size; i++) {
+            const uint32_t wave_index = phase_accumulate >> (32 - WAVETABLE_BITS);
+            const uint32_t interpolate_pos = (phase_accumulate >> (16 - WAVETABLE_BITS)) & UINT16_MAX;
+
+            const fixed16 sample = FIXED_INTERPOLATE(frame[wave_index], frame[wave_index + 1], interpolate_pos);
+            const fixed16 sample_next = FIXED_INTERPOLATE(frame_next[wave_index], frame_next[wave_index + 1], interpolate_pos);
+
+            block[i] = FIXED_INTERPOLATE_AND_SCALE(sample, sample_next, crossfade, osc->magnitude);
+
+            phase_accumulate += phase_increment;
+            phase_increment += phase_increment_ramp;
+        }
+    }
+
+    osc->phase_accumulate = phase_accumulate;
+    osc->phase_increment = osc->phase_increment_target;
+
+    return true;
+}
+
+static inline uint32_t _select_level(uint32_t phase_increment)
+{
+    /* bit length of the increment, each additional bit is one octave up */
+    const int32_t increment_bits = 32 - __builtin_clz(phase_increment | 1);
+    const int32_t level = increment_bits - _LEVEL_0_INCREMENT_BITS;
+
+    return CLAMP(level, 0, WAVETABLE_LEVELS - 1);
+}
+
+static inline const fixed16* _frame(const struct wavetable* table, uint32_t level, uint32_t frame)
+{
+    __ASSERT(frame < table->frames, "wavetable frame out of range");
+
+    return table->samples + (level * table->frames + frame) * (WAVETABLE_SIZE + 1);
+}
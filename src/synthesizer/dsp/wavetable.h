@@ -0,0 +1,64 @@
+/**
+ * @file wavetable.h
+ * @author Rein Gundersen Bentdal
+ * @brief Wavetable oscillator reading multi-frame tables from flash, with one band-limited mip level per octave.
+ *  Tables are generated at build time by scripts/wavetable.py
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _WAVETABLE_H_
+#define _WAVETABLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "integer_math.h"
+
+#define WAVETABLE_BITS 8
+#define WAVETABLE_SIZE (1 << WAVETABLE_BITS)
+
+/* level 0 holds WAVETABLE_SIZE/2 harmonics, each following level half of the previous */
+#define WAVETABLE_LEVELS 8
+
+/* samples are stored as [level][frame][WAVETABLE_SIZE + 1] */
+struct wavetable {
+    const fixed16* samples;
+    uint8_t frames;
+};
+
+/* sine, triangle, sawtooth and square, in morph order */
+#define WAVETABLE_BASIC_FRAMES 4
+extern const fixed16 wavetable_basic_samples[WAVETABLE_LEVELS][WAVETABLE_BASIC_FRAMES][WAVETABLE_SIZE + 1];
+extern const struct wavetable wavetable_basic;
+
+struct wavetable_osc {
+    const struct wavetable* table;
+
+    fixed16 magnitude;
+    uint32_t phase_increment;
+    uint32_t phase_accumulate;
+
+    /* phase_increment is linearly ramped towards this value across the next processed block */
+    uint32_t phase_increment_target;
+
+    /* position across all frames, 0 is the first frame and UINT16_MAX the last */
+    uint16_t morph;
+};
+
+void wavetable_osc_init(struct wavetable_osc* osc, const struct wavetable* table);
+
+bool wavetable_osc_process(struct wavetable_osc* osc, fixed16* block, size_t block_size);
+
+void wavetable_osc_set_amplitude(struct wavetable_osc* osc, fixed16 magnitude);
+void wavetable_osc_set_phase_increment(struct wavetable_osc* osc, uint32_t phase_increment);
+void wavetable_osc_set_phase_increment_target(struct wavetable_osc* osc, uint32_t phase_increment);
+
+/* morph is expected to be updated at control rate, and is constant across a processed block */
+void wavetable_osc_set_morph(struct wavetable_osc* osc, uint16_t morph);
+
+#endif
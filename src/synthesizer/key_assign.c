@@ -27,7 +27,7 @@ void keys_init(struct keys* keys, key_play_cb play_cb, key_stop_cb stop_cb) {
     }
 }
 
-void keys_play(struct keys* keys, int note) {
+void keys_play(struct keys* keys, int note, uint8_t velocity) {
     __ASSERT(keys != NULL, "NULL pointer parameter");
 
     k_mutex_lock(&keys->mutex, K_FOREVER);
@@ -46,10 +46,11 @@ void keys_play(struct keys* keys, int note) {
     keys->head = key;
 
     key->note = note;
+    key->velocity = velocity;
 
     k_mutex_unlock(&keys->mutex);
 
-    keys->play_cb(key->index, key->note);
+    keys->play_cb(key->index, key->note, key->velocity);
 }
 
 void keys_stop(struct keys* keys, int note) {
@@ -97,7 +98,7 @@ void keys_print(struct keys* keys) {
     LOG_INF("--keys--");
     key = keys->head;
     while(key != NULL) {
-        LOG_INF("index %d, note %d", key->index, key->note);
+        LOG_INF("index %d, note %d, velocity %d", key->index, key->note, key->velocity);
         key = key->next;
     }
 }
\ No newline at end of file
@@ -16,13 +16,13 @@
 #include <stdint.h>
 #include <zephyr/kernel.h>
 
-typedef void(*key_play_cb)(int index, int note);
+typedef void(*key_play_cb)(int index, int note, uint8_t velocity);
 typedef void(*key_stop_cb)(int index);
 
 struct key {
     uint8_t index;
     uint8_t note;
-    // velocity
+    uint8_t velocity;
 
     struct key* next;
 };
@@ -39,7 +39,7 @@ struct keys {
 
 void keys_init(struct keys* keys, key_play_cb play_cb, key_stop_cb stop_cb);
 
-void keys_play(struct keys* keys, int note);
+void keys_play(struct keys* keys, int note, uint8_t velocity);
 void keys_stop(struct keys* keys, int note);
 
 void keys_print(struct keys* keys);
@@ -0,0 +1,117 @@
+#include "param_store.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+#include <errno.h>
+
+#include "integer_math.h"
+
+struct param_snapshot {
+    int32_t values[PARAM_NUM];
+};
+
+struct param_range {
+    int32_t min;
+    int32_t max;
+    int32_t init;
+};
+
+static const struct param_range _ranges[PARAM_NUM] = {
+    [PARAM_ECHO_DELAY_MS] = {1, 250, 250},
+    [PARAM_ECHO_FEEDBACK] = {0, INT16_MAX, FIXED16_LITERAL(0.4)},
+    [PARAM_FILTER_CUTOFF] = {0, INT16_MAX, FIXED16_LITERAL(0.6)},
+    [PARAM_ENVELOPE_PERIOD_MS] = {1, 10000, 150},
+    [PARAM_ENVELOPE_DUTY_CYCLE] = {0, INT16_MAX, FIXED16_LITERAL(0.1)},
+    [PARAM_ENVELOPE_FLOOR] = {0, INT16_MAX, FIXED16_LITERAL(0.2)},
+    [PARAM_LFO_FREQ_MHZ] = {0, 20000, 2000},
+};
+
+/* triple buffer. The writers own one snapshot and the audio context another, the third is the
+ * latest published and is swapped with either side atomically. Neither side ever waits for the other */
+static struct param_snapshot _snapshots[3];
+
+#define _PUBLISHED_INDEX_MASK 0x3
+#define _PUBLISHED_NEW BIT(2)
+
+/* index of the published snapshot, and whether the audio context has adopted it */
+static atomic_t _published;
+static uint8_t _write_index;
+static uint8_t _read_index;
+
+/* values of all parameters as last set, copied whole into each snapshot written */
+static struct param_snapshot _values;
+static struct k_spinlock _write_lock;
+
+/* values of the snapshot adopted last, audio context only. Compared with the next one so only
+ * parameters which changed are applied again */
+static struct param_snapshot _adopted;
+
+void param_store_init(void)
+{
+    for (int i = 0; i < PARAM_NUM; i++) {
+        _values.values[i] = _ranges[i].init;
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(_snapshots); i++) {
+        _snapshots[i] = _values;
+    }
+
+    _adopted = _values;
+
+    _write_index = 0;
+    _read_index = 1;
+    atomic_set(&_published, 2);
+}
+
+int param_store_set(enum param param, int32_t value)
+{
+    if (param < 0 || param >= PARAM_NUM) {
+        return -EINVAL;
+    }
+    if (value < _ranges[param].min || value > _ranges[param].max) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&_write_lock);
+
+    _values.values[param] = value;
+    _snapshots[_write_index] = _values;
+
+    /* the previously published snapshot is written next, unless the audio context took it */
+    const atomic_val_t previous = atomic_set(&_published, _write_index | _PUBLISHED_NEW);
+    _write_index = previous & _PUBLISHED_INDEX_MASK;
+
+    k_spin_unlock(&_write_lock, key);
+
+    return 0;
+}
+
+uint32_t param_store_acquire(void)
+{
+    if ((atomic_get(&_published) & _PUBLISHED_NEW) == 0) {
+        return 0;
+    }
+
+    /* a snapshot published since the check is taken as well */
+    const atomic_val_t previous = atomic_set(&_published, _read_index);
+    _read_index = previous & _PUBLISHED_INDEX_MASK;
+
+    /* several writes may have been published since the last call, only the values are compared */
+    uint32_t changed = 0;
+    for (int i = 0; i < PARAM_NUM; i++) {
+        if (_snapshots[_read_index].values[i] != _adopted.values[i]) {
+            changed |= PARAM_MASK(i);
+        }
+    }
+    _adopted = _snapshots[_read_index];
+
+    return changed;
+}
+
+int32_t param_store_get(enum param param)
+{
+    __ASSERT(param >= 0 && param < PARAM_NUM, "parameter out of range");
+
+    return _adopted.values[param];
+}
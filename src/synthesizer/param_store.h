@@ -0,0 +1,50 @@
+/**
+ * @file param_store.h
+ * @author Rein Gundersen Bentdal
+ * @brief Synthesizer parameters changed from other threads than audio processing. Writers publish
+ *  complete snapshots which the audio context adopts at block boundaries, without locks on its side
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PARAM_STORE_H_
+#define _PARAM_STORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* setters of the DSP modules are not thread safe, and are only called from the audio context. Other
+ * threads, such as shell, MIDI or Bluetooth control, change parameters through the store */
+enum param {
+    PARAM_ECHO_DELAY_MS,        /* [1, 250] */
+    PARAM_ECHO_FEEDBACK,        /* fixed16 in [0, 1], ramped across each control period */
+    PARAM_FILTER_CUTOFF,        /* fixed16 in [0, 1], ramped across each control period */
+    PARAM_ENVELOPE_PERIOD_MS,   /* [1, 10000] */
+    PARAM_ENVELOPE_DUTY_CYCLE,  /* fixed16 in [0, 1] */
+    PARAM_ENVELOPE_FLOOR,       /* fixed16 in [0, 1] */
+    PARAM_LFO_FREQ_MHZ,         /* [0, 20000], rate of the voice LFO, phase continuous */
+    PARAM_NUM,
+};
+
+/* bit of each parameter in the masks returned by param_store_acquire */
+#define PARAM_MASK(param) (1UL << (param))
+#define PARAM_MASK_ALL (PARAM_MASK(PARAM_NUM) - 1)
+
+/* sets all parameters to their defaults, before audio processing is started */
+void param_store_init(void);
+
+/* publishes the value in a new snapshot. May be called from any thread or ISR, writers are only
+ * serialized among themselves. Returns -EINVAL for unknown parameters or values out of range */
+int param_store_set(enum param param, int32_t value);
+
+/* audio context only. Adopts the latest published snapshot, returns the PARAM_MASK of each parameter
+ * whose value differs from the snapshot adopted by the last call, 0 if none */
+uint32_t param_store_acquire(void);
+
+/* value in the snapshot adopted by the last param_store_acquire, audio context only */
+int32_t param_store_get(enum param param);
+
+#endif
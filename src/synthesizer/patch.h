@@ -0,0 +1,37 @@
+/**
+ * @file patch.h
+ * @author Rein Gundersen Bentdal
+ * @brief Voice and bus chain compiled from a patch description, generated by scripts/patch.py.
+ *  Voices are unrolled for CONFIG_MAX_NOTES, the lowpass, allpass and pan kernels are inlined with literal
+ *  coefficients, and parameters given as "param" follow the parameter store
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PATCH_H_
+#define _PATCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "integer_math.h"
+#include "dsp/stereo.h"
+
+/* after param_store_init, applies the parameters of the store once */
+void patch_init(void);
+
+/* audio context only, with the mask returned by param_store_acquire */
+void patch_params_apply(uint32_t changed);
+
+void patch_note_on(int voice, uint32_t phase_increment, fixed16 amplitude);
+void patch_note_off(int voice);
+
+/* adds all active voices to the block */
+void patch_voices_process(stereo16* block, size_t block_size);
+
+void patch_bus_process(stereo16* block, size_t block_size);
+
+#endif
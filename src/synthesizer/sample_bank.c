@@ -0,0 +1,138 @@
+#include "sample_bank.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "pitch_table.h"
+
+#if CONFIG_FLASH_SIMULATOR
+#include <zephyr/drivers/flash/flash_simulator.h>
+#endif
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sample_bank, CONFIG_LOG_SAMPLE_BANK_LEVEL);
+
+BUILD_ASSERT(sizeof(struct sample_bank_header) == 8, "sample bank header layout");
+BUILD_ASSERT(sizeof(struct sample_bank_entry) == 24, "sample bank entry layout");
+
+static const uint8_t* _base;
+static size_t _size;
+static const struct sample_bank_header* _header;
+static const struct sample_bank_entry* _entries;
+
+static int _map_partition(void);
+
+int sample_bank_init(void)
+{
+    int ret;
+
+    ret = _map_partition();
+    if (ret != 0) {
+        return ret;
+    }
+
+    _header = (const struct sample_bank_header*)_base;
+
+    if (_size < sizeof(*_header) || _header->magic != SAMPLE_BANK_MAGIC) {
+        LOG_WRN("no sample bank found in flash");
+        _header = NULL;
+        return -ENOENT;
+    }
+
+    if (_header->version != SAMPLE_BANK_VERSION) {
+        LOG_ERR("unsupported sample bank version %u", _header->version);
+        _header = NULL;
+        return -ENOTSUP;
+    }
+
+    _entries = (const struct sample_bank_entry*)(_header + 1);
+
+    if (sizeof(*_header) + _header->count * sizeof(*_entries) > _size) {
+        LOG_ERR("sample table out of partition bounds");
+        _header = NULL;
+        return -EINVAL;
+    }
+
+    /* samples are only read in the audio context after this, and are not checked again */
+    for (size_t i = 0; i < _header->count; i++) {
+        const struct sample_bank_entry* entry = &_entries[i];
+        const uint64_t bytes = entry->format == SAMPLE_FORMAT_IMA_ADPCM ? (entry->length + 1ull) / 2 : entry->length * 2ull;
+
+        if ((entry->offset & 3) != 0 || entry->offset + bytes > _size) {
+            LOG_ERR("sample %u out of partition bounds", i);
+            _header = NULL;
+            return -EINVAL;
+        }
+
+        if (entry->length == 0 || entry->root_note >= PITCH_NOTE_NUM || entry->sample_rate_hz == 0) {
+            LOG_ERR("sample %u is invalid", i);
+            _header = NULL;
+            return -EINVAL;
+        }
+
+        if (entry->mode == SAMPLE_MODE_LOOP &&
+            (entry->loop_start >= entry->loop_end || entry->loop_end > entry->length)) {
+            LOG_ERR("sample %u has invalid loop points %u-%u", i, entry->loop_start, entry->loop_end);
+            _header = NULL;
+            return -EINVAL;
+        }
+    }
+
+    LOG_INF("sample bank with %u samples", _header->count);
+
+    return 0;
+}
+
+size_t sample_bank_count(void)
+{
+    return _header == NULL ? 0 : _header->count;
+}
+
+int sample_bank_get(size_t index, struct sample* sample)
+{
+    __ASSERT_NO_MSG(sample != NULL);
+
+    if (index >= sample_bank_count()) {
+        return -ENOENT;
+    }
+
+    const struct sample_bank_entry* entry = &_entries[index];
+
+    *sample = (struct sample) {
+        .data = _base + entry->offset,
+        .length = entry->length,
+        .loop_start = entry->loop_start,
+        .loop_end = entry->loop_end,
+        .sample_rate_hz = entry->sample_rate_hz,
+        .root_note = entry->root_note,
+        .format = entry->format,
+        .mode = entry->mode,
+    };
+
+    return 0;
+}
+
+static int _map_partition(void)
+{
+    const struct flash_area* area;
+
+    int ret = flash_area_open(FLASH_AREA_ID(sample_partition), &area);
+    if (ret != 0) {
+        LOG_ERR("failed to open sample partition: %d", ret);
+        return ret;
+    }
+
+#if CONFIG_FLASH_SIMULATOR
+    /* the simulated flash is backed by RAM, or a file mapped into memory */
+    size_t simulator_size;
+    const uint8_t* memory = flash_simulator_get_memory(DEVICE_DT_GET(DT_INST(0, zephyr_sim_flash)), &simulator_size);
+    _base = memory + area->fa_off;
+#else
+    _base = (const uint8_t*)(CONFIG_SYNTH_SAMPLE_BANK_XIP_BASE + area->fa_off);
+#endif
+    _size = area->fa_size;
+
+    flash_area_close(area);
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file sample_bank.h
+ * @author Rein Gundersen Bentdal
+ * @brief Samples stored in the flash partition sample_partition, built by scripts/sample_bank.py.
+ *  Audio data is read in place through the memory mapping of the flash and never copied to RAM
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SAMPLE_BANK_H_
+#define _SAMPLE_BANK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+
+#include "dsp/sample_player.h"
+
+#define SAMPLE_BANK_MAGIC 0x4B4E4253 /* "SBNK" */
+#define SAMPLE_BANK_VERSION 1
+
+/* layout in flash, little endian. The header is followed by count entries */
+struct sample_bank_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+};
+
+struct sample_bank_entry {
+    /* from the start of the partition, 4 byte aligned */
+    uint32_t offset;
+
+    uint32_t length;
+    uint32_t loop_start;
+    uint32_t loop_end;
+    uint32_t sample_rate_hz;
+
+    uint8_t format;
+    uint8_t mode;
+    uint8_t root_note;
+    uint8_t reserved;
+};
+
+#if CONFIG_SYNTH_SAMPLE_BANK
+
+/* maps the partition and validates the header. Returns negative errno on failure */
+int sample_bank_init(void);
+
+size_t sample_bank_count(void);
+
+/* fills in a sample pointing into flash. Returns -ENOENT if index is out of range */
+int sample_bank_get(size_t index, struct sample* sample);
+
+#else
+
+static inline int sample_bank_init(void) { return -ENOTSUP; }
+static inline size_t sample_bank_count(void) { return 0; }
+static inline int sample_bank_get(size_t index, struct sample* sample) { return -ENOTSUP; }
+
+#endif
+
+#endif
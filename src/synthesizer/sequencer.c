@@ -0,0 +1,458 @@
+#include "sequencer.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+#include <zephyr/storage/flash_map.h>
+
+#if CONFIG_FLASH_SIMULATOR
+#include <zephyr/drivers/flash/flash_simulator.h>
+#endif
+
+#include "event_calendar.h"
+#include "param_store.h"
+#include "synthesizer.h"
+#include "velocity_curve.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sequencer, CONFIG_LOG_SEQUENCER_LEVEL);
+
+BUILD_ASSERT(sizeof(struct sequencer_header) == 12, "sequencer header layout");
+BUILD_ASSERT(sizeof(struct sequencer_pattern_header) == 8, "sequencer pattern header layout");
+BUILD_ASSERT(PARAM_NUM <= 32, "locked parameters are tracked in one word");
+
+#define _EVENTS_MAX CONFIG_SYNTH_SEQUENCER_STEP_EVENTS
+
+struct _event {
+    uint8_t flags;
+    uint8_t note;
+    uint8_t velocity;
+    uint8_t gate;
+    uint8_t param;
+    int16_t value;
+};
+
+/* a step decoded from flash, with what it needs of its pattern */
+struct _step {
+    struct _event events[_EVENTS_MAX];
+    uint8_t count;
+    uint8_t ticks;
+    uint16_t drum_tracks;
+};
+
+static const uint8_t* _base;
+static size_t _size;
+static const struct sequencer_header* _header;
+static const uint32_t* _pattern_offsets;
+static const uint8_t* _song;
+
+static struct keys* _keys;
+
+/* commands from other threads, taken by the tick */
+#define _COMMAND_START BIT(0)
+#define _COMMAND_STOP BIT(1)
+static atomic_t _commands;
+
+/* tick context */
+static bool _playing;
+static uint32_t _tick_count;
+static uint8_t _step_ticks;
+
+static uint16_t _song_position;
+static const uint8_t* _cursor;
+static uint16_t _steps_left;
+static const struct sequencer_pattern_header* _pattern;
+static struct _step _next;
+
+static uint32_t _locked;
+static int32_t _lock_base[PARAM_NUM];
+
+/* counted up by each stop. Events scheduled before are ignored when due, and what they left sounding or locked
+ * is released by the stop instead */
+static uint8_t _generation;
+
+/* notes of melodic tracks sounding */
+static uint32_t _notes[128 / 32];
+
+static int _map_partition(void);
+static int _pattern_validate(size_t index);
+static const struct sequencer_pattern_header* _pattern_get(size_t index);
+static const uint8_t* _step_decode(const uint8_t* cursor, struct _step* step);
+static void _next_decode(void);
+static void _step_play(const struct _step* step);
+static void _locks_release(uint32_t locks);
+static void _playback_stop(void);
+static void _note_event_handle(const struct calendar_event* event);
+static void _drum_event_handle(const struct calendar_event* event);
+static void _param_event_handle(const struct calendar_event* event);
+
+int sequencer_init(struct keys* keys)
+{
+    __ASSERT_NO_MSG(keys != NULL);
+
+    int ret;
+
+    _keys = keys;
+    _playing = false;
+    _locked = 0;
+    memset(_notes, 0, sizeof(_notes));
+    atomic_clear(&_commands);
+
+    ret = _map_partition();
+    if (ret != 0) {
+        return ret;
+    }
+
+    _header = (const struct sequencer_header*)_base;
+
+    if (_size < sizeof(*_header) || _header->magic != SEQUENCER_MAGIC) {
+        LOG_WRN("no patterns found in flash");
+        _header = NULL;
+        return -ENOENT;
+    }
+
+    if (_header->version != SEQUENCER_VERSION) {
+        LOG_ERR("unsupported pattern version %u", _header->version);
+        _header = NULL;
+        return -ENOTSUP;
+    }
+
+    _pattern_offsets = (const uint32_t*)(_header + 1);
+    _song = (const uint8_t*)(_pattern_offsets + _header->pattern_count);
+
+    if (_header->pattern_count == 0 || _song + _header->song_length > _base + _size) {
+        LOG_ERR("pattern table out of partition bounds");
+        _header = NULL;
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < _header->song_length; i++) {
+        if (_song[i] >= _header->pattern_count) {
+            LOG_ERR("song position %u plays missing pattern %u", i, _song[i]);
+            _header = NULL;
+            return -EINVAL;
+        }
+    }
+
+    /* steps are only decoded in the audio context after this, and are not checked again */
+    for (size_t i = 0; i < _header->pattern_count; i++) {
+        ret = _pattern_validate(i);
+        if (ret != 0) {
+            _header = NULL;
+            return ret;
+        }
+    }
+
+    LOG_INF("%u patterns, song of %u", _header->pattern_count, _header->song_length);
+
+    return 0;
+}
+
+void sequencer_start(void)
+{
+    atomic_or(&_commands, _COMMAND_START);
+}
+
+void sequencer_stop(void)
+{
+    atomic_or(&_commands, _COMMAND_STOP);
+}
+
+void sequencer_tick(void)
+{
+    const atomic_val_t commands = atomic_clear(&_commands);
+
+    /* a start while playing stops first, so the song starts over from silence */
+    if ((commands & _COMMAND_STOP) || ((commands & _COMMAND_START) && _playing)) {
+        _playback_stop();
+    }
+
+    if ((commands & _COMMAND_START) && _header != NULL) {
+        _playing = true;
+        _tick_count = 0;
+        _song_position = 0;
+        _pattern = _pattern_get(_header->song_length > 0 ? _song[0] : 0);
+        _cursor = (const uint8_t*)(_pattern + 1);
+        _steps_left = _pattern->steps;
+        _next_decode();
+    }
+
+    if (!_playing) {
+        return;
+    }
+
+    if (_tick_count == 0) {
+        _step_play(&_next);
+        _step_ticks = _next.ticks;
+
+        /* decoded now, so the flash is read a whole step before the notes are due */
+        _next_decode();
+    }
+
+    _tick_count++;
+    if (_tick_count >= _step_ticks) {
+        _tick_count = 0;
+    }
+}
+
+static int _pattern_validate(size_t index)
+{
+    const uint32_t offset = _pattern_offsets[index];
+
+    if ((offset & 3) != 0 || offset + sizeof(struct sequencer_pattern_header) > _size) {
+        LOG_ERR("pattern %u out of partition bounds", index);
+        return -EINVAL;
+    }
+
+    const struct sequencer_pattern_header* pattern = _pattern_get(index);
+    const uint8_t* cursor = (const uint8_t*)(pattern + 1);
+    const uint8_t* end = cursor + pattern->size;
+
+    if (end > _base + _size || pattern->steps == 0 || pattern->ticks_per_step == 0) {
+        LOG_ERR("pattern %u is invalid", index);
+        return -EINVAL;
+    }
+
+    for (size_t step = 0; step < pattern->steps; step++) {
+        if (cursor >= end || *cursor > _EVENTS_MAX) {
+            LOG_ERR("pattern %u step %u is invalid or has more than %u events", index, step, _EVENTS_MAX);
+            return -EINVAL;
+        }
+
+        const size_t count = *cursor++;
+        for (size_t i = 0; i < count; i++) {
+            if (cursor >= end) {
+                LOG_ERR("pattern %u step %u is truncated", index, step);
+                return -EINVAL;
+            }
+
+            const uint8_t flags = *cursor++;
+            if (flags & SEQUENCER_EVENT_NOTE) {
+                if (cursor + 3 > end || cursor[0] > 127 || cursor[1] > 127 || cursor[2] == 0) {
+                    LOG_ERR("pattern %u step %u has an invalid note", index, step);
+                    return -EINVAL;
+                }
+                cursor += 3;
+            }
+            if (flags & SEQUENCER_EVENT_LOCK) {
+                if (cursor + 3 > end || cursor[0] >= PARAM_NUM) {
+                    LOG_ERR("pattern %u step %u has an invalid parameter lock", index, step);
+                    return -EINVAL;
+                }
+                cursor += 3;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static const struct sequencer_pattern_header* _pattern_get(size_t index)
+{
+    return (const struct sequencer_pattern_header*)(_base + _pattern_offsets[index]);
+}
+
+static const uint8_t* _step_decode(const uint8_t* cursor, struct _step* step)
+{
+    step->count = *cursor++;
+
+    for (size_t i = 0; i < step->count; i++) {
+        struct _event* event = &step->events[i];
+
+        event->flags = *cursor++;
+        if (event->flags & SEQUENCER_EVENT_NOTE) {
+            event->note = cursor[0];
+            event->velocity = cursor[1];
+            event->gate = cursor[2];
+            cursor += 3;
+        }
+        if (event->flags & SEQUENCER_EVENT_LOCK) {
+            event->param = cursor[0];
+            event->value = (int16_t)(cursor[1] | (cursor[2] << 8));
+            cursor += 3;
+        }
+    }
+
+    return cursor;
+}
+
+/* the step after the last one decoded, moving on to the next pattern of the song */
+static void _next_decode(void)
+{
+    if (_steps_left == 0) {
+        if (_header->song_length > 0) {
+            _song_position++;
+            if (_song_position == _header->song_length) {
+                _song_position = 0;
+            }
+            _pattern = _pattern_get(_song[_song_position]);
+        }
+
+        _cursor = (const uint8_t*)(_pattern + 1);
+        _steps_left = _pattern->steps;
+    }
+
+    _cursor = _step_decode(_cursor, &_next);
+    _next.ticks = _pattern->ticks_per_step;
+    _next.drum_tracks = _pattern->drum_tracks;
+    _steps_left--;
+}
+
+static void _step_play(const struct _step* step)
+{
+    uint32_t locked = 0;
+
+    for (size_t i = 0; i < step->count; i++) {
+        const struct _event* event = &step->events[i];
+        const uint8_t track = event->flags & SEQUENCER_EVENT_TRACK_MASK;
+
+        if (event->flags & SEQUENCER_EVENT_LOCK) {
+            /* the value to return to is the one before the first of consecutive locks */
+            if ((_locked & BIT(event->param)) == 0) {
+                _lock_base[event->param] = param_store_get(event->param);
+            }
+            locked |= BIT(event->param);
+
+            const struct calendar_event lock = {
+                .handler = _param_event_handle,
+                .type = CALENDAR_EVENT_PARAM,
+                .generation = _generation,
+                .param = event->param,
+                .value = event->value,
+            };
+            (void)event_calendar_schedule(0, 0, &lock);
+        }
+
+        if ((event->flags & SEQUENCER_EVENT_NOTE) == 0) {
+            continue;
+        }
+
+        struct calendar_event note = {
+            .handler = _note_event_handle,
+            .type = CALENDAR_EVENT_NOTE_OFF,
+            .generation = _generation,
+            .note = event->note,
+        };
+
+        if (step->drum_tracks & BIT(track)) {
+            note.handler = _drum_event_handle;
+        }
+
+        /* the note off is scheduled first, a full calendar leaves the note out rather than hanging */
+        else if (event_calendar_schedule(event->gate, 0, &note) != 0) {
+            continue;
+        }
+
+        note.type = CALENDAR_EVENT_NOTE_ON;
+        note.velocity = event->velocity;
+        (void)event_calendar_schedule(0, 0, &note);
+    }
+
+    _locks_release(_locked & ~locked);
+    _locked = locked;
+}
+
+static void _locks_release(uint32_t locks)
+{
+    for (; locks != 0; locks &= locks - 1) {
+        const uint8_t param = __builtin_ctz(locks);
+
+        const struct calendar_event release = {
+            .handler = _param_event_handle,
+            .type = CALENDAR_EVENT_PARAM,
+            .generation = _generation,
+            .param = param,
+            .value = _lock_base[param],
+        };
+        (void)event_calendar_schedule(0, 0, &release);
+    }
+}
+
+/* released at once, as the events of this start which would have ended them are ignored from now on */
+static void _playback_stop(void)
+{
+    _playing = false;
+    _generation++;
+
+    for (size_t i = 0; i < ARRAY_SIZE(_notes); i++) {
+        for (uint32_t notes = _notes[i]; notes != 0; notes &= notes - 1) {
+            keys_stop(_keys, i * 32 + __builtin_ctz(notes));
+        }
+
+        _notes[i] = 0;
+    }
+
+    for (uint32_t locks = _locked; locks != 0; locks &= locks - 1) {
+        const uint8_t param = __builtin_ctz(locks);
+
+        (void)param_store_set(param, _lock_base[param]);
+    }
+    _locked = 0;
+}
+
+static void _note_event_handle(const struct calendar_event* event)
+{
+    if (event->generation != _generation) {
+        return;
+    }
+
+    switch (event->type) {
+        case CALENDAR_EVENT_NOTE_ON:
+            keys_play(_keys, event->note, event->velocity);
+            _notes[event->note / 32] |= BIT(event->note % 32);
+            break;
+        case CALENDAR_EVENT_NOTE_OFF:
+            keys_stop(_keys, event->note);
+            _notes[event->note / 32] &= ~BIT(event->note % 32);
+            break;
+        default:
+            break;
+    }
+}
+
+static void _drum_event_handle(const struct calendar_event* event)
+{
+    if (event->generation != _generation) {
+        return;
+    }
+
+    const enum drum_type type = drum_type_from_note(event->note);
+
+    if (type != DRUM_TYPE_NUM) {
+        synthesizer_drum_hit(type, velocity_curve[event->velocity]);
+    }
+}
+
+static void _param_event_handle(const struct calendar_event* event)
+{
+    if (event->generation != _generation) {
+        return;
+    }
+
+    (void)param_store_set(event->param, event->value);
+}
+
+static int _map_partition(void)
+{
+    const struct flash_area* area;
+
+    int ret = flash_area_open(FLASH_AREA_ID(pattern_partition), &area);
+    if (ret != 0) {
+        LOG_ERR("failed to open pattern partition: %d", ret);
+        return ret;
+    }
+
+#if CONFIG_FLASH_SIMULATOR
+    /* the simulated flash is backed by RAM, or a file mapped into memory */
+    size_t simulator_size;
+    const uint8_t* memory = flash_simulator_get_memory(DEVICE_DT_GET(DT_INST(0, zephyr_sim_flash)), &simulator_size);
+    _base = memory + area->fa_off;
+#else
+    _base = (const uint8_t*)(CONFIG_SYNTH_SEQUENCER_XIP_BASE + area->fa_off);
+#endif
+    _size = area->fa_size;
+
+    flash_area_close(area);
+
+    return 0;
+}
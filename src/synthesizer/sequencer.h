@@ -0,0 +1,78 @@
+/**
+ * @file sequencer.h
+ * @author Rein Gundersen Bentdal
+ * @brief Step sequencer playing patterns stored in the flash partition pattern_partition, built by
+ *  scripts/sequencer_pattern.py. Patterns are read in place and decoded one step ahead of the tick
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SEQUENCER_H_
+#define _SEQUENCER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+
+#include "key_assign.h"
+
+#define SEQUENCER_MAGIC 0x434E5153 /* "SQNC" */
+#define SEQUENCER_VERSION 1
+
+#define SEQUENCER_TRACKS_MAX 16
+
+/* layout in flash, little endian. The header is followed by pattern_count offsets of the patterns, as
+ * uint32_t from the start of the partition, and song_length pattern indices as uint8_t. Without a song,
+ * the first pattern is looped */
+struct sequencer_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t pattern_count;
+    uint16_t song_length;
+    uint16_t reserved;
+};
+
+/* 4 byte aligned, followed by size bytes of steps */
+struct sequencer_pattern_header {
+    uint16_t steps;
+    uint16_t size;
+    uint16_t drum_tracks;       /* tracks playing the percussion voices, one bit for each */
+    uint8_t ticks_per_step;
+    uint8_t reserved;
+};
+
+/* each step is a count byte and count events. An event starts with a byte of the track and flags,
+ * followed by note, velocity and gate in ticks with SEQUENCER_EVENT_NOTE, and by the parameter and a
+ * little endian int16_t value with SEQUENCER_EVENT_LOCK. Locked parameters return to their value when
+ * a step without the lock is played */
+#define SEQUENCER_EVENT_TRACK_MASK 0x0F
+#define SEQUENCER_EVENT_NOTE BIT(4)
+#define SEQUENCER_EVENT_LOCK BIT(5)
+
+#if CONFIG_SYNTH_SEQUENCER
+
+/* maps the partition and validates all patterns. Notes of melodic tracks are played on the voices
+ * assigned by keys. Returns negative errno on failure */
+int sequencer_init(struct keys* keys);
+
+/* from the start of the song, at the next tick. While playing, the notes and locks held are released first.
+ * May be called from any thread */
+void sequencer_start(void);
+void sequencer_stop(void);
+
+/* once for each tick, from the audio processing context */
+void sequencer_tick(void);
+
+#else
+
+static inline int sequencer_init(struct keys* keys) { return -ENOTSUP; }
+static inline void sequencer_start(void) {}
+static inline void sequencer_stop(void) {}
+static inline void sequencer_tick(void) {}
+
+#endif
+
+#endif
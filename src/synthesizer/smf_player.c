@@ -0,0 +1,208 @@
+#include "smf_player.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+
+#include "event_calendar.h"
+#include "tick_provider.h"
+#include "synthesizer.h"
+#include "velocity_curve.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(smf_player, CONFIG_LOG_SMF_PLAYER_LEVEL);
+
+BUILD_ASSERT(sizeof(struct smf_event) == 8, "smf event layout");
+
+static struct keys* _keys;
+
+/* commands from other threads, taken by the tick */
+#define _COMMAND_START BIT(0)
+#define _COMMAND_STOP BIT(1)
+static atomic_t _commands;
+
+/* tick context */
+static bool _playing;
+static uint32_t _tick;
+static size_t _cursor;
+
+/* notes on the voices once the events scheduled so far are applied, released when playback ends. One bit
+ * per note */
+static uint32_t _notes[128 / 32];
+
+static void _event_schedule(const struct smf_event* event, uint32_t ticks, uint32_t tick_frames);
+static void _notes_release(void);
+static void _event_handle(const struct calendar_event* event);
+
+int smf_player_init(struct keys* keys)
+{
+    __ASSERT_NO_MSG(keys != NULL);
+
+    _keys = keys;
+    _playing = false;
+    memset(_notes, 0, sizeof(_notes));
+    atomic_clear(&_commands);
+
+    if (smf_event_count == 0) {
+        LOG_WRN("song has no events");
+        return -ENOENT;
+    }
+
+    LOG_INF("%u events, %u ticks", smf_event_count, smf_song_ticks);
+
+    return 0;
+}
+
+void smf_player_start(void)
+{
+    atomic_or(&_commands, _COMMAND_START);
+}
+
+void smf_player_stop(void)
+{
+    atomic_or(&_commands, _COMMAND_STOP);
+}
+
+void smf_player_tick(void)
+{
+    const atomic_val_t commands = atomic_clear(&_commands);
+
+    if (commands & _COMMAND_STOP) {
+        _playing = false;
+        _notes_release();
+    }
+
+    if ((commands & _COMMAND_START) && smf_event_count > 0) {
+        _playing = true;
+        _tick = 0;
+        _cursor = 0;
+    }
+
+    if (!_playing) {
+        return;
+    }
+
+    /* events between ticks keep their place in the tick, at the tempo of the last block */
+    const uint32_t tick_frames = tick_provider_tick_frames();
+
+    while (_cursor < smf_event_count && smf_events[_cursor].tick <= _tick) {
+        _event_schedule(&smf_events[_cursor++], 0, tick_frames);
+    }
+
+    _tick++;
+    if (_tick < smf_song_ticks) {
+        return;
+    }
+
+    /* events at the very end of the song, such as the last note offs, are due with the first tick of the next
+     * pass. Scheduled now, they are applied before its events */
+    while (_cursor < smf_event_count) {
+        _event_schedule(&smf_events[_cursor++], 1, tick_frames);
+    }
+
+    _tick = 0;
+    _cursor = 0;
+
+    if (!IS_ENABLED(CONFIG_SYNTH_SMF_LOOP)) {
+        _playing = false;
+        _notes_release();
+    }
+}
+
+static void _event_schedule(const struct smf_event* event, uint32_t ticks, uint32_t tick_frames)
+{
+    const struct calendar_event scheduled = {
+        .handler = _event_handle,
+        .type = CALENDAR_EVENT_MIDI,
+        .midi = {
+            .status = event->status,
+            .data = { event->data[0], event->data[1] },
+        },
+    };
+
+    if (event_calendar_schedule(ticks, (event->fraction * tick_frames) >> SMF_FRACTION_SHIFT, &scheduled) != 0) {
+        return;
+    }
+
+    /* tracked as scheduled, so notes still pending when playback ends are released after them */
+    if ((event->status & 0x0F) == SMF_DRUM_CHANNEL) {
+        return;
+    }
+
+    const uint8_t type = event->status & 0xF0;
+    const uint8_t note = event->data[0];
+
+    if (type == MIDI_NOTE_ON) {
+        _notes[note / 32] |= BIT(note % 32);
+    } else if (type == MIDI_NOTE_OFF) {
+        _notes[note / 32] &= ~BIT(note % 32);
+    }
+}
+
+static void _notes_release(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(_notes); i++) {
+        for (uint32_t notes = _notes[i]; notes != 0; notes &= notes - 1) {
+            const struct calendar_event release = {
+                .handler = _event_handle,
+                .type = CALENDAR_EVENT_MIDI,
+                .midi = {
+                    .status = MIDI_NOTE_OFF,
+                    .data = { i * 32 + __builtin_ctz(notes), 0 },
+                },
+            };
+
+            /* after the events of the current tick, which may be due at any frame of it */
+            (void)event_calendar_schedule(1, 0, &release);
+        }
+
+        _notes[i] = 0;
+    }
+}
+
+static void _event_handle(const struct calendar_event* event)
+{
+    const uint8_t status = event->midi.status;
+    const uint8_t* data = event->midi.data;
+
+    if (status == SMF_EVENT_TEMPO) {
+        /* ignored by the tick provider while it follows an external clock */
+        tick_provider_set_bpm_milli(((data[0] | (data[1] << 8)) * 1000) >> SMF_TEMPO_SHIFT);
+        return;
+    }
+
+    const uint8_t type = status & 0xF0;
+    const uint8_t channel = status & 0x0F;
+
+    if (channel == SMF_DRUM_CHANNEL) {
+        if (type == MIDI_NOTE_ON) {
+            const enum drum_type drum = drum_type_from_note(data[0]);
+            if (drum != DRUM_TYPE_NUM) {
+                synthesizer_drum_hit(drum, velocity_curve[data[1]]);
+            }
+        }
+        return;
+    }
+
+    switch (type) {
+        case MIDI_NOTE_ON:
+            keys_play(_keys, data[0], data[1]);
+            break;
+        case MIDI_NOTE_OFF:
+            keys_stop(_keys, data[0]);
+            break;
+        case MIDI_CONTROL_CHANGE:
+        case MIDI_PITCH_BEND: {
+            /* the same controllers as from the MIDI input */
+            const struct midi_message message = {
+                .type = type,
+                .channel = channel,
+                .data = { data[0], data[1] },
+            };
+            synthesizer_midi_event(&message);
+            break;
+        }
+        default:
+            break;
+    }
+}
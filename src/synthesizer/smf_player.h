@@ -0,0 +1,65 @@
+/**
+ * @file smf_player.h
+ * @author Rein Gundersen Bentdal
+ * @brief Plays a standard MIDI file converted at build time by scripts/smf.py to a flat array of events
+ *  sorted by tick. The tick only moves a cursor through the array, nothing is parsed while playing
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SMF_PLAYER_H_
+#define _SMF_PLAYER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+
+#include "key_assign.h"
+
+/* status of a tempo change, data is the tempo in 1/256 bpm, little endian */
+#define SMF_EVENT_TEMPO 0xFF
+#define SMF_TEMPO_SHIFT 8
+
+/* fraction of a tick the event is past its tick, in 1/256 */
+#define SMF_FRACTION_SHIFT 8
+
+/* notes on this channel, 10 counted from 1, play the percussion voices */
+#define SMF_DRUM_CHANNEL 9
+
+struct smf_event {
+    uint32_t tick;
+    uint8_t fraction;
+    uint8_t status;             /* MIDI status byte with the channel, or SMF_EVENT_TEMPO */
+    uint8_t data[2];
+};
+
+/* generated from CONFIG_SYNTH_SMF_FILE, sorted by time */
+extern const struct smf_event smf_events[];
+extern const size_t smf_event_count;
+extern const uint32_t smf_song_ticks;
+
+#if CONFIG_SYNTH_SMF_PLAYER
+
+/* notes of melodic channels are played on the voices assigned by keys. Returns negative errno on failure */
+int smf_player_init(struct keys* keys);
+
+/* from the start of the song, at the next tick. May be called from any thread */
+void smf_player_start(void);
+void smf_player_stop(void);
+
+/* once for each tick, from the audio processing context */
+void smf_player_tick(void);
+
+#else
+
+static inline int smf_player_init(struct keys* keys) { return -ENOTSUP; }
+static inline void smf_player_start(void) {}
+static inline void smf_player_stop(void) {}
+static inline void smf_player_tick(void) {}
+
+#endif
+
+#endif
@@ -1,17 +1,36 @@
 #include "synthesizer.h"
 
 #include <zephyr/kernel.h>
+#include <string.h>
 
 #include "dsp_instructions.h"
-#include "midi_note_to_frequency.h"
+#include "pitch_table.h"
 #include "integer_math.h"
+#include "lfsr.h"
 
 #include "arpeggio.h"
+#include "sequencer.h"
+#include "smf_player.h"
 #include "dsp/oscillator.h"
 #include "dsp/effect_modulation.h"
+#include "dsp/effect_drift.h"
 #include "dsp/effect_envelope.h"
 #include "dsp/effect_echo.h"
 #include "dsp/filter_allpass.h"
+#include "dsp/filter_lowpass.h"
+#include "dsp/modulation_matrix.h"
+#include "dsp/control_rate.h"
+#include "dsp/wavetable.h"
+#include "dsp/fm_voice.h"
+#include "dsp/pluck_voice.h"
+#include "dsp/sample_player.h"
+#include "dsp/unison_osc.h"
+#include "dsp/stereo.h"
+#include "dsp/graph.h"
+#include "patch.h"
+#include "param_store.h"
+#include "sample_bank.h"
+#include "velocity_curve.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(dsp, CONFIG_LOG_DSP_LEVEL);
@@ -22,24 +41,177 @@ static const uint8_t key_map[] = {NOTE_BASE-3-12, NOTE_BASE+2, NOTE_BASE+6, NOTE
 static struct oscillator _osciillators[CONFIG_MAX_NOTES];
 static struct effect_modulation _modulation[CONFIG_MAX_NOTES];
 static struct effect_envelope _envelopes[CONFIG_MAX_NOTES];
-
-#define _ECHO_BUF_SIZE 24000
-static fixed16 _echo_buf[_ECHO_BUF_SIZE];
+static struct effect_modulation _vibrato[CONFIG_MAX_NOTES];
+static struct effect_drift _drift[CONFIG_MAX_NOTES];
+static struct filter_lowpass _lowpass[CONFIG_MAX_NOTES];
+static struct wavetable_osc _wavetables[CONFIG_MAX_NOTES];
+static struct fm_voice _fm_voices[CONFIG_MAX_NOTES];
+static struct pluck_voice _plucks[CONFIG_MAX_NOTES];
+static struct sample_player _samples[CONFIG_MAX_NOTES];
+static struct unison_osc _unisons[CONFIG_MAX_NOTES];
+static uint16_t _voice_sample[CONFIG_MAX_NOTES];
+static stereo16 _voice_pan_gains[CONFIG_MAX_NOTES];
+
+static struct drum_voice _drums[CONFIG_SYNTH_DRUM_VOICES];
+static stereo16 _drum_pan_gains;
+
+static enum voice_type _voice_type[CONFIG_MAX_NOTES];
+static enum voice_type _voice_type_next[CONFIG_MAX_NOTES];
+
+#if CONFIG_SYNTH_VOICE_WAVETABLE
+#define _VOICE_TYPE_DEFAULT VOICE_TYPE_WAVETABLE
+#elif CONFIG_SYNTH_VOICE_FM
+#define _VOICE_TYPE_DEFAULT VOICE_TYPE_FM
+#elif CONFIG_SYNTH_VOICE_PLUCK
+#define _VOICE_TYPE_DEFAULT VOICE_TYPE_PLUCK
+#elif CONFIG_SYNTH_VOICE_SAMPLE
+#define _VOICE_TYPE_DEFAULT VOICE_TYPE_SAMPLE
+#elif CONFIG_SYNTH_VOICE_UNISON
+#define _VOICE_TYPE_DEFAULT VOICE_TYPE_UNISON
+#else
+#define _VOICE_TYPE_DEFAULT VOICE_TYPE_OSCILLATOR
+#endif
+
+/* fm operator setup, operator 0 is the carrier and the rest are stacked on top of it */
+struct fm_operator_config {
+    float ratio;
+    fixed16 index;
+    float attack_ms;
+    float decay_ms;
+    fixed16 sustain;
+};
+
+static const struct fm_operator_config _fm_operators[FM_OPERATORS_MAX] = {
+    {1.0f, FIXED16_LITERAL(1.0), 0.0f, 0.0f, FIXED16_LITERAL(1.0)},
+    {2.0f, FIXED16_LITERAL(0.3), 0.0f, 300.0f, FIXED16_LITERAL(0.3)},
+    {1.0f, FIXED16_LITERAL(0.2), 20.0f, 500.0f, FIXED16_LITERAL(0.5)},
+    {3.0f, FIXED16_LITERAL(0.1), 0.0f, 100.0f, FIXED16_LITERAL(0.0)},
+};
+
+#if !CONFIG_SYNTH_PATCH
+/* 250 ms at the sample rate */
+#define _ECHO_BUF_SIZE (CONFIG_AUDIO_SAMPLE_RATE_HZ / 4)
+static bus_frame _echo_buf[_ECHO_BUF_SIZE];
 static struct effect_echo _echo;
+#endif
+
+/* static modulation routing, shared by all voices */
+static const struct modulation_route _voice_routes[] = {
+    {MODULATION_SOURCE_LFO1, MODULATION_DESTINATION_FILTER_CUTOFF, FIXED16_LITERAL(0.3)},
+    {MODULATION_SOURCE_LFO2, MODULATION_DESTINATION_PITCH, FIXED16_LITERAL(0.004)},
+    {MODULATION_SOURCE_LFO1, MODULATION_DESTINATION_WAVETABLE_MORPH, FIXED16_LITERAL(0.4)},
+    {MODULATION_SOURCE_DRIFT, MODULATION_DESTINATION_PITCH, FIXED16_LITERAL(0.002)},
+    {MODULATION_SOURCE_DRIFT, MODULATION_DESTINATION_AMPLITUDE, FIXED16_LITERAL(0.05)},
+    {MODULATION_SOURCE_VELOCITY, MODULATION_DESTINATION_FILTER_CUTOFF, CONFIG_SYNTH_VELOCITY_CUTOFF_DEPTH * INT16_MAX / 100},
+};
+
+static const struct modulation_route _bus_routes[] = {
+    {MODULATION_SOURCE_LFO1, MODULATION_DESTINATION_ECHO_FEEDBACK, FIXED16_LITERAL(0.1)},
+};
+
+/* cutoff, echo feedback and envelope shape are in param_store */
+#define _VOICE_MORPH FIXED16_LITERAL(0.5)
+
+/* voices are spread evenly between these pan positions */
+#define _VOICE_PAN_SPREAD FIXED16_LITERAL(0.6)
+
+/* assignment of notes to voices, shared by the arpeggiator, the sequencer and the MIDI file player */
+static struct keys _keys;
+
+/* modulation state evaluated at control rate */
+static struct modulation_matrix _voice_matrix[CONFIG_MAX_NOTES];
+static int32_t _voice_pitch[CONFIG_MAX_NOTES];
+static fixed16 _voice_gain[CONFIG_MAX_NOTES];
+
+static struct modulation_matrix _bus_matrix;
+static struct effect_modulation _bus_modulation;
+
+/* controllers mapped to parameters in param_store */
+#define _MIDI_CC_CUTOFF 74
+#define _MIDI_CC_ECHO_FEEDBACK 91
+
+/* controllers setting the arpeggiator, in the range of undefined controllers */
+#define _MIDI_CC_ARPEGGIO_MODE 20
+#define _MIDI_CC_ARPEGGIO_OCTAVES 21
+#define _MIDI_CC_ARPEGGIO_GATE 22
+
+/* pitch bend range in either direction */
+#define _PITCH_BEND_RANGE (2 * PITCH_SEMITONE)
+static int32_t _pitch_bend;
 
 
-static void _play_note(int index, int note);
+static void _play_note(int index, int note, uint8_t velocity);
 static void _stop_note(int index);
-static inline void _audio_stream_add(fixed16* destination, fixed16* source, size_t block_size);
+#if !CONFIG_SYNTH_PATCH
+static inline bool _voice_is_stereo(int index);
+static bool _voice_process(int index, fixed16* block, size_t block_size);
+static bool _voice_process_stereo(int index, stereo16* block, size_t block_size);
+static inline bool _voice_source_process(int index, fixed16* block, size_t block_size);
+static void _voice_modulation_update(int index);
+static void _bus_process(bus_frame* block, size_t block_size);
+static void _params_apply(uint32_t changed);
+#endif
+static inline void _bus_mix(bus_frame* destination, const stereo16* source, size_t block_size);
+static inline void _bus_mix_panned(bus_frame* destination, const fixed16* source, size_t block_size, stereo16 gains);
 
 void synthesizer_init()
 {
-    arpeggio_init(_play_note, _stop_note);
+    if (IS_ENABLED(CONFIG_SYNTH_SAMPLE_BANK)) {
+        const int ret = sample_bank_init();
+        if (ret < 0) {
+            LOG_WRN("sample bank unavailable (%d), sample voices are silent", ret);
+        }
+    }
+
+    param_store_init();
+    (void)param_store_acquire();
+
+    keys_init(&_keys, _play_note, _stop_note);
+
+    arpeggio_init(&_keys);
     arpeggio_set_divider(12);
 
+    if (IS_ENABLED(CONFIG_SYNTH_SEQUENCER)) {
+        const int ret = sequencer_init(&_keys);
+        if (ret == 0) {
+            sequencer_start();
+        } else {
+            LOG_WRN("sequencer unavailable (%d)", ret);
+        }
+    }
+
+    if (IS_ENABLED(CONFIG_SYNTH_SMF_PLAYER)) {
+        const int ret = smf_player_init(&_keys);
+        if (ret == 0) {
+            smf_player_start();
+        } else {
+            LOG_WRN("MIDI file player unavailable (%d)", ret);
+        }
+    }
+
+#if CONFIG_SYNTH_PATCH
+    patch_init();
+#else
+#if CONFIG_SYNTH_BUS_Q31
+    effect_echo_init_q31(&_echo, _echo_buf, ARRAY_SIZE(_echo_buf));
+#else
     effect_echo_init(&_echo, _echo_buf, ARRAY_SIZE(_echo_buf));
-    effect_echo_set_delay(&_echo, 500);
-    effect_echo_set_feedback(&_echo, FLOAT_TO_FIXED16(0.4));
+#endif
+    effect_echo_set_feedback(&_echo, param_store_get(PARAM_ECHO_FEEDBACK));
+#endif
+
+    effect_modulation_init(&_bus_modulation);
+    effect_modulation_set_freq(&_bus_modulation, 0.1f);
+    modulation_matrix_init(&_bus_matrix, _bus_routes, ARRAY_SIZE(_bus_routes));
+
+    for (int i = 0; i < CONFIG_SYNTH_DRUM_VOICES; i++) {
+        drum_voice_init(&_drums[i]);
+    }
+
+#if CONFIG_SYNTH_GRAPH
+    graph_clear();
+#endif
+    _drum_pan_gains = stereo_pan_gains(0);
 
     /* configure parameters of the synthesizer */
     for (int i = 0; i < CONFIG_MAX_NOTES; i++)
@@ -47,17 +219,93 @@ void synthesizer_init()
         osc_init(&_osciillators[i]);
         osc_set_amplitude(&_osciillators[i], FLOAT_TO_FIXED16(0));
 
+        wavetable_osc_init(&_wavetables[i], &wavetable_basic);
+        wavetable_osc_set_amplitude(&_wavetables[i], FLOAT_TO_FIXED16(0));
+
+        fm_voice_init(&_fm_voices[i], CONFIG_SYNTH_FM_OPERATORS, FM_ALGORITHM_STACK);
+        fm_voice_set_amplitude(&_fm_voices[i], FLOAT_TO_FIXED16(0));
+        for (int op = 0; op < CONFIG_SYNTH_FM_OPERATORS; op++) {
+            const struct fm_operator_config* config = &_fm_operators[op];
+            fm_voice_set_operator(&_fm_voices[i], op, config->ratio, config->index);
+            fm_voice_set_operator_envelope(&_fm_voices[i], op, config->attack_ms, config->decay_ms, config->sustain);
+        }
+
+        pluck_voice_init(&_plucks[i]);
+        sample_player_init(&_samples[i]);
+        unison_osc_init(&_unisons[i]);
+        _voice_sample[i] = 0;
+
+        _voice_type[i] = _VOICE_TYPE_DEFAULT;
+        _voice_type_next[i] = _VOICE_TYPE_DEFAULT;
+
+        const fixed16 pan = CONFIG_MAX_NOTES > 1 ? -_VOICE_PAN_SPREAD + 2 * _VOICE_PAN_SPREAD * i / (CONFIG_MAX_NOTES - 1) : 0;
+        synthesizer_set_voice_pan(i, pan);
+
         effect_modulation_init(&_modulation[i]);
-        effect_modulation_set_amplitude(&_modulation[i], 0.7f);
-        effect_modulation_set_freq(&_modulation[i], 2);
+        effect_modulation_set_amplitude(&_modulation[i], FLOAT_TO_UFIXED16(1.0f));
+
+        effect_modulation_init(&_vibrato[i]);
+        effect_modulation_set_freq(&_vibrato[i], 5);
+
+        /* independent drift for each voice */
+        effect_drift_init(&_drift[i], LFSR_SEED + i);
+        effect_drift_set_rate(&_drift[i], 2.0f);
+
+        filter_lowpass_init(&_lowpass[i]);
+        filter_lowpass_set_cutoff(&_lowpass[i], param_store_get(PARAM_FILTER_CUTOFF));
+
+        modulation_matrix_init(&_voice_matrix[i], _voice_routes, ARRAY_SIZE(_voice_routes));
+        _voice_pitch[i] = 0;
+        _voice_gain[i] = INT16_MAX;
 
         effect_envelope_init(&_envelopes[i]);
-        effect_envelope_set_period(&_envelopes[i], 150);
-        effect_envelope_set_duty_cycle(&_envelopes[i], 0.1f);
         effect_envelope_set_mode(&_envelopes[i], ENVELOPE_MODE_ONE_SHOT);
-        effect_envelope_set_floor(&_envelopes[i], 0.2f);
         effect_envelope_set_fade_out_attenuation(&_envelopes[i], 0.04f);
     }
+
+#if !CONFIG_SYNTH_PATCH
+    /* echo delay, envelope shape and LFO rate */
+    _params_apply(PARAM_MASK_ALL);
+#endif
+}
+
+void synthesizer_set_voice_type(int index, enum voice_type type)
+{
+    __ASSERT(index >= 0 && index < CONFIG_MAX_NOTES, "voice index out of range");
+
+    _voice_type_next[index] = type;
+}
+
+void synthesizer_set_voice_sample(int index, uint16_t sample)
+{
+    __ASSERT(index >= 0 && index < CONFIG_MAX_NOTES, "voice index out of range");
+
+    _voice_sample[index] = sample;
+}
+
+void synthesizer_set_voice_pan(int index, fixed16 pan)
+{
+    __ASSERT(index >= 0 && index < CONFIG_MAX_NOTES, "voice index out of range");
+
+    _voice_pan_gains[index] = stereo_pan_gains(pan);
+}
+
+void synthesizer_drum_hit(enum drum_type type, fixed16 level)
+{
+    __ASSERT(type < DRUM_TYPE_NUM, "drum type out of range");
+
+    struct drum_voice* voice = &_drums[0];
+    for (int i = 0; i < CONFIG_SYNTH_DRUM_VOICES; i++) {
+        if (!_drums[i].active) {
+            voice = &_drums[i];
+            break;
+        }
+        if (_drums[i].amplitude < voice->amplitude) {
+            voice = &_drums[i];
+        }
+    }
+
+    drum_voice_trigger(voice, type, level);
 }
 
 void synthesizer_key_event(struct button_event* button_event) {
@@ -68,7 +316,7 @@ void synthesizer_key_event(struct button_event* button_event) {
             __ASSERT(button_event->index <= ARRAY_SIZE(key_map), "button index out of range");
 
             const uint8_t note = key_map[button_event->index];
-            arpeggio_note_add(note);
+            arpeggio_note_add(note, VELOCITY_DEFAULT);
 
             LOG_DBG("button %u pressed", button_event->index);
 
@@ -87,11 +335,60 @@ void synthesizer_key_event(struct button_event* button_event) {
     }
 }
 
-bool synthesizer_process(fixed16* block, size_t block_size)
+void synthesizer_midi_event(const struct midi_message* message)
+{
+    __ASSERT_NO_MSG(message != NULL);
+
+    switch (message->type) {
+        case MIDI_NOTE_ON:
+            arpeggio_note_add(message->data[0], message->data[1]);
+            break;
+        case MIDI_NOTE_OFF:
+            arpeggio_note_remove(message->data[0]);
+            break;
+        case MIDI_CONTROL_CHANGE: {
+            const int32_t value = message->data[1] * INT16_MAX / 127;
+            if (message->data[0] == _MIDI_CC_CUTOFF) {
+                (void)param_store_set(PARAM_FILTER_CUTOFF, value);
+            } else if (message->data[0] == _MIDI_CC_ECHO_FEEDBACK) {
+                (void)param_store_set(PARAM_ECHO_FEEDBACK, value);
+            } else if (message->data[0] == _MIDI_CC_ARPEGGIO_MODE) {
+                arpeggio_set_mode(message->data[1] * ARPEGGIO_MODE_NUM / 128);
+            } else if (message->data[0] == _MIDI_CC_ARPEGGIO_OCTAVES) {
+                arpeggio_set_octaves(1 + message->data[1] * ARPEGGIO_OCTAVES_MAX / 128);
+            } else if (message->data[0] == _MIDI_CC_ARPEGGIO_GATE) {
+                arpeggio_set_gate(1 + message->data[1] * 99 / 127);
+            }
+            break;
+        }
+        case MIDI_PITCH_BEND:
+            _pitch_bend = midi_pitch_bend(message) * _PITCH_BEND_RANGE / MIDI_PITCH_BEND_CENTER;
+            break;
+        default:
+            /* clock and transport are followed by the tick provider, with CONFIG_MIDI_CLOCK_FOLLOW */
+            break;
+    }
+}
+
+bool synthesizer_process(bus_frame* block, size_t block_size)
 {
-    BUILD_ASSERT(CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2, "synthesizer only support 16-bit");
     __ASSERT_NO_MSG(block != NULL);
+    __ASSERT(block_size % CONTROL_RATE_SAMPLES == 0, "block size must be a multiple of the control rate");
+
+    /* parameters changed from other threads take effect from this block */
+    const uint32_t changed = param_store_acquire();
+    if (changed) {
+#if CONFIG_SYNTH_PATCH
+        patch_params_apply(changed);
+#else
+        _params_apply(changed);
+#endif
+    }
 
+#if CONFIG_SYNTH_PATCH
+    /* compiled from the patch description, unrolled for all voices */
+    patch_voices_process(block, block_size);
+#else
     for (int i = 0; i < CONFIG_MAX_NOTES; i++)
     {
         bool ret;
@@ -100,61 +397,326 @@ bool synthesizer_process(fixed16* block, size_t block_size)
         ret = effect_envelope_is_active(&_envelopes[i]);
         if (ret == false) continue;
 
+        /* voices spreading themselves across the stereo field are processed in stereo throughout */
+        if (_voice_is_stereo(i)) {
+            stereo16 voice_block[block_size];
+
+            ret = _voice_process_stereo(i, voice_block, block_size);
+            if (ret == false) continue;
+
+            ret = effect_envelope_process_stereo(&_envelopes[i], voice_block, block_size);
+            if (ret == false) continue;
+
+            _bus_mix(block, voice_block, block_size);
+            continue;
+        }
+
         fixed16 osc_block[block_size];
         
-        ret = osc_process_triangle(&_osciillators[i], osc_block, block_size);
+        /* oscillator, filter and amplitude with control rate modulation */
+        ret = _voice_process(i, osc_block, block_size);
         if (ret == false) continue;
 
-        // ret = effect_modulation_process(&_modulation[i], block, block_size);
-        // if (ret == false) continue;
-
         /* oscillator envelope, similar to ADSR */
         ret = effect_envelope_process(&_envelopes[i], osc_block, block_size);
         if (ret == false) continue;
 
-        /* add oscillator to audio stream */
-        _audio_stream_add(block, osc_block, block_size);
+        /* mono voices are panned into the stereo stream */
+        _bus_mix_panned(block, osc_block, block_size, _voice_pan_gains[i]);
+    }
+#endif
+
+    /* percussion, not affected by voice modulation */
+    for (int i = 0; i < CONFIG_SYNTH_DRUM_VOICES; i++)
+    {
+        if (!_drums[i].active) continue;
+
+        fixed16 drum_block[block_size];
+
+        for (size_t offset = 0; offset < block_size; offset += CONTROL_RATE_SAMPLES) {
+            if (!drum_voice_process(&_drums[i], drum_block + offset, CONTROL_RATE_SAMPLES)) {
+                memset(drum_block + offset, 0, (block_size - offset) * sizeof(drum_block[0]));
+                break;
+            }
+        }
+
+        _bus_mix_panned(block, drum_block, block_size, _drum_pan_gains);
+    }
+
+#if CONFIG_SYNTH_GRAPH
+    /* patch connected at runtime, mixed in before the bus effects */
+    const stereo16* patch = graph_process(block_size);
+    if (patch != NULL) {
+        _bus_mix(block, patch, block_size);
     }
+#endif
 
     /* echo effect effecting all oscillators */
-    (void)effect_echo_process(&_echo, block, block_size);
-    
+#if CONFIG_SYNTH_PATCH
+    patch_bus_process(block, block_size);
+#else
+    _bus_process(block, block_size);
+#endif
+
     return true;
 }
 
 void synthesizer_tick(void) {
     arpeggio_tick();
+    sequencer_tick();
+    smf_player_tick();
 }
 
-static void _play_note(int index, int note)
+static void _play_note(int index, int note, uint8_t velocity)
 {
     __ASSERT(index >= 0 && index < CONFIG_MAX_NOTES, "note index out of range");
+    __ASSERT(velocity < VELOCITY_NUM, "velocity out of range");
 
-    const float freq = midi_note_to_frequency[note];
-    osc_set_freq(&_osciillators[index], freq);
-    osc_set_amplitude(&_osciillators[index], FLOAT_TO_FIXED16(1.0f / CONFIG_MAX_NOTES));
+    /* delay memory is only held by voices currently playing strings */
+    if (_voice_type[index] == VOICE_TYPE_PLUCK && _voice_type_next[index] != VOICE_TYPE_PLUCK) {
+        pluck_voice_release(&_plucks[index]);
+    }
+
+    _voice_type[index] = _voice_type_next[index];
+    _voice_pitch[index] = PITCH_FROM_NOTE(note);
+
+    const uint32_t phase_increment = pitch_to_phase_increment(_voice_pitch[index]);
+    /* full velocity leaves headroom for all notes at once */
+    const fixed16 amplitude = velocity_curve[velocity] / CONFIG_MAX_NOTES;
+
+#if CONFIG_SYNTH_PATCH
+    patch_note_on(index, phase_increment, amplitude);
+#else
+    modulation_matrix_set_source(&_voice_matrix[index], MODULATION_SOURCE_VELOCITY, velocity_curve[velocity]);
+
+    switch (_voice_type[index]) {
+        case VOICE_TYPE_OSCILLATOR:
+            osc_set_phase_increment(&_osciillators[index], phase_increment);
+            osc_set_amplitude(&_osciillators[index], amplitude);
+            break;
+        case VOICE_TYPE_WAVETABLE:
+            wavetable_osc_set_phase_increment(&_wavetables[index], phase_increment);
+            wavetable_osc_set_amplitude(&_wavetables[index], amplitude);
+            break;
+        case VOICE_TYPE_FM:
+            fm_voice_set_phase_increment(&_fm_voices[index], phase_increment);
+            fm_voice_set_amplitude(&_fm_voices[index], amplitude);
+            fm_voice_start(&_fm_voices[index]);
+            break;
+        case VOICE_TYPE_PLUCK:
+            pluck_voice_set_amplitude(&_plucks[index], amplitude);
+            if (!pluck_voice_start(&_plucks[index], phase_increment)) {
+                LOG_WRN("delay pool exhausted, note %d not played", note);
+            }
+            break;
+        case VOICE_TYPE_UNISON:
+            unison_osc_set_phase_increment(&_unisons[index], phase_increment);
+            unison_osc_set_amplitude(&_unisons[index], amplitude);
+            unison_osc_start(&_unisons[index]);
+            break;
+        case VOICE_TYPE_SAMPLE: {
+            struct sample sample;
+            if (sample_bank_get(_voice_sample[index], &sample) == 0) {
+                sample_player_set_amplitude(&_samples[index], amplitude);
+                sample_player_start(&_samples[index], &sample, phase_increment);
+            }
+            break;
+        }
+    }
 
     effect_envelope_start(&_envelopes[index]);
+#endif
 }
 
 static void _stop_note(int index)
 {
     __ASSERT(index >= 0 && index < CONFIG_MAX_NOTES, "note index out of range");
 
+#if CONFIG_SYNTH_PATCH
+    patch_note_off(index);
+#else
     effect_envelope_end(&_envelopes[index]);
+#endif
 }
 
-static inline void _audio_stream_add(fixed16* destination, fixed16* source, size_t block_size) {
+#if !CONFIG_SYNTH_PATCH
+static bool _voice_process(int index, fixed16* block, size_t block_size)
+{
+    for (size_t offset = 0; offset < block_size; offset += CONTROL_RATE_SAMPLES) {
+        fixed16* sub_block = block + offset;
+
+        _voice_modulation_update(index);
 
-    uint32_t *dst = (uint32_t *)destination;
-    const uint32_t *src = (uint32_t *)source;
-    const uint32_t *end = (uint32_t *)(destination + block_size);
+        bool ret = _voice_source_process(index, sub_block, CONTROL_RATE_SAMPLES);
+        if (ret == false) return false;
 
-    do {
-        /* adds 4 samples for each loop cycle */
-        uint32_t tmp = *dst;
-        *dst++ = signed_add_16_and_16(tmp, *src++);
-        tmp = *dst;
-        *dst++ = signed_add_16_and_16(tmp, *src++);
-    } while (dst < end);
-}
\ No newline at end of file
+        (void)filter_lowpass_process(&_lowpass[index], sub_block, CONTROL_RATE_SAMPLES);
+
+        const fixed16 gain = control_rate_clamp_unipolar(INT16_MAX + modulation_matrix_get(&_voice_matrix[index], MODULATION_DESTINATION_AMPLITUDE));
+        control_rate_gain_ramp(sub_block, CONTROL_RATE_SAMPLES, _voice_gain[index], gain);
+        _voice_gain[index] = gain;
+    }
+
+    return true;
+}
+
+static bool _voice_process_stereo(int index, stereo16* block, size_t block_size)
+{
+    for (size_t offset = 0; offset < block_size; offset += CONTROL_RATE_SAMPLES) {
+        stereo16* sub_block = block + offset;
+
+        _voice_modulation_update(index);
+
+        bool ret = unison_osc_process_stereo(&_unisons[index], sub_block, CONTROL_RATE_SAMPLES);
+        if (ret == false) return false;
+
+        (void)filter_lowpass_process_stereo(&_lowpass[index], sub_block, CONTROL_RATE_SAMPLES);
+
+        const fixed16 gain = control_rate_clamp_unipolar(INT16_MAX + modulation_matrix_get(&_voice_matrix[index], MODULATION_DESTINATION_AMPLITUDE));
+        stereo_gain_ramp(sub_block, CONTROL_RATE_SAMPLES, _voice_gain[index], gain);
+        _voice_gain[index] = gain;
+    }
+
+    return true;
+}
+
+/* only the unison voice has a stereo source */
+static inline bool _voice_is_stereo(int index)
+{
+    return _voice_type[index] == VOICE_TYPE_UNISON;
+}
+
+static inline bool _voice_source_process(int index, fixed16* block, size_t block_size)
+{
+    switch (_voice_type[index]) {
+        case VOICE_TYPE_OSCILLATOR:
+            return osc_process_triangle(&_osciillators[index], block, block_size);
+        case VOICE_TYPE_WAVETABLE:
+            return wavetable_osc_process(&_wavetables[index], block, block_size);
+        case VOICE_TYPE_FM:
+            return fm_voice_process(&_fm_voices[index], block, block_size);
+        case VOICE_TYPE_PLUCK:
+            return pluck_voice_process(&_plucks[index], block, block_size);
+        case VOICE_TYPE_SAMPLE:
+            return sample_player_process(&_samples[index], block, block_size);
+        case VOICE_TYPE_UNISON:
+            return unison_osc_process(&_unisons[index], block, block_size);
+    }
+
+    return false;
+}
+
+/* evaluates modulation sources once and sets the targets which are ramped towards across the next sub block */
+static void _voice_modulation_update(int index)
+{
+    struct modulation_matrix* matrix = &_voice_matrix[index];
+
+    modulation_matrix_set_source(matrix, MODULATION_SOURCE_LFO1, effect_modulation_next(&_modulation[index], CONTROL_RATE_SAMPLES));
+    modulation_matrix_set_source(matrix, MODULATION_SOURCE_LFO2, effect_modulation_next(&_vibrato[index], CONTROL_RATE_SAMPLES));
+    modulation_matrix_set_source(matrix, MODULATION_SOURCE_DRIFT, effect_drift_next(&_drift[index]));
+    modulation_matrix_process(matrix);
+
+    /* pitch modulation of 1 corresponds to one octave up */
+    const fixed16 pitch = modulation_matrix_get(matrix, MODULATION_DESTINATION_PITCH);
+    const int32_t pitch_offset = ((int32_t)pitch * PITCH_OCTAVE) >> 15;
+    const uint32_t phase_increment = pitch_to_phase_increment(_voice_pitch[index] + pitch_offset + _pitch_bend);
+
+    switch (_voice_type[index]) {
+        case VOICE_TYPE_OSCILLATOR:
+            osc_set_phase_increment_target(&_osciillators[index], phase_increment);
+            break;
+        case VOICE_TYPE_WAVETABLE: {
+            const fixed16 morph = modulation_matrix_get(matrix, MODULATION_DESTINATION_WAVETABLE_MORPH);
+            wavetable_osc_set_phase_increment_target(&_wavetables[index], phase_increment);
+            wavetable_osc_set_morph(&_wavetables[index], (uint16_t)control_rate_clamp_unipolar(_VOICE_MORPH + morph) << 1);
+            break;
+        }
+        case VOICE_TYPE_FM:
+            /* not ramped, operator increments step once per control period */
+            fm_voice_set_phase_increment(&_fm_voices[index], phase_increment);
+            break;
+        case VOICE_TYPE_PLUCK:
+            /* pitch is set by the delay length at note on */
+            break;
+        case VOICE_TYPE_UNISON:
+            /* not ramped, the detuned increments step once per control period */
+            unison_osc_set_phase_increment(&_unisons[index], phase_increment);
+            break;
+        case VOICE_TYPE_SAMPLE:
+            if (_samples[index].playing) {
+                sample_player_set_phase_increment(&_samples[index], phase_increment);
+            }
+            break;
+    }
+
+    const fixed16 cutoff = modulation_matrix_get(matrix, MODULATION_DESTINATION_FILTER_CUTOFF);
+    filter_lowpass_set_cutoff_target(&_lowpass[index], control_rate_clamp_unipolar(param_store_get(PARAM_FILTER_CUTOFF) + cutoff));
+}
+
+static void _bus_process(bus_frame* block, size_t block_size)
+{
+    for (size_t offset = 0; offset < block_size; offset += CONTROL_RATE_SAMPLES) {
+        modulation_matrix_set_source(&_bus_matrix, MODULATION_SOURCE_LFO1, effect_modulation_next(&_bus_modulation, CONTROL_RATE_SAMPLES));
+        modulation_matrix_process(&_bus_matrix);
+
+        const fixed16 feedback = modulation_matrix_get(&_bus_matrix, MODULATION_DESTINATION_ECHO_FEEDBACK);
+        effect_echo_set_feedback_target(&_echo, control_rate_clamp_unipolar(param_store_get(PARAM_ECHO_FEEDBACK) + feedback));
+
+#if CONFIG_SYNTH_BUS_Q31
+        (void)effect_echo_process_q31(&_echo, block + offset, CONTROL_RATE_SAMPLES);
+#else
+        (void)effect_echo_process(&_echo, block + offset, CONTROL_RATE_SAMPLES);
+#endif
+    }
+}
+
+/* parameters from param_store which are not read each control period. Applied between blocks, so
+ * modules never see a change mid block. Only the changed ones are applied, as moving the echo delay
+ * jumps its read position */
+static void _params_apply(uint32_t changed)
+{
+    if (changed & PARAM_MASK(PARAM_ECHO_DELAY_MS)) {
+        effect_echo_set_delay(&_echo, param_store_get(PARAM_ECHO_DELAY_MS));
+    }
+
+    const float period = param_store_get(PARAM_ENVELOPE_PERIOD_MS);
+    const float duty_cycle = (float)param_store_get(PARAM_ENVELOPE_DUTY_CYCLE) / INT16_MAX;
+    const float floor = (float)param_store_get(PARAM_ENVELOPE_FLOOR) / INT16_MAX;
+    const float lfo_freq = param_store_get(PARAM_LFO_FREQ_MHZ) / 1000.0f;
+
+    for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
+        if (changed & PARAM_MASK(PARAM_ENVELOPE_PERIOD_MS)) {
+            effect_envelope_set_period(&_envelopes[i], period);
+        }
+        if (changed & PARAM_MASK(PARAM_ENVELOPE_DUTY_CYCLE)) {
+            effect_envelope_set_duty_cycle(&_envelopes[i], duty_cycle);
+        }
+        if (changed & PARAM_MASK(PARAM_ENVELOPE_FLOOR)) {
+            effect_envelope_set_floor(&_envelopes[i], floor);
+        }
+        if (changed & PARAM_MASK(PARAM_LFO_FREQ_MHZ)) {
+            effect_modulation_set_freq(&_modulation[i], lfo_freq);
+        }
+    }
+}
+#endif
+
+/* voices are always rendered in Q15, widened when added to a Q31 bus */
+
+static inline void _bus_mix(bus_frame* destination, const stereo16* source, size_t block_size)
+{
+#if CONFIG_SYNTH_BUS_Q31
+    stereo32_mix(destination, source, block_size);
+#else
+    stereo_mix(destination, source, block_size);
+#endif
+}
+
+static inline void _bus_mix_panned(bus_frame* destination, const fixed16* source, size_t block_size, stereo16 gains)
+{
+#if CONFIG_SYNTH_BUS_Q31
+    stereo32_mix_panned(destination, source, block_size, gains);
+#else
+    stereo_mix_panned(destination, source, block_size, gains);
+#endif
+}
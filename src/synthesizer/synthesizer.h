@@ -14,14 +14,45 @@
 #include <stdbool.h>
 
 #include "../io/button.h"
+#include "../io/midi.h"
 #include "integer_math.h"
+#include "dsp/drum_voice.h"
+#include "dsp/stereo.h"
+
+enum voice_type {
+    VOICE_TYPE_OSCILLATOR,
+    VOICE_TYPE_WAVETABLE,
+    VOICE_TYPE_FM,
+    VOICE_TYPE_PLUCK,
+    VOICE_TYPE_SAMPLE,
+    VOICE_TYPE_UNISON,
+};
 
 void synthesizer_init(void);
 
+/* takes effect from the next note played by the voice */
+void synthesizer_set_voice_type(int index, enum voice_type type);
+
+/* index into the sample bank, played by voices of type VOICE_TYPE_SAMPLE */
+void synthesizer_set_voice_sample(int index, uint16_t sample);
+
+/* constant power pan of a mono voice in [-1, 1], from hard left to hard right. Not ramped, and
+ * ignored by voices which spread themselves across the stereo field */
+void synthesizer_set_voice_pan(int index, fixed16 pan);
+
+/* plays a hit on the percussion voice pool, stealing the quietest drum voice if all are busy.
+ * Should be called from the audio processing context, such as tick callbacks */
+void synthesizer_drum_hit(enum drum_type type, fixed16 level);
+
 void synthesizer_key_event(struct button_event*);
 
-/* returns false if nothing was processed */
-bool synthesizer_process(fixed16* block, size_t block_size);
+/* notes, pitch bend and controllers on any channel. Should be called from the audio processing
+ * context, between blocks */
+void synthesizer_midi_event(const struct midi_message* message);
+
+/* adds block_size stereo frames to the block, in the bus format selected by CONFIG_SYNTH_BUS_Q31.
+ * Returns false if nothing was processed */
+bool synthesizer_process(bus_frame* block, size_t block_size);
 
 /* compatible with type tick_provider_notify_cb */
 void synthesizer_tick(void);
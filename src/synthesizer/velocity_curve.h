@@ -0,0 +1,28 @@
+/**
+ * @file velocity_curve.h
+ * @author Rein Gundersen Bentdal
+ * @brief Mapping from note velocity to gain. The table is generated at build time by
+ *  scripts/velocity_curve.py for the configured curve
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _VELOCITY_CURVE_H_
+#define _VELOCITY_CURVE_H_
+
+#include <stdint.h>
+
+#include "integer_math.h"
+
+#define VELOCITY_NUM 128
+
+/* velocity of notes from inputs without velocity, such as the buttons */
+#define VELOCITY_DEFAULT 100
+
+/* gain of each velocity, 0 for velocity 0 and INT16_MAX for 127 */
+extern const fixed16 velocity_curve[VELOCITY_NUM];
+
+#endif
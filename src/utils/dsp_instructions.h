@@ -30,6 +30,10 @@
 
 #include <stdint.h>
 
+#if !defined(__arm__)
+#include "dsp_instructions_host.h"
+#else
+
 // computes limit((val >> rshift), 2**bits)
 static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift) __attribute__((always_inline, unused));
 static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift)
@@ -324,6 +328,17 @@ static inline int32_t substract_32_saturate(uint32_t a, uint32_t b)
     return out;
 }
 
+// computes (a + b), result saturated to 32 bit integer range
+static inline int32_t add_32_saturate(int32_t a, int32_t b) __attribute__((always_inline, unused));
+static inline int32_t add_32_saturate(int32_t a, int32_t b)
+{
+    int32_t out;
+    __asm__ volatile("qadd %0, %1, %2"
+                     : "=r"(out)
+                     : "r"(a), "r"(b));
+    return out;
+}
+
 // Multiply two S.31 fractional integers, and return the 32 most significant
 // bits after a shift left by the constant z.
 // This comes from rockbox.org
@@ -360,4 +375,6 @@ static inline void clr_q_psr(void)
             : [t] "=&r"(t)::"cc");
 }
 
+#endif /* __arm__ */
+
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+/* Plain C equivalents of the functions in dsp_instructions.h, for building the DSP code on a host */
+
+#ifndef _DSP_INSTRUCTIONS_HOST_H
+#define _DSP_INSTRUCTIONS_HOST_H
+
+#include <stdint.h>
+
+static inline int32_t _saturate(int64_t val, int bits) __attribute__((always_inline, unused));
+static inline int32_t _saturate(int64_t val, int bits)
+{
+    const int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+    return val > max ? max : val < -max - 1 ? -max - 1 : val;
+}
+
+static inline int32_t _top(uint32_t a) { return (int16_t)(a >> 16); }
+static inline int32_t _bottom(uint32_t a) { return (int16_t)a; }
+static inline uint32_t _pack(int32_t top, int32_t bottom) { return ((uint32_t)top << 16) | ((uint32_t)bottom & 0xFFFF); }
+
+static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift) { return _saturate(val >> rshift, bits); }
+static inline int16_t saturate16(int32_t val) { return _saturate(val, 16); }
+
+static inline int32_t signed_multiply_32x16b(int32_t a, uint32_t b) { return ((int64_t)a * _bottom(b)) >> 16; }
+static inline int32_t signed_multiply_32x16t(int32_t a, uint32_t b) { return ((int64_t)a * _top(b)) >> 16; }
+
+static inline int32_t multiply_32x32_rshift32(int32_t a, int32_t b) { return ((int64_t)a * b) >> 32; }
+static inline int32_t multiply_32x32_rshift32_rounded(int32_t a, int32_t b) { return ((int64_t)a * b + 0x80000000ll) >> 32; }
+static inline int32_t multiply_accumulate_32x32_rshift32_rounded(int32_t sum, int32_t a, int32_t b)
+{
+    return ((int64_t)((uint64_t)(int64_t)sum << 32) + (int64_t)a * b + 0x80000000ll) >> 32;
+}
+static inline int32_t multiply_subtract_32x32_rshift32_rounded(int32_t sum, int32_t a, int32_t b)
+{
+    return ((int64_t)((uint64_t)(int64_t)sum << 32) - (int64_t)a * b + 0x80000000ll) >> 32;
+}
+
+static inline uint32_t pack_16t_16t(int32_t a, int32_t b) { return ((uint32_t)a & 0xFFFF0000) | (((uint32_t)b >> 16) & 0xFFFF); }
+static inline uint32_t pack_16t_16b(int32_t a, int32_t b) { return ((uint32_t)a & 0xFFFF0000) | ((uint32_t)b & 0xFFFF); }
+static inline uint32_t pack_16b_16b(int32_t a, int32_t b) { return _pack(a, b); }
+
+static inline uint32_t signed_add_16_and_16(uint32_t a, uint32_t b)
+{
+    return _pack(_saturate(_top(a) + _top(b), 16), _saturate(_bottom(a) + _bottom(b), 16));
+}
+static inline int32_t signed_subtract_16_and_16(int32_t a, int32_t b)
+{
+    return _pack(_saturate(_top(a) - _top(b), 16), _saturate(_bottom(a) - _bottom(b), 16));
+}
+static inline int32_t signed_halving_add_16_and_16(int32_t a, int32_t b)
+{
+    return _pack((_top(a) + _top(b)) >> 1, (_bottom(a) + _bottom(b)) >> 1);
+}
+static inline int32_t signed_halving_subtract_16_and_16(int32_t a, int32_t b)
+{
+    return _pack((_top(a) - _top(b)) >> 1, (_bottom(a) - _bottom(b)) >> 1);
+}
+
+static inline int32_t signed_multiply_accumulate_32x16b(int32_t sum, int32_t a, uint32_t b) { return sum + signed_multiply_32x16b(a, b); }
+static inline int32_t signed_multiply_accumulate_32x16t(int32_t sum, int32_t a, uint32_t b) { return sum + signed_multiply_32x16t(a, b); }
+
+static inline uint32_t logical_and(uint32_t a, uint32_t b) { return a & b; }
+
+static inline int32_t multiply_16tx16t_add_16bx16b(uint32_t a, uint32_t b) { return _top(a) * _top(b) + _bottom(a) * _bottom(b); }
+static inline int32_t multiply_16tx16b_add_16bx16t(uint32_t a, uint32_t b) { return _top(a) * _bottom(b) + _bottom(a) * _top(b); }
+static inline int64_t multiply_accumulate_16tx16t_add_16bx16b(int64_t sum, uint32_t a, uint32_t b)
+{
+    return sum + (int64_t)_top(a) * _top(b) + (int64_t)_bottom(a) * _bottom(b);
+}
+static inline int64_t multiply_accumulate_16tx16b_add_16bx16t(int64_t sum, uint32_t a, uint32_t b)
+{
+    return sum + (int64_t)_top(a) * _bottom(b) + (int64_t)_bottom(a) * _top(b);
+}
+
+static inline int32_t multiply_16bx16b(uint32_t a, uint32_t b) { return _bottom(a) * _bottom(b); }
+static inline int32_t multiply_16bx16t(uint32_t a, uint32_t b) { return _bottom(a) * _top(b); }
+static inline int32_t multiply_16tx16b(uint32_t a, uint32_t b) { return _top(a) * _bottom(b); }
+static inline int32_t multiply_16tx16t(uint32_t a, uint32_t b) { return _top(a) * _top(b); }
+
+static inline int32_t substract_32_saturate(uint32_t a, uint32_t b) { return _saturate((int64_t)(int32_t)a - (int32_t)b, 32); }
+static inline int32_t add_32_saturate(int32_t a, int32_t b) { return _saturate((int64_t)a + b, 32); }
+
+static inline int32_t FRACMUL_SHL(int32_t x, int32_t y, int z) { return ((int64_t)x * y) >> (31 - z); }
+
+/* saturation is not tracked on the host */
+static inline uint32_t get_q_psr(void) { return 0; }
+static inline void clr_q_psr(void) {}
+
+#endif
@@ -22,6 +22,12 @@
 typedef int16_t fixed16;
 typedef uint16_t ufixed16;
 
+// Q31 in the range [-1, 1), used where 16 bits of precision are not enough
+typedef int32_t fixed32;
+
+// compile time equivalent of FLOAT_TO_FIXED16, usable in static initializers
+#define FIXED16_LITERAL(val) ((fixed16)((val) * INT16_MAX))
+
 // returns the equivalent integer value from the float range -1 to 1
 static inline fixed16 FLOAT_TO_FIXED16(float val) __attribute__((always_inline, unused));
 static inline fixed16 FLOAT_TO_FIXED16(float val) {
@@ -64,6 +70,11 @@ static inline fixed16 FIXED_ADD_SATURATE(fixed16 a, fixed16 b) {
     return saturate16((int32_t)a + (int32_t)b);
 }
 
+static inline fixed32 FIXED16_TO_FIXED32(fixed16 val) __attribute__((always_inline, unused));
+static inline fixed32 FIXED16_TO_FIXED32(fixed16 val) {
+    return (fixed32)val * (1 << 16);
+}
+
 static inline fixed16 FIXED_INTERPOLATE(fixed16 a, fixed16 b, ufixed16 pos) __attribute__((always_inline, unused));
 static inline fixed16 FIXED_INTERPOLATE(fixed16 a, fixed16 b, ufixed16 pos) {
     return ((b * pos) + (a * (UINT16_MAX + 1 - pos))) >> 16;
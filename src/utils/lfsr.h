@@ -0,0 +1,31 @@
+/**
+ * @file lfsr.h
+ * @author Rein Gundersen Bentdal
+ * @brief Fast pseudo random numbers for noise sources, xorshift form of a 32-bit LFSR
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _LFSR_H_
+#define _LFSR_H_
+
+#include <stdint.h>
+
+/* any non-zero value is a valid seed */
+#define LFSR_SEED 0x2545F491
+
+/* state must never be 0 */
+static inline uint32_t lfsr_next(uint32_t* state) __attribute__((always_inline, unused));
+static inline uint32_t lfsr_next(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file pitch_table.h
+ * @author Rein Gundersen Bentdal
+ * @brief Integer only mapping from pitch to oscillator phase increment. Tables are generated at build time
+ *  by scripts/pitch_table.py for the configured sample rate
+ * @date 2026-10-19
+ *
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PITCH_TABLE_H_
+#define _PITCH_TABLE_H_
+
+#include <stdint.h>
+
+#define PITCH_NOTE_NUM 128
+
+/* pitch is given in 1/64 semitone steps, (note << PITCH_FINE_BITS) | fine */
+#define PITCH_FINE_BITS 6
+#define PITCH_FINE_STEPS (1 << PITCH_FINE_BITS)
+#define PITCH_SEMITONE PITCH_FINE_STEPS
+#define PITCH_OCTAVE (12 * PITCH_SEMITONE)
+
+#define PITCH_FROM_NOTE(note) ((int32_t)(note) << PITCH_FINE_BITS)
+#define PITCH_MAX (PITCH_FROM_NOTE(PITCH_NOTE_NUM) - 1)
+
+/* rate at which phase accumulators are incremented */
+extern const uint32_t pitch_table_sample_rate_hz;
+
+/* highest pitch below Nyquist at pitch_table_sample_rate_hz, at most PITCH_MAX */
+extern const int32_t pitch_table_max;
+
+extern const uint32_t note_phase_increment[PITCH_NOTE_NUM];
+
+/* 2^(fine/(12*64)) in Q31 */
+extern const uint32_t fine_tune_ratio[PITCH_FINE_STEPS];
+
+static inline uint32_t pitch_to_phase_increment(int32_t pitch) __attribute__((always_inline, unused));
+static inline uint32_t pitch_to_phase_increment(int32_t pitch) {
+    if (pitch < 0) pitch = 0;
+    if (pitch > pitch_table_max) pitch = pitch_table_max;
+
+    const uint32_t increment = note_phase_increment[pitch >> PITCH_FINE_BITS];
+    return ((uint64_t)increment * fine_tune_ratio[pitch & (PITCH_FINE_STEPS - 1)]) >> 31;
+}
+
+#endif
@@ -0,0 +1,240 @@
+/* Checks how BLE MIDI packets are unpacked and their messages scheduled from the 13-bit sender timestamps: the
+ * timestamp wrapping within a packet, running status, jitter removed by the smallest transit time, messages
+ * too late for the delay, and a resync after a pause */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+
+/* the packet handling is static, and called with the arrival time directly */
+#include "ble_midi.c"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+/* header and timestamp byte of a message sent at ms */
+#define HEADER(ms) (0x80 | (((ms) >> 7) & _TIMESTAMP_HIGH_MASK))
+#define TIMESTAMP(ms) (0x80 | ((ms) & _TIMESTAMP_LOW_MASK))
+
+/* arrival time of a message sent at ms with a transit of latency us, from an arbitrary start of the audio sync
+ * timer */
+#define BASE_US 123456
+#define ARRIVAL(ms, latency) (BASE_US + (ms) * 1000 + (latency))
+
+/* the transit offset rises by at most 1/4096 of the time passed, a few us over the tests */
+#define TOLERANCE_US 50
+
+#define MESSAGES_MAX 8
+
+uint32_t audio_sync_timer_curr_time_get(void)
+{
+    return 0;
+}
+
+static void _reset(void)
+{
+    struct midi_message message;
+
+    while (midi_queue_get(&_queue, &message)) {
+    }
+
+    memset(&_clock, 0, sizeof(_clock));
+    memset(&_stats, 0, sizeof(_stats));
+    midi_parser_init(&_parser);
+}
+
+/* all queued messages, regardless of when they are due */
+static int _drain(struct midi_message* messages)
+{
+    int count = 0;
+
+    while (count < MESSAGES_MAX && midi_queue_get(&_queue, &messages[count])) {
+        count++;
+    }
+
+    return count;
+}
+
+static bool _near(uint32_t timestamp, uint32_t expected)
+{
+    return abs((int32_t)(timestamp - expected)) <= TOLERANCE_US;
+}
+
+/* a message sent at ms alone in a packet, arriving after latency us */
+static void _note_send(uint32_t ms, uint32_t latency, uint8_t note)
+{
+    const uint8_t packet[] = {HEADER(ms), TIMESTAMP(ms), 0x90, note, 100};
+
+    _packet_process(packet, sizeof(packet), ARRIVAL(ms, latency));
+}
+
+/* the low bits wrap from 126 to 2 within one packet, which carries the high bits once */
+static int _timestamp_wrap_test(void)
+{
+    struct midi_message messages[MESSAGES_MAX];
+
+    _reset();
+
+    /* sets the offset to the transit time of the connection */
+    _note_send(760, 0, 48);
+    CHECK(_drain(messages) == 1);
+    CHECK(messages[0].timestamp == ARRIVAL(760, 0) + CONFIG_BLE_MIDI_DELAY_US);
+
+    /* both sent within one connection interval, and received together 3 ms after the second */
+    BUILD_ASSERT((766 >> 7) + 1 == (770 >> 7), "the timestamps wrap between the messages");
+    const uint8_t packet[] = {HEADER(766), TIMESTAMP(766), 0x90, 60, 100, TIMESTAMP(770), 0x80, 60, 0};
+    _packet_process(packet, sizeof(packet), ARRIVAL(770, 3000));
+
+    /* played with their original spacing, a fixed delay after they were sent */
+    CHECK(_drain(messages) == 2);
+    CHECK(messages[0].type == MIDI_NOTE_ON && messages[0].data[0] == 60);
+    CHECK(messages[1].type == MIDI_NOTE_OFF && messages[1].data[0] == 60);
+    CHECK(_near(messages[0].timestamp, ARRIVAL(766, 0) + CONFIG_BLE_MIDI_DELAY_US));
+    CHECK(_near(messages[1].timestamp, ARRIVAL(770, 0) + CONFIG_BLE_MIDI_DELAY_US));
+    CHECK(_stats.late == 0);
+
+    return 0;
+}
+
+/* running status leaves out the status byte, and messages of the same time may leave out the timestamp */
+static int _running_status_test(void)
+{
+    struct midi_message messages[MESSAGES_MAX];
+
+    _reset();
+
+    _note_send(990, 0, 48);
+    CHECK(_drain(messages) == 1);
+
+    const uint8_t packet[] = {
+        HEADER(1000), TIMESTAMP(1000), 0x91, 60, 100, 64, 90, 67, 80, /* a chord without timestamps */
+        TIMESTAMP(1002), 72, 70,                                    /* a timestamp without status */
+    };
+    _packet_process(packet, sizeof(packet), ARRIVAL(1002, 0));
+
+    CHECK(_drain(messages) == 4);
+    for (int i = 0; i < 4; i++) {
+        CHECK(messages[i].type == MIDI_NOTE_ON && messages[i].channel == 1);
+    }
+    CHECK(messages[0].data[0] == 60 && messages[0].data[1] == 100);
+    CHECK(messages[1].data[0] == 64 && messages[1].data[1] == 90);
+    CHECK(messages[2].data[0] == 67 && messages[2].data[1] == 80);
+    CHECK(messages[3].data[0] == 72 && messages[3].data[1] == 70);
+
+    /* the chord at once, and the last note 2 ms later */
+    CHECK(_near(messages[1].timestamp, messages[0].timestamp) && _near(messages[2].timestamp, messages[0].timestamp));
+    CHECK(_near(messages[3].timestamp - messages[0].timestamp, 2000));
+
+    /* data before any timestamp is skipped */
+    const uint8_t headless[] = {HEADER(1010), 60, 100, TIMESTAMP(1010), 0x90, 62, 100};
+    _packet_process(headless, sizeof(headless), ARRIVAL(1010, 0));
+    CHECK(_drain(messages) == 1);
+    CHECK(messages[0].data[0] == 62);
+
+    return 0;
+}
+
+/* notes sent every 10 ms arrive with the jitter of the connection interval, and are played evenly spaced once
+ * the smallest transit has been seen */
+static int _jitter_test(void)
+{
+    static const uint32_t latencies[] = {4000, 6500, 0, 7000, 2500, 5000, 1000, 7499, 300, 3700};
+    struct midi_message message;
+
+    _reset();
+
+    for (int i = 0; i < ARRAY_SIZE(latencies); i++) {
+        const uint32_t ms = 2000 + 10 * i;
+
+        _note_send(ms, latencies[i], 60 + i);
+        CHECK(midi_queue_get(&_queue, &message));
+        CHECK(message.data[0] == 60 + i);
+
+        if (i < 2) {
+            /* the offset is still that of the first message, which came 4 ms late */
+            CHECK(_near(message.timestamp, ARRIVAL(ms, latencies[0]) + CONFIG_BLE_MIDI_DELAY_US));
+        } else {
+            CHECK(_near(message.timestamp, ARRIVAL(ms, 0) + CONFIG_BLE_MIDI_DELAY_US));
+        }
+    }
+
+    CHECK(_stats.late == 0);
+    CHECK(_stats.jitter_max >= 7000 && _stats.jitter_max <= 7499);
+
+    /* due once the audio sync timer has passed its time */
+    _note_send(2100, 5000, 70);
+    const uint32_t due = ARRIVAL(2100, 0) + CONFIG_BLE_MIDI_DELAY_US;
+    CHECK(!ble_midi_get(due - TOLERANCE_US, &message));
+    CHECK(ble_midi_get(due + TOLERANCE_US, &message));
+    CHECK(message.data[0] == 70);
+
+    return 0;
+}
+
+/* a message delayed by more than the scheduling delay is played at once, and counted */
+static int _late_test(void)
+{
+    struct midi_message message;
+
+    _reset();
+
+    _note_send(3000, 0, 60);
+    CHECK(midi_queue_get(&_queue, &message));
+
+    _note_send(3010, CONFIG_BLE_MIDI_DELAY_US + 5000, 62);
+    CHECK(midi_queue_get(&_queue, &message));
+    CHECK(message.timestamp == ARRIVAL(3010, CONFIG_BLE_MIDI_DELAY_US + 5000));
+    CHECK(_stats.late == 1);
+
+    /* without moving the offset, so the next message on time is on time */
+    _note_send(3040, 1000, 64);
+    CHECK(midi_queue_get(&_queue, &message));
+    CHECK(_near(message.timestamp, ARRIVAL(3040, 0) + CONFIG_BLE_MIDI_DELAY_US));
+    CHECK(_stats.late == 1);
+
+    return 0;
+}
+
+/* after a pause longer than half the timestamp range, sender time can not be unwrapped, and is synced again */
+static int _resync_test(void)
+{
+    struct midi_message message;
+
+    _reset();
+
+    _note_send(4000, 0, 60);
+    CHECK(midi_queue_get(&_queue, &message));
+
+    /* 6 s later the sender restarted its clock, at 100 ms, with a shorter transit than before */
+    const uint32_t arrival = ARRIVAL(4000, 0) + 6000000;
+    BUILD_ASSERT(6000000 > _RESYNC_US, "the pause is long enough to resync");
+
+    const uint8_t packet[] = {HEADER(100), TIMESTAMP(100), 0x90, 62, 100};
+    _packet_process(packet, sizeof(packet), arrival);
+    CHECK(midi_queue_get(&_queue, &message));
+    CHECK(message.timestamp == arrival + CONFIG_BLE_MIDI_DELAY_US);
+
+    /* and follows the new sender time */
+    const uint8_t next[] = {HEADER(110), TIMESTAMP(110), 0x90, 64, 100};
+    _packet_process(next, sizeof(next), arrival + 10000 + 2000);
+    CHECK(midi_queue_get(&_queue, &message));
+    CHECK(_near(message.timestamp, arrival + 10000 + CONFIG_BLE_MIDI_DELAY_US));
+    CHECK(_stats.late == 0);
+
+    return 0;
+}
+
+int main(void)
+{
+    if (_timestamp_wrap_test() != 0 || _running_status_test() != 0 || _jitter_test() != 0 || _late_test() != 0) {
+        return 1;
+    }
+
+    return _resync_test();
+}
@@ -0,0 +1,38 @@
+/* Runs effect_drift for scripts/drift.py --check. Prints the segment length in control periods, then the
+ * target point of the current segment and the output for each control period */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dsp/effect_drift.h"
+#include "dsp/control_rate.h"
+#include "pitch_table.h"
+
+int main(int argc, char** argv)
+{
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s <control periods per point> <points> <seed>\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t segment = strtoul(argv[1], NULL, 0);
+    const uint32_t points = strtoul(argv[2], NULL, 0);
+    const uint32_t seed = strtoul(argv[3], NULL, 0);
+
+    const float control_rate_hz = (float)pitch_table_sample_rate_hz / CONTROL_RATE_SAMPLES;
+
+    struct effect_drift drift;
+    effect_drift_init(&drift, seed);
+
+    /* halfway between the rates giving segment and segment + 1, as the rate is truncated to whole periods */
+    effect_drift_set_rate(&drift, control_rate_hz / (segment + 0.5f));
+
+    printf("%u\n", drift.segment);
+
+    for (uint32_t i = 0; i < points * drift.segment; i++) {
+        const fixed16 y = effect_drift_next(&drift);
+        printf("%d %d\n", drift.point_next, y);
+    }
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+/* Schedules and scratch buffers of graph_update: the voice chain of the benchmark, a cycle, a source read
+ * by two nodes processing in place, and a mixer without inputs */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+
+#include "graph.h"
+#include "audio_process.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define PHASE_INCREMENT 20000000
+
+static stereo16 _echo_buf[1024];
+
+static int _oscillator_add(uint32_t phase_increment)
+{
+    const int osc = graph_node_add(GRAPH_NODE_OSCILLATOR);
+    struct graph_node* node = graph_node_get(osc);
+
+    node->waveform = GRAPH_WAVEFORM_TRIANGLE;
+    osc_set_phase_increment(&node->oscillator, phase_increment);
+    osc_set_amplitude(&node->oscillator, FLOAT_TO_FIXED16(0.2f));
+
+    return osc;
+}
+
+static int _envelope_add(void)
+{
+    const int envelope = graph_node_add(GRAPH_NODE_ENVELOPE);
+
+    effect_envelope_set_period(&graph_node_get(envelope)->envelope, 150);
+    effect_envelope_set_mode(&graph_node_get(envelope)->envelope, ENVELOPE_MODE_LOOP);
+    effect_envelope_start(&graph_node_get(envelope)->envelope);
+
+    return envelope;
+}
+
+/* four filtered voices into a mixer and an echo, 14 nodes on 2 buffers */
+static int _voice_chain_test(void)
+{
+    graph_clear();
+
+    const int mixer = graph_node_add(GRAPH_NODE_MIXER);
+    const int echo = graph_node_add(GRAPH_NODE_ECHO);
+    effect_echo_init(&graph_node_get(echo)->echo, _echo_buf, ARRAY_SIZE(_echo_buf));
+    CHECK(graph_connect(mixer, echo, GRAPH_GAINS_UNITY) == 0);
+    graph_set_output(echo);
+
+    for (int i = 0; i < GRAPH_INPUTS_MAX; i++) {
+        const int osc = _oscillator_add(PHASE_INCREMENT * (i + 1));
+        const int envelope = _envelope_add();
+        const int lowpass = graph_node_add(GRAPH_NODE_LOWPASS);
+
+        CHECK(graph_connect(osc, envelope, 0) == 0);
+        CHECK(graph_connect(envelope, lowpass, 0) == 0);
+        CHECK(graph_connect(lowpass, mixer, stereo_pan_gains(FLOAT_TO_FIXED16(-0.6f + 0.4f * i))) == 0);
+    }
+
+    /* the inputs are full */
+    const int extra = graph_node_add(GRAPH_NODE_OSCILLATOR);
+    CHECK(graph_connect(extra, mixer, GRAPH_GAINS_UNITY) == -ENOSPC);
+    CHECK(graph_connect(extra, echo, GRAPH_GAINS_UNITY) == -ENOSPC);
+    graph_node_remove(extra);
+
+    CHECK(graph_update() == 0);
+    CHECK(graph_buffers_used() == 2);
+
+    /* each voice is filtered in the buffer of its oscillator, and summed into the buffer of the mixer */
+    CHECK(!graph_node_get(echo)->copy_input);
+    CHECK(graph_node_get(echo)->buffer == graph_node_get(mixer)->buffer);
+
+    const stereo16* output = graph_process(AUDIO_BLOCK_FRAMES);
+    CHECK(output != NULL);
+
+    bool sounding = false;
+    for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+        sounding |= output[i] != 0;
+    }
+    CHECK(sounding);
+
+    return 0;
+}
+
+/* feedback is only supported inside modules */
+static int _cycle_test(void)
+{
+    graph_clear();
+
+    const int mixer = graph_node_add(GRAPH_NODE_MIXER);
+    const int first = graph_node_add(GRAPH_NODE_LOWPASS);
+    const int second = graph_node_add(GRAPH_NODE_LOWPASS);
+
+    CHECK(graph_connect(first, second, 0) == 0);
+    CHECK(graph_connect(second, first, 0) == 0);
+    CHECK(graph_connect(second, mixer, GRAPH_GAINS_UNITY) == 0);
+    graph_set_output(mixer);
+
+    CHECK(graph_update() == -EINVAL);
+    CHECK(graph_process(AUDIO_BLOCK_FRAMES) == NULL);
+
+    /* and is processed again once the cycle is broken */
+    graph_disconnect(second, first);
+    const int osc = _oscillator_add(PHASE_INCREMENT);
+    CHECK(graph_connect(osc, first, 0) == 0);
+    CHECK(graph_update() == 0);
+    CHECK(graph_process(AUDIO_BLOCK_FRAMES) != NULL);
+
+    /* a mono output is not supported */
+    graph_set_output(second);
+    CHECK(graph_update() == -EINVAL);
+
+    return 0;
+}
+
+/* one oscillator read by two identical envelopes, panned hard left and hard right. The first copies the
+ * input, which the second still reads, and the second takes over its buffer */
+static int _fan_out_test(void)
+{
+    graph_clear();
+
+    const int mixer = graph_node_add(GRAPH_NODE_MIXER);
+    const int osc = _oscillator_add(PHASE_INCREMENT);
+    const int left = _envelope_add();
+    const int right = _envelope_add();
+
+    CHECK(graph_connect(osc, left, 0) == 0);
+    CHECK(graph_connect(osc, right, 0) == 0);
+    CHECK(graph_connect(left, mixer, stereo_pack(INT16_MAX, 0)) == 0);
+    CHECK(graph_connect(right, mixer, stereo_pack(0, INT16_MAX)) == 0);
+    graph_set_output(mixer);
+
+    CHECK(graph_update() == 0);
+    CHECK(graph_buffers_used() == 3);
+
+    const struct graph_node* source = graph_node_get(osc);
+    CHECK(graph_node_get(left)->copy_input);
+    CHECK(graph_node_get(left)->buffer != source->buffer);
+    CHECK(!graph_node_get(right)->copy_input);
+    CHECK(graph_node_get(right)->buffer == source->buffer);
+
+    /* both read the oscillator as it was rendered */
+    for (int block = 0; block < 8; block++) {
+        const stereo16* output = graph_process(AUDIO_BLOCK_FRAMES);
+        CHECK(output != NULL);
+
+        for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+            CHECK(STEREO_LEFT(output[i]) == STEREO_RIGHT(output[i]));
+        }
+    }
+
+    /* the same source twice into the mixer, which adds it twice */
+    graph_clear();
+
+    const int sum = graph_node_add(GRAPH_NODE_MIXER);
+    const int single = _oscillator_add(PHASE_INCREMENT);
+    CHECK(graph_connect(single, sum, stereo_pack(INT16_MAX / 2, 0)) == 0);
+    CHECK(graph_connect(single, sum, stereo_pack(0, INT16_MAX / 2)) == 0);
+    CHECK(graph_connect(single, sum, stereo_pack(0, INT16_MAX / 2)) == 0);
+    graph_set_output(sum);
+
+    CHECK(graph_update() == 0);
+    CHECK(graph_buffers_used() == 2);
+
+    const stereo16* output = graph_process(AUDIO_BLOCK_FRAMES);
+    CHECK(output != NULL);
+    for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+        const int32_t left = STEREO_LEFT(output[i]);
+        const int32_t right = STEREO_RIGHT(output[i]);
+        CHECK(right >= 2 * left - 2 && right <= 2 * left + 2);
+    }
+
+    return 0;
+}
+
+/* a mixer without inputs is scheduled, and is silent */
+static int _empty_mixer_test(void)
+{
+    graph_clear();
+
+    const int mixer = graph_node_add(GRAPH_NODE_MIXER);
+    graph_set_output(mixer);
+
+    CHECK(graph_update() == 0);
+    CHECK(graph_buffers_used() == 1);
+    CHECK(graph_process(AUDIO_BLOCK_FRAMES) == NULL);
+
+    /* a filter after it keeps sounding after its input, from silence here */
+    const int lowpass = graph_node_add(GRAPH_NODE_LOWPASS);
+    CHECK(graph_connect(mixer, lowpass, 0) == 0);
+    graph_set_output(lowpass);
+
+    CHECK(graph_update() == 0);
+    CHECK(graph_buffers_used() == 1);
+
+    const stereo16* output = graph_process(AUDIO_BLOCK_FRAMES);
+    CHECK(output != NULL);
+    for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+        CHECK(output[i] == 0);
+    }
+
+    /* an envelope after it stays silent */
+    graph_node_remove(lowpass);
+    const int envelope = _envelope_add();
+    CHECK(graph_connect(mixer, envelope, 0) == 0);
+    graph_set_output(envelope);
+
+    CHECK(graph_update() == 0);
+    CHECK(graph_process(AUDIO_BLOCK_FRAMES) == NULL);
+
+    return 0;
+}
+
+int main(void)
+{
+    if (_voice_chain_test() != 0 || _cycle_test() != 0 || _fan_out_test() != 0) {
+        return 1;
+    }
+
+    return _empty_mixer_test();
+}
@@ -0,0 +1,162 @@
+/* Scans a simulated key matrix with bouncing keys, while the consumer stalls long enough to fill the queue.
+ * Checks that every change reaches the consumer in order, consistent with the keys it has seen, and that
+ * the keys it ends up with are the keys held once the bounce has settled */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+/* a matrix of 5 rows and 6 columns, the columns on one port */
+#define ROWS 5
+#define COLUMNS 6
+#define KEYS (ROWS * COLUMNS)
+#define ROW_PIN_FIRST 10
+#define COLUMN_PIN_FIRST 20
+
+static const struct device _row_port = {.name = "rows"};
+static const struct device _column_port = {.name = "columns"};
+
+#define DT_NUM_INST_STATUS_OKAY(compat) 1
+#define DT_INST_PROP_LEN(inst, prop) _PROP_LEN_##prop
+#define _PROP_LEN_row_gpios ROWS
+#define _PROP_LEN_col_gpios COLUMNS
+#define DT_INST_FOREACH_PROP_ELEM(inst, prop, fn) _FOREACH_##prop(fn)
+#define _FOREACH_row_gpios(fn) fn(0, row_gpios, 0) fn(0, row_gpios, 1) fn(0, row_gpios, 2) fn(0, row_gpios, 3) fn(0, row_gpios, 4)
+#define _FOREACH_col_gpios(fn) fn(0, col_gpios, 0) fn(0, col_gpios, 1) fn(0, col_gpios, 2) fn(0, col_gpios, 3) fn(0, col_gpios, 4) fn(0, col_gpios, 5)
+#define _PORT_row_gpios _row_port
+#define _PORT_col_gpios _column_port
+#define _PIN_FIRST_row_gpios ROW_PIN_FIRST
+#define _PIN_FIRST_col_gpios COLUMN_PIN_FIRST
+#define GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx) {.port = &_PORT_##prop, .pin = _PIN_FIRST_##prop + (idx)}
+
+/* the driver is built into the test, so the scan is run directly */
+#include "keyboard.c"
+
+#define ROUNDS 2000
+#define SCANS_PER_ROUND 12
+
+/* scans after a change in which the changing keys bounce */
+#define BOUNCE_SCANS 3
+
+/* rounds the consumer stalls for, followed by twice as many where it keeps up */
+#define STALL_ROUNDS 7
+
+/* keys held down, and the row driven while scanning */
+static keyboard_keys_t _physical;
+static int _driven_row = -1;
+
+bool device_is_ready(const struct device* dev)
+{
+    ARG_UNUSED(dev);
+    return true;
+}
+
+int gpio_pin_configure_dt(const struct gpio_dt_spec* spec, gpio_flags_t extra_flags)
+{
+    ARG_UNUSED(spec);
+    ARG_UNUSED(extra_flags);
+    return 0;
+}
+
+int gpio_pin_set_dt(const struct gpio_dt_spec* spec, int value)
+{
+    __ASSERT(spec->port == &_row_port, "only rows are driven");
+
+    _driven_row = value ? spec->pin - ROW_PIN_FIRST : -1;
+    return 0;
+}
+
+int gpio_port_get(const struct device* port, gpio_port_value_t* value)
+{
+    __ASSERT(port == &_column_port, "only columns are read");
+
+    *value = 0;
+    for (int column = 0; column < COLUMNS && _driven_row >= 0; column++) {
+        if (_physical & ((keyboard_keys_t)1 << (_driven_row * COLUMNS + column))) {
+            *value |= BIT(COLUMN_PIN_FIRST + column);
+        }
+    }
+    return 0;
+}
+
+static keyboard_keys_t _random_keys(void)
+{
+    return (((keyboard_keys_t)rand() << 31) | rand()) & (((keyboard_keys_t)1 << KEYS) - 1);
+}
+
+/* applies the queued changes to the keys seen by the consumer. Returns false if a change presses a key
+ * already down or releases a key already up */
+static bool _consume(keyboard_keys_t* consumer, long* events)
+{
+    struct keyboard_change change;
+
+    while (keyboard_get(&change)) {
+        if ((change.pressed & *consumer) || (change.released & ~*consumer) || (change.pressed & change.released)) {
+            return false;
+        }
+        *consumer = (*consumer | change.pressed) & ~change.released;
+        *events += __builtin_popcountll(change.pressed | change.released);
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    if (keyboard_init() != 0) {
+        return 1;
+    }
+
+    keyboard_keys_t consumer = 0;
+    long events = 0;
+    int merged_rounds = 0;
+
+    srand(3);
+
+    for (int round = 0; round < ROUNDS; round++) {
+        /* a chord of random keys changes, and every tenth round all keys are held */
+        const keyboard_keys_t target = round % 10 == 0 ? ((keyboard_keys_t)1 << KEYS) - 1 : _random_keys();
+        const keyboard_keys_t changing = _physical ^ target;
+
+        /* the consumer stalls for several rounds at a time, the queue fills and changes are merged */
+        const bool stalled = (round / STALL_ROUNDS) % 3 == 0;
+
+        for (int scan = 0; scan < SCANS_PER_ROUND; scan++) {
+            _physical = scan < BOUNCE_SCANS ? _physical ^ (changing & _random_keys()) : target;
+            _scan(NULL);
+
+            if (!stalled && !_consume(&consumer, &events)) {
+                printf("round %d: inconsistent change\n", round);
+                return 1;
+            }
+        }
+
+        if (_pending.pressed | _pending.released) {
+            merged_rounds++;
+        }
+
+        if (stalled) {
+            continue;
+        }
+
+        /* changes held back while the queue was full go out with the next scan */
+        _scan(NULL);
+        if (!_consume(&consumer, &events)) {
+            printf("round %d: inconsistent change\n", round);
+            return 1;
+        }
+
+        if (consumer != target) {
+            printf("round %d: consumer has 0x%llx, keys held 0x%llx\n", round, (unsigned long long)consumer,
+                   (unsigned long long)target);
+            return 1;
+        }
+    }
+
+    printf("%ld key events in %d rounds, %d ended with changes held back\n", events, ROUNDS, merged_rounds);
+
+    /* the queue must have been full for the merging to be tested */
+    return merged_rounds > 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/* Checks the MIDI byte stream parser and the queue between the UART interrupt and audio processing */
+
+#include <stdio.h>
+
+#include <zephyr/kernel.h>
+
+#include "midi.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define MESSAGES_MAX 16
+
+/* feeds the bytes and collects the messages completed */
+static int _parse(struct midi_parser* parser, const uint8_t* bytes, size_t count, struct midi_message* messages)
+{
+    int completed = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        struct midi_message message;
+        if (midi_parser_feed(parser, bytes[i], &message)) {
+            __ASSERT(completed < MESSAGES_MAX, "too many messages");
+            messages[completed++] = message;
+        }
+    }
+
+    return completed;
+}
+
+static bool _is(const struct midi_message* message, uint8_t type, uint8_t channel, uint8_t data0, uint8_t data1)
+{
+    return message->type == type && message->channel == channel && message->data[0] == data0 && message->data[1] == data1;
+}
+
+static int _parser_test(void)
+{
+    struct midi_parser parser;
+    struct midi_message messages[MESSAGES_MAX];
+
+    /* running status, the second and third note on have no status byte */
+    midi_parser_init(&parser);
+    const uint8_t running[] = {0x91, 60, 100, 64, 90, 67, 80};
+    CHECK(_parse(&parser, running, sizeof(running), messages) == 3);
+    CHECK(_is(&messages[0], MIDI_NOTE_ON, 1, 60, 100));
+    CHECK(_is(&messages[1], MIDI_NOTE_ON, 1, 64, 90));
+    CHECK(_is(&messages[2], MIDI_NOTE_ON, 1, 67, 80));
+
+    /* note on with velocity 0 is a note off, also under running status */
+    midi_parser_init(&parser);
+    const uint8_t velocity_zero[] = {0x90, 60, 0, 60, 1, 60, 0};
+    CHECK(_parse(&parser, velocity_zero, sizeof(velocity_zero), messages) == 3);
+    CHECK(_is(&messages[0], MIDI_NOTE_OFF, 0, 60, 0));
+    CHECK(_is(&messages[1], MIDI_NOTE_ON, 0, 60, 1));
+    CHECK(_is(&messages[2], MIDI_NOTE_OFF, 0, 60, 0));
+
+    /* real time bytes between the bytes of a message come out at once, and leave it intact */
+    midi_parser_init(&parser);
+    const uint8_t real_time[] = {MIDI_CLOCK, 0x92, MIDI_CLOCK, 62, MIDI_START, 70, 64, MIDI_STOP, 0};
+    CHECK(_parse(&parser, real_time, sizeof(real_time), messages) == 6);
+    CHECK(_is(&messages[0], MIDI_CLOCK, 0, 0, 0));
+    CHECK(_is(&messages[1], MIDI_CLOCK, 0, 0, 0));
+    CHECK(_is(&messages[2], MIDI_START, 0, 0, 0));
+    CHECK(_is(&messages[3], MIDI_NOTE_ON, 2, 62, 70));
+    CHECK(_is(&messages[4], MIDI_STOP, 0, 0, 0));
+    CHECK(_is(&messages[5], MIDI_NOTE_OFF, 2, 64, 0));
+
+    /* active sensing is ignored without disturbing running status */
+    midi_parser_init(&parser);
+    const uint8_t active_sensing[] = {0xB0, 74, 0xFE, 10, 91, 20};
+    CHECK(_parse(&parser, active_sensing, sizeof(active_sensing), messages) == 2);
+    CHECK(_is(&messages[0], MIDI_CONTROL_CHANGE, 0, 74, 10));
+    CHECK(_is(&messages[1], MIDI_CONTROL_CHANGE, 0, 91, 20));
+
+    /* one data byte messages, and pitch bend as 14 bits */
+    midi_parser_init(&parser);
+    const uint8_t short_messages[] = {0xC3, 5, 6, 0xE0, 0x00, 0x40, 0x7F, 0x7F};
+    CHECK(_parse(&parser, short_messages, sizeof(short_messages), messages) == 4);
+    CHECK(_is(&messages[0], MIDI_PROGRAM_CHANGE, 3, 5, 0));
+    CHECK(_is(&messages[1], MIDI_PROGRAM_CHANGE, 3, 6, 0));
+    CHECK(midi_pitch_bend(&messages[2]) == 0);
+    CHECK(midi_pitch_bend(&messages[3]) == 0x1FFF);
+
+    /* system exclusive cancels running status, its data and the data after it are skipped */
+    midi_parser_init(&parser);
+    const uint8_t sysex[] = {0x90, 60, 100, 0xF0, 1, 2, 3, 0xF7, 61, 100, 0x80, 60, 0};
+    CHECK(_parse(&parser, sysex, sizeof(sysex), messages) == 2);
+    CHECK(_is(&messages[0], MIDI_NOTE_ON, 0, 60, 100));
+    CHECK(_is(&messages[1], MIDI_NOTE_OFF, 0, 60, 0));
+
+    /* data without any status */
+    midi_parser_init(&parser);
+    const uint8_t no_status[] = {60, 100};
+    CHECK(_parse(&parser, no_status, sizeof(no_status), messages) == 0);
+
+    return 0;
+}
+
+MIDI_QUEUE_DEFINE(_queue, 4);
+
+static int _queue_test(void)
+{
+    struct midi_message message = {0};
+
+    CHECK(!midi_queue_get(&_queue, &message));
+    CHECK(!midi_queue_peek(&_queue, &message));
+
+    /* indices wrap several times around the buffer, in order */
+    uint32_t put = 0;
+    uint32_t got = 0;
+    for (int round = 0; round < 10; round++) {
+        while (true) {
+            message.timestamp = put;
+            if (!midi_queue_put(&_queue, &message)) {
+                break;
+            }
+            put++;
+        }
+        CHECK(put - got == 4);
+
+        CHECK(midi_queue_peek(&_queue, &message));
+        CHECK(message.timestamp == got);
+
+        for (int i = 0; i < 3; i++) {
+            CHECK(midi_queue_get(&_queue, &message));
+            CHECK(message.timestamp == got);
+            got++;
+        }
+    }
+
+    while (midi_queue_get(&_queue, &message)) {
+        CHECK(message.timestamp == got);
+        got++;
+    }
+    CHECK(got == put);
+
+    return 0;
+}
+
+int main(void)
+{
+    if (_parser_test() != 0) {
+        return 1;
+    }
+
+    return _queue_test();
+}
@@ -0,0 +1,53 @@
+/* Checks that param_store_acquire reports each parameter whose value changed since the last snapshot
+ * adopted, across several writes published between two calls */
+
+#include <stdio.h>
+
+#include <zephyr/kernel.h>
+
+#include "param_store.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+int main(void)
+{
+    param_store_init();
+    CHECK(param_store_acquire() == 0);
+    CHECK(param_store_get(PARAM_ECHO_DELAY_MS) == 250);
+
+    CHECK(param_store_set(PARAM_ECHO_DELAY_MS, 100) == 0);
+    CHECK(param_store_acquire() == PARAM_MASK(PARAM_ECHO_DELAY_MS));
+    CHECK(param_store_get(PARAM_ECHO_DELAY_MS) == 100);
+    CHECK(param_store_acquire() == 0);
+
+    /* setting the current value again is not a change */
+    CHECK(param_store_set(PARAM_ECHO_DELAY_MS, 100) == 0);
+    CHECK(param_store_acquire() == 0);
+
+    /* writes between two calls are reported together, with the latest values */
+    CHECK(param_store_set(PARAM_FILTER_CUTOFF, 1000) == 0);
+    CHECK(param_store_set(PARAM_ENVELOPE_FLOOR, 0) == 0);
+    CHECK(param_store_set(PARAM_FILTER_CUTOFF, 2000) == 0);
+    CHECK(param_store_acquire() == (PARAM_MASK(PARAM_FILTER_CUTOFF) | PARAM_MASK(PARAM_ENVELOPE_FLOOR)));
+    CHECK(param_store_get(PARAM_FILTER_CUTOFF) == 2000);
+    CHECK(param_store_get(PARAM_ENVELOPE_FLOOR) == 0);
+    CHECK(param_store_get(PARAM_ECHO_DELAY_MS) == 100);
+
+    /* changed and changed back is not a change */
+    CHECK(param_store_set(PARAM_LFO_FREQ_MHZ, 500) == 0);
+    CHECK(param_store_set(PARAM_LFO_FREQ_MHZ, 2000) == 0);
+    CHECK(param_store_acquire() == 0);
+
+    CHECK(param_store_set(PARAM_FILTER_CUTOFF, -1) == -EINVAL);
+    CHECK(param_store_set(PARAM_ECHO_DELAY_MS, 0) == -EINVAL);
+    CHECK(param_store_set(PARAM_NUM, 0) == -EINVAL);
+    CHECK(param_store_acquire() == 0);
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+/* The patch generated from patch_test.yaml against the same chain run through the modules, frame for frame,
+ * while parameters of the store are changed and a note is released */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <zephyr/kernel.h>
+
+#include "patch.h"
+#include "param_store.h"
+#include "audio_process.h"
+
+#include "dsp/oscillator.h"
+#include "dsp/effect_envelope.h"
+#include "dsp/filter_lowpass.h"
+#include "dsp/filter_allpass.h"
+#include "dsp/effect_modulation.h"
+#include "dsp/effect_echo.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define PHASE_INCREMENT 20000000
+#define AMPLITUDE FLOAT_TO_FIXED16(0.3f)
+
+#define BLOCKS 120
+
+/* voice 0 of patch_test.yaml */
+static struct oscillator _osc;
+static struct effect_envelope _envelope;
+static struct filter_lowpass _lowpass;
+static struct filter_allpass _allpass;
+static fixed16 _allpass_buf[CONFIG_AUDIO_SAMPLE_RATE_HZ * 5 / 1000];
+static struct effect_modulation _modulation;
+
+static struct filter_lowpass _bus_lowpass;
+static struct effect_echo _echo;
+static stereo16 _echo_buf[CONFIG_AUDIO_SAMPLE_RATE_HZ * 20 / 1000];
+
+/* the pan law of scripts/patch.py, voice 0 of 3 at -spread */
+static stereo16 _pan_gains(float pan)
+{
+    const double angle = (pan + 1) / 2 * M_PI / 2;
+
+    return stereo_pack(lround(INT16_MAX * cos(angle)), lround(INT16_MAX * sin(angle)));
+}
+
+static void _reference_init(void)
+{
+    osc_init(&_osc);
+    effect_envelope_init(&_envelope);
+    effect_envelope_set_mode(&_envelope, ENVELOPE_MODE_LOOP);
+    effect_envelope_set_period(&_envelope, param_store_get(PARAM_ENVELOPE_PERIOD_MS));
+    effect_envelope_set_duty_cycle(&_envelope, 0.3f);
+    effect_envelope_set_floor(&_envelope, 0.1f);
+    effect_envelope_set_fade_out_attenuation(&_envelope, 0.05f);
+    filter_lowpass_init(&_lowpass);
+    filter_lowpass_set_cutoff(&_lowpass, param_store_get(PARAM_FILTER_CUTOFF));
+    filter_allpass_init(&_allpass, _allpass_buf, ARRAY_SIZE(_allpass_buf));
+    filter_allpass_set_gain(&_allpass, FIXED16_LITERAL(0.5));
+    filter_allpass_set_delay(&_allpass, 5);
+    effect_modulation_init(&_modulation);
+    effect_modulation_set_freq(&_modulation, 5.0f);
+    effect_modulation_set_amplitude(&_modulation, FLOAT_TO_UFIXED16(0.5f));
+
+    filter_lowpass_init(&_bus_lowpass);
+    filter_lowpass_set_cutoff(&_bus_lowpass, FIXED16_LITERAL(0.8));
+    effect_echo_init(&_echo, _echo_buf, ARRAY_SIZE(_echo_buf));
+    effect_echo_set_delay(&_echo, 20);
+    effect_echo_set_feedback(&_echo, param_store_get(PARAM_ECHO_FEEDBACK));
+}
+
+static void _reference_params_apply(uint32_t changed)
+{
+    if (changed & PARAM_MASK(PARAM_ENVELOPE_PERIOD_MS)) {
+        effect_envelope_set_period(&_envelope, param_store_get(PARAM_ENVELOPE_PERIOD_MS));
+    }
+    if (changed & PARAM_MASK(PARAM_ECHO_FEEDBACK)) {
+        effect_echo_set_feedback_target(&_echo, param_store_get(PARAM_ECHO_FEEDBACK));
+    }
+}
+
+static void _reference_process(stereo16* block, size_t block_size)
+{
+    fixed16 voice[block_size];
+
+    filter_lowpass_set_cutoff_target(&_lowpass, param_store_get(PARAM_FILTER_CUTOFF));
+
+    if (effect_envelope_is_active(&_envelope)
+        && osc_process_sawtooth(&_osc, voice, block_size)
+        && effect_envelope_process(&_envelope, voice, block_size)) {
+        (void)filter_lowpass_process(&_lowpass, voice, block_size);
+        (void)filter_allpass_process(&_allpass, voice, block_size);
+        (void)effect_modulation_process(&_modulation, voice, block_size);
+        stereo_mix_panned(block, voice, block_size, _pan_gains(-0.5f));
+    }
+
+    (void)filter_lowpass_process_stereo(&_bus_lowpass, block, block_size);
+    (void)effect_echo_process(&_echo, block, block_size);
+}
+
+int main(void)
+{
+    static stereo16 patch[AUDIO_BLOCK_FRAMES];
+    static stereo16 reference[AUDIO_BLOCK_FRAMES];
+
+    /* the startup of synthesizer_init */
+    param_store_init();
+    (void)param_store_acquire();
+
+    patch_init();
+    _reference_init();
+
+    patch_note_on(0, PHASE_INCREMENT, AMPLITUDE);
+    osc_set_phase_increment(&_osc, PHASE_INCREMENT);
+    osc_set_amplitude(&_osc, AMPLITUDE);
+    effect_envelope_start(&_envelope);
+
+    bool sounding = false;
+
+    for (int block = 0; block < BLOCKS; block++) {
+        /* as MIDI CC 74 and 91, and a parameter lock of the sequencer */
+        if (block == 20) {
+            CHECK(param_store_set(PARAM_FILTER_CUTOFF, FIXED16_LITERAL(0.2)) == 0);
+            CHECK(param_store_set(PARAM_ECHO_FEEDBACK, FIXED16_LITERAL(0.7)) == 0);
+        }
+        if (block == 40) {
+            CHECK(param_store_set(PARAM_ENVELOPE_PERIOD_MS, 40) == 0);
+        }
+        if (block == 60) {
+            patch_note_off(0);
+            effect_envelope_end(&_envelope);
+        }
+
+        /* the start of synthesizer_process */
+        const uint32_t changed = param_store_acquire();
+        if (changed) {
+            patch_params_apply(changed);
+            _reference_params_apply(changed);
+        }
+
+        memset(patch, 0, sizeof(patch));
+        memset(reference, 0, sizeof(reference));
+
+        patch_voices_process(patch, AUDIO_BLOCK_FRAMES);
+        patch_bus_process(patch, AUDIO_BLOCK_FRAMES);
+        _reference_process(reference, AUDIO_BLOCK_FRAMES);
+
+        for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+            if (patch[i] != reference[i]) {
+                printf("block %d frame %zu: 0x%08x instead of 0x%08x\n", block, i, patch[i], reference[i]);
+                return 1;
+            }
+            sounding |= patch[i] != 0;
+        }
+    }
+
+    CHECK(sounding);
+
+    return 0;
+}
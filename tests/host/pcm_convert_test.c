@@ -0,0 +1,97 @@
+/* Converts the bus to PCM at the bit depth of the build and reads it back as the codec does, as samples
+ * of the size of their containers, checking that full scale on the bus is full scale to the codec */
+
+#include <stdio.h>
+#include <math.h>
+
+#include <zephyr/kernel.h>
+
+/* the depth of each build, instead of the default of the other tests */
+#undef CONFIG_AUDIO_BIT_DEPTH_OCTETS
+#if TEST_BIT_DEPTH == 16
+#define CONFIG_AUDIO_BIT_DEPTH_BITS 16
+#define CONFIG_AUDIO_BIT_DEPTH_OCTETS 2
+#else
+#define CONFIG_AUDIO_BIT_DEPTH_BITS 32
+#define CONFIG_AUDIO_BIT_DEPTH_OCTETS 4
+#if TEST_BIT_DEPTH == 24
+#define CONFIG_AUDIO_BIT_DEPTH_24 1
+#endif
+#endif
+
+#include "pcm_convert.c"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#if CONFIG_SYNTH_BUS_Q31
+#define BUS_SCALE 2147483648.0
+#else
+#define BUS_SCALE 32768.0
+#endif
+
+/* from negative to positive full scale, with the values around zero and half scale */
+static const double _values[] = {-1.0, -0.5, -0.25, -1e-4, 0.0, 1e-4, 0.25, 0.5, 1.0};
+
+static int32_t _bus_value(double value)
+{
+    return CLAMP(lround(value * BUS_SCALE), -BUS_SCALE, BUS_SCALE - 1);
+}
+
+static double _pcm_read(const void* pcm, size_t index)
+{
+#if CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2
+    return ((const int16_t*)pcm)[index] / 32768.0;
+#else
+    return ((const int32_t*)pcm)[index] / 2147483648.0;
+#endif
+}
+
+int main(void)
+{
+    static bus_frame frames[AUDIO_BLOCK_FRAMES];
+
+    /* each value on the left, and its negation on the right */
+    for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+        const int32_t left = _bus_value(_values[i % ARRAY_SIZE(_values)]);
+        const int32_t right = _bus_value(-_values[i % ARRAY_SIZE(_values)]);
+#if CONFIG_SYNTH_BUS_Q31
+        frames[i] = (struct stereo32) {.left = left, .right = right};
+#else
+        frames[i] = stereo_pack(left, right);
+#endif
+    }
+
+    const void* pcm = pcm_convert(frames);
+
+    /* a step of the resolution of the bus or of the depth, whichever is coarser */
+    const double step = 1.0 / MIN(BUS_SCALE, (double)(1ll << (TEST_BIT_DEPTH - 1)));
+
+    for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+        const double left = _bus_value(_values[i % ARRAY_SIZE(_values)]) / BUS_SCALE;
+        const double right = _bus_value(-_values[i % ARRAY_SIZE(_values)]) / BUS_SCALE;
+
+        if (fabs(_pcm_read(pcm, 2 * i) - left) > step || fabs(_pcm_read(pcm, 2 * i + 1) - right) > step) {
+            printf("frame %u: %f %f, expected %f %f\n", i, _pcm_read(pcm, 2 * i), _pcm_read(pcm, 2 * i + 1),
+                   left, right);
+            CHECK(false);
+        }
+
+#if TEST_BIT_DEPTH == 24
+        /* rounded to 24 bits */
+        CHECK((((const int32_t*)pcm)[2 * i] & 0xFF) == 0);
+        CHECK((((const int32_t*)pcm)[2 * i + 1] & 0xFF) == 0);
+#endif
+    }
+
+    /* negative full scale is exact, positive full scale is one step below the top */
+    CHECK(_pcm_read(pcm, 0) == -1.0);
+    CHECK(_pcm_read(pcm, 1) > 1.0 - 2 * step);
+
+    return 0;
+}
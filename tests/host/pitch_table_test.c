@@ -0,0 +1,43 @@
+/* Checks that pitch_to_phase_increment() stays below Nyquist, as the oscillator requires, for every
+ * pitch the synthesizer can ask for at the sample rate the tables were generated for */
+
+#include <stdio.h>
+
+#include "pitch_table.h"
+
+int main(void)
+{
+    uint32_t previous = 0;
+
+    for (int32_t pitch = -PITCH_OCTAVE; pitch <= PITCH_MAX + PITCH_OCTAVE; pitch++) {
+        const uint32_t phase_increment = pitch_to_phase_increment(pitch);
+
+        if (phase_increment >= UINT32_MAX / 2) {
+            printf("pitch %d: phase increment %u at or above Nyquist\n", pitch, phase_increment);
+            return 1;
+        }
+        if (phase_increment < previous) {
+            printf("pitch %d: phase increment %u below the previous %u\n", pitch, phase_increment, previous);
+            return 1;
+        }
+        previous = phase_increment;
+    }
+
+    if (pitch_table_max > PITCH_MAX) {
+        printf("pitch_table_max %d above PITCH_MAX\n", pitch_table_max);
+        return 1;
+    }
+
+    /* the next pitch would have been at or above Nyquist */
+    if (pitch_table_max < PITCH_MAX) {
+        const uint32_t increment = note_phase_increment[(pitch_table_max + 1) >> PITCH_FINE_BITS];
+        const uint32_t ratio = fine_tune_ratio[(pitch_table_max + 1) & (PITCH_FINE_STEPS - 1)];
+        if ((((uint64_t)increment * ratio) >> 31) < UINT32_MAX / 2) {
+            printf("pitch_table_max %d clamps below Nyquist\n", pitch_table_max);
+            return 1;
+        }
+    }
+
+    printf("%u Hz: highest pitch %d of %d\n", pitch_table_sample_rate_hz, pitch_table_max, PITCH_MAX);
+    return 0;
+}
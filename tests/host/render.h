@@ -0,0 +1,89 @@
+/* Offline rendering shared by the renderers, included after synthesizer.c: blocks rendered through the event
+ * calendar and the synthesizer as audio_process does, and the WAV file they are written to */
+
+#ifndef _RENDER_H_
+#define _RENDER_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "audio_process.h"
+#include "event_calendar.h"
+#include "tick_provider.h"
+
+BUILD_ASSERT(!IS_ENABLED(CONFIG_SYNTH_BUS_Q31) && CONFIG_AUDIO_BIT_DEPTH_OCTETS == 2,
+             "packed frames are written as they are, as 16-bit PCM");
+
+/* rendered once playback is stopped, for the release of the last notes */
+#define TAIL_BLOCKS (2 * 1000000 / CONFIG_AUDIO_FRAME_DURATION_US)
+
+/* renders the block up to each calendar event due in it, then the rest of it */
+static void _block_render(bus_frame* block)
+{
+    size_t rendered = 0;
+    size_t frame;
+    struct calendar_event event;
+
+    memset(block, 0, AUDIO_BLOCK_FRAMES * sizeof(block[0]));
+
+    while (event_calendar_peek(&frame)) {
+        frame -= frame % CONFIG_SYNTH_CONTROL_RATE_SAMPLES;
+        if (frame > rendered) {
+            (void)synthesizer_process(block + rendered, frame - rendered);
+            rendered = frame;
+        }
+
+        (void)event_calendar_get(&event);
+        event.handler(&event);
+    }
+
+    (void)synthesizer_process(block + rendered, AUDIO_BLOCK_FRAMES - rendered);
+
+    tick_provider_increment();
+}
+
+/* whether every key is released and every envelope has ended */
+static bool _render_silent(void)
+{
+    for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
+        if (_keys._keys[i].note != 0 || effect_envelope_is_active(&_envelopes[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void _wav_u16(FILE* file, uint16_t value)
+{
+    fputc(value & 0xFF, file);
+    fputc(value >> 8, file);
+}
+
+static void _wav_u32(FILE* file, uint32_t value)
+{
+    _wav_u16(file, value & 0xFFFF);
+    _wav_u16(file, value >> 16);
+}
+
+/* 16-bit stereo PCM, with the sizes written once the length is known */
+static void _wav_header(FILE* file, uint32_t frames)
+{
+    const uint32_t data_size = frames * CONFIG_I2S_CH_NUM * sizeof(int16_t);
+
+    fseek(file, 0, SEEK_SET);
+    fwrite("RIFF", 1, 4, file);
+    _wav_u32(file, 36 + data_size);
+    fwrite("WAVEfmt ", 1, 8, file);
+    _wav_u32(file, 16);
+    _wav_u16(file, 1);
+    _wav_u16(file, CONFIG_I2S_CH_NUM);
+    _wav_u32(file, CONFIG_AUDIO_SAMPLE_RATE_HZ);
+    _wav_u32(file, CONFIG_AUDIO_SAMPLE_RATE_HZ * CONFIG_I2S_CH_NUM * sizeof(int16_t));
+    _wav_u16(file, CONFIG_I2S_CH_NUM * sizeof(int16_t));
+    _wav_u16(file, 16);
+    fwrite("data", 1, 4, file);
+    _wav_u32(file, data_size);
+}
+
+#endif
@@ -0,0 +1,316 @@
+/* Plays PCM and IMA ADPCM samples, one shot and looped, at several rates and compares them against the
+ * sample decoded once and unrolled, which has no seam. Then validates sample bank images */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "sample_player.h"
+#include "sample_bank.h"
+#include "pitch_table.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define PCM_LENGTH 64
+#define ADPCM_LENGTH 101
+#define ROOT_NOTE 60
+
+#define BLOCK_SIZE 48
+#define BLOCKS 40
+
+static fixed16 _pcm[PCM_LENGTH];
+static uint8_t _adpcm[(ADPCM_LENGTH + 1) / 2];
+
+/* what the samples hold, decoded once from the start */
+static fixed16 _adpcm_decoded[ADPCM_LENGTH];
+
+static uint32_t _random_state = 1;
+
+static uint32_t _random(void)
+{
+    _random_state = _random_state * 1664525 + 1013904223;
+    return _random_state >> 8;
+}
+
+static void _samples_generate(void)
+{
+    for (int i = 0; i < PCM_LENGTH; i++) {
+        _pcm[i] = (int16_t)_random();
+    }
+
+    for (size_t i = 0; i < sizeof(_adpcm); i++) {
+        _adpcm[i] = _random();
+    }
+
+    struct adpcm_state state = {0, 0};
+    for (int i = 0; i < ADPCM_LENGTH; i++) {
+        _adpcm_decoded[i] = adpcm_decode(&state, adpcm_nibble(_adpcm, i));
+    }
+}
+
+/* frame n of the sample at the rate of the player, from the position unrolled over the loop */
+static fixed16 _expected(const struct sample* sample, const fixed16* decoded, uint64_t rate, uint32_t n,
+                         bool* ended)
+{
+    const uint64_t position = rate * n;
+    uint32_t index = position >> 32;
+    const ufixed16 fraction = (uint32_t)position >> 16;
+
+    if (sample->mode == SAMPLE_MODE_LOOP) {
+        if (index >= sample->loop_end) {
+            index = sample->loop_start + (index - sample->loop_start) % (sample->loop_end - sample->loop_start);
+        }
+        const uint32_t next = index + 1 == sample->loop_end ? sample->loop_start : index + 1;
+        return FIXED_INTERPOLATE_AND_SCALE(decoded[index], decoded[next], fraction, FLOAT_TO_FIXED16(1.0));
+    }
+
+    if (index >= sample->length) {
+        *ended = true;
+        return 0;
+    }
+
+    const uint32_t next = index + 1 == sample->length ? index : index + 1;
+    return FIXED_INTERPOLATE_AND_SCALE(decoded[index], decoded[next], fraction, FLOAT_TO_FIXED16(1.0));
+}
+
+static int _play(const struct sample* sample, const fixed16* decoded, uint32_t phase_increment)
+{
+    static struct sample_player player;
+    fixed16 block[BLOCK_SIZE];
+    bool ended = false;
+
+    sample_player_init(&player);
+    sample_player_start(&player, sample, phase_increment);
+
+    const uint64_t rate = ((uint64_t)player.index_increment << 32) | player.phase_increment;
+
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        const bool was_playing = player.playing;
+        const bool processed = sample_player_process(&player, block, BLOCK_SIZE);
+        CHECK(processed == was_playing);
+
+        for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+            const uint32_t n = b * BLOCK_SIZE + i;
+            const fixed16 expected = ended ? 0 : _expected(sample, decoded, rate, n, &ended);
+            if (processed && block[i] != expected) {
+                printf("frame %u: %d, expected %d\n", n, block[i], expected);
+                CHECK(block[i] == expected);
+            }
+        }
+    }
+
+    /* a loop plays on, and a one shot ends within the blocks played */
+    CHECK(player.playing == (sample->mode == SAMPLE_MODE_LOOP));
+    CHECK(sample->mode == SAMPLE_MODE_LOOP || ended);
+
+    return 0;
+}
+
+static int _playback_test(void)
+{
+    const struct sample samples[] = {
+        {
+            .data = _pcm, .length = PCM_LENGTH, .sample_rate_hz = CONFIG_AUDIO_SAMPLE_RATE_HZ,
+            .root_note = ROOT_NOTE, .format = SAMPLE_FORMAT_PCM16, .mode = SAMPLE_MODE_ONE_SHOT,
+        },
+        {
+            .data = _pcm, .length = PCM_LENGTH, .loop_start = 17, .loop_end = 53,
+            .sample_rate_hz = CONFIG_AUDIO_SAMPLE_RATE_HZ, .root_note = ROOT_NOTE,
+            .format = SAMPLE_FORMAT_PCM16, .mode = SAMPLE_MODE_LOOP,
+        },
+        {
+            .data = _adpcm, .length = ADPCM_LENGTH, .sample_rate_hz = CONFIG_AUDIO_SAMPLE_RATE_HZ,
+            .root_note = ROOT_NOTE, .format = SAMPLE_FORMAT_IMA_ADPCM, .mode = SAMPLE_MODE_ONE_SHOT,
+        },
+        {
+            /* the seam is where the decoder is restored from its state at the loop start */
+            .data = _adpcm, .length = ADPCM_LENGTH, .loop_start = 23, .loop_end = 97,
+            .sample_rate_hz = CONFIG_AUDIO_SAMPLE_RATE_HZ, .root_note = ROOT_NOTE,
+            .format = SAMPLE_FORMAT_IMA_ADPCM, .mode = SAMPLE_MODE_LOOP,
+        },
+        {
+            /* loop to the very end, and recorded at half the rate */
+            .data = _adpcm, .length = ADPCM_LENGTH, .loop_start = 0, .loop_end = ADPCM_LENGTH,
+            .sample_rate_hz = CONFIG_AUDIO_SAMPLE_RATE_HZ / 2, .root_note = ROOT_NOTE,
+            .format = SAMPLE_FORMAT_IMA_ADPCM, .mode = SAMPLE_MODE_LOOP,
+        },
+    };
+
+    /* at the root note, an octave below, a fifth above and an octave and a fifth above */
+    const int notes[] = {ROOT_NOTE, ROOT_NOTE - 12, ROOT_NOTE + 7, ROOT_NOTE + 19};
+
+    for (size_t s = 0; s < ARRAY_SIZE(samples); s++) {
+        const fixed16* decoded = samples[s].format == SAMPLE_FORMAT_PCM16 ? _pcm : _adpcm_decoded;
+
+        for (size_t n = 0; n < ARRAY_SIZE(notes); n++) {
+            if (_play(&samples[s], decoded, note_phase_increment[notes[n]]) != 0) {
+                printf("sample %u, note %d\n", s, notes[n]);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* the partition, memory mapped */
+#define PARTITION_SIZE 1024
+static uint32_t _partition[PARTITION_SIZE / 4];
+static struct flash_area _area;
+
+int flash_area_open(uint8_t id, const struct flash_area** fa)
+{
+    if (id != FLASH_AREA_ID(sample_partition)) {
+        return -ENOENT;
+    }
+
+    _area.fa_off = (off_t)(uintptr_t)_partition;
+    _area.fa_size = sizeof(_partition);
+    *fa = &_area;
+    return 0;
+}
+
+void flash_area_close(const struct flash_area* fa)
+{
+    ARG_UNUSED(fa);
+}
+
+/* as scripts/sample_bank.py writes it, with the ADPCM sample followed by the PCM one */
+static void _bank_build(void)
+{
+    uint8_t* image = (uint8_t*)_partition;
+    struct sample_bank_header* header = (struct sample_bank_header*)image;
+    struct sample_bank_entry* entries = (struct sample_bank_entry*)(header + 1);
+
+    memset(_partition, 0xFF, sizeof(_partition));
+
+    *header = (struct sample_bank_header) {
+        .magic = SAMPLE_BANK_MAGIC,
+        .version = SAMPLE_BANK_VERSION,
+        .count = 2,
+    };
+
+    const uint32_t adpcm_offset = sizeof(*header) + 2 * sizeof(*entries);
+    const uint32_t pcm_offset = (adpcm_offset + sizeof(_adpcm) + 3) & ~3;
+
+    entries[0] = (struct sample_bank_entry) {
+        .offset = adpcm_offset, .length = ADPCM_LENGTH, .loop_start = 23, .loop_end = 97,
+        .sample_rate_hz = 22050, .format = SAMPLE_FORMAT_IMA_ADPCM, .mode = SAMPLE_MODE_LOOP,
+        .root_note = ROOT_NOTE,
+    };
+    entries[1] = (struct sample_bank_entry) {
+        .offset = pcm_offset, .length = PCM_LENGTH, .sample_rate_hz = 48000,
+        .format = SAMPLE_FORMAT_PCM16, .mode = SAMPLE_MODE_ONE_SHOT, .root_note = 72,
+    };
+
+    memcpy(image + adpcm_offset, _adpcm, sizeof(_adpcm));
+    memcpy(image + pcm_offset, _pcm, sizeof(_pcm));
+}
+
+static struct sample_bank_header* _header(void)
+{
+    return (struct sample_bank_header*)_partition;
+}
+
+static struct sample_bank_entry* _entry(int index)
+{
+    return (struct sample_bank_entry*)(_header() + 1) + index;
+}
+
+static int _bank_test(void)
+{
+    struct sample sample;
+
+    _bank_build();
+    CHECK(sample_bank_init() == 0);
+    CHECK(sample_bank_count() == 2);
+
+    CHECK(sample_bank_get(0, &sample) == 0);
+    CHECK(sample.data == (uint8_t*)_partition + _entry(0)->offset);
+    CHECK(sample.length == ADPCM_LENGTH && sample.loop_start == 23 && sample.loop_end == 97);
+    CHECK(sample.format == SAMPLE_FORMAT_IMA_ADPCM && sample.mode == SAMPLE_MODE_LOOP);
+    CHECK(sample.sample_rate_hz == 22050 && sample.root_note == ROOT_NOTE);
+
+    CHECK(sample_bank_get(1, &sample) == 0);
+    CHECK(memcmp(sample.data, _pcm, sizeof(_pcm)) == 0);
+    CHECK(sample.format == SAMPLE_FORMAT_PCM16 && sample.mode == SAMPLE_MODE_ONE_SHOT);
+
+    CHECK(sample_bank_get(2, &sample) == -ENOENT);
+
+    /* each is rejected, leaving the bank empty */
+    _bank_build();
+    _header()->magic = 0;
+    CHECK(sample_bank_init() == -ENOENT);
+    CHECK(sample_bank_count() == 0);
+    CHECK(sample_bank_get(0, &sample) == -ENOENT);
+
+    _bank_build();
+    _header()->version = SAMPLE_BANK_VERSION + 1;
+    CHECK(sample_bank_init() == -ENOTSUP);
+
+    _bank_build();
+    _header()->count = PARTITION_SIZE / sizeof(struct sample_bank_entry) + 1;
+    CHECK(sample_bank_init() == -EINVAL);
+    CHECK(sample_bank_count() == 0);
+
+    _bank_build();
+    _entry(1)->offset += 2;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    _bank_build();
+    _entry(1)->length = PARTITION_SIZE / 2;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    /* bytes of the length overflowing 32 bits */
+    _bank_build();
+    _entry(1)->length = 0x80000010;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    _bank_build();
+    _entry(0)->length = 0;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    _bank_build();
+    _entry(0)->root_note = PITCH_NOTE_NUM;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    _bank_build();
+    _entry(1)->sample_rate_hz = 0;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    _bank_build();
+    _entry(0)->loop_start = _entry(0)->loop_end;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    _bank_build();
+    _entry(0)->loop_end = ADPCM_LENGTH + 1;
+    CHECK(sample_bank_init() == -EINVAL);
+
+    /* loop points of a one shot are not used */
+    _bank_build();
+    _entry(1)->loop_start = 7;
+    CHECK(sample_bank_init() == 0);
+
+    /* and played in place, at the rate it was recorded at */
+    CHECK(sample_bank_get(0, &sample) == 0);
+    return _play(&sample, _adpcm_decoded, note_phase_increment[ROOT_NOTE + 5]);
+}
+
+int main(void)
+{
+    _samples_generate();
+
+    if (_playback_test() != 0) {
+        return 1;
+    }
+
+    return _bank_test();
+}
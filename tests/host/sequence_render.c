@@ -0,0 +1,142 @@
+/* Renders the song of the step sequencer offline, from the image of sequence.yaml built by
+ * scripts/sequencer_pattern.py, as smf_render does for the MIDI file player. Checks that nothing is left
+ * sounding once the sequencer has stopped, and optionally writes the audio to a WAV file:
+ *   sequence_render <image> <passes> [output.wav] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+/* the voices are inspected once the song has stopped, so the synthesizer is built into the renderer */
+#include "synthesizer.c"
+
+#include "render.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define IMAGE_SIZE_MAX 4096
+
+/* the partition, memory mapped */
+static uint32_t _partition[IMAGE_SIZE_MAX / 4];
+static struct flash_area _area;
+
+int flash_area_open(uint8_t id, const struct flash_area** fa)
+{
+    if (id != FLASH_AREA_ID(pattern_partition)) {
+        return -ENOENT;
+    }
+
+    _area.fa_off = (off_t)(uintptr_t)_partition;
+    _area.fa_size = sizeof(_partition);
+    *fa = &_area;
+    return 0;
+}
+
+void flash_area_close(const struct flash_area* fa)
+{
+    ARG_UNUSED(fa);
+}
+
+static struct tick_provider_subscriber _synthesizer_subscriber;
+static struct tick_provider_subscriber _counter_subscriber;
+static uint32_t _ticks;
+
+static void _tick_count(void)
+{
+    _ticks++;
+}
+
+/* ticks of one pass of the song, or of the first pattern without a song */
+static uint32_t _song_ticks(void)
+{
+    const struct sequencer_header* header = (const struct sequencer_header*)_partition;
+    const uint32_t* offsets = (const uint32_t*)(header + 1);
+    const uint8_t* song = (const uint8_t*)(offsets + header->pattern_count);
+    uint32_t ticks = 0;
+
+    for (size_t i = 0; i < MAX(header->song_length, 1); i++) {
+        const uint8_t index = header->song_length > 0 ? song[i] : 0;
+        const struct sequencer_pattern_header* pattern =
+            (const struct sequencer_pattern_header*)((const uint8_t*)_partition + offsets[index]);
+
+        ticks += pattern->steps * pattern->ticks_per_step;
+    }
+
+    return ticks;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || atoi(argv[2]) <= 0) {
+        printf("usage: %s <image> <passes> [output.wav]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* image = fopen(argv[1], "rb");
+    CHECK(image != NULL);
+    (void)fread(_partition, 1, sizeof(_partition), image);
+    fclose(image);
+
+    const uint32_t passes = atoi(argv[2]);
+
+    FILE* wav = NULL;
+    if (argc > 3) {
+        wav = fopen(argv[3], "wb");
+        CHECK(wav != NULL);
+        _wav_header(wav, 0);
+    }
+
+    /* the startup of audio_process, where the synthesizer starts the sequencer */
+    event_calendar_init();
+    synthesizer_init();
+    tick_provider_init();
+    tick_provider_set_bpm(120);
+    tick_provider_subscribe(&_synthesizer_subscriber, synthesizer_tick);
+    tick_provider_subscribe(&_counter_subscriber, _tick_count);
+
+    static bus_frame block[AUDIO_BLOCK_FRAMES];
+    uint32_t blocks = 0;
+    const uint32_t song_ticks = _song_ticks();
+
+    while (_ticks < passes * song_ticks) {
+        _block_render(block);
+        blocks++;
+
+        if (wav != NULL) {
+            fwrite(block, sizeof(block[0]), AUDIO_BLOCK_FRAMES, wav);
+        }
+    }
+
+    /* the song loops, so it is stopped, releasing what it holds */
+    sequencer_stop();
+
+    for (int i = 0; i < TAIL_BLOCKS; i++) {
+        _block_render(block);
+        blocks++;
+
+        if (wav != NULL) {
+            fwrite(block, sizeof(block[0]), AUDIO_BLOCK_FRAMES, wav);
+        }
+    }
+
+    CHECK(_render_silent());
+
+    if (wav != NULL) {
+        _wav_header(wav, blocks * AUDIO_BLOCK_FRAMES);
+        fclose(wav);
+    }
+
+    printf("%u passes of %u ticks: %.1f s of audio rendered\n", passes, song_ticks,
+           (double)blocks * CONFIG_AUDIO_FRAME_DURATION_US / 1000000);
+
+    return 0;
+}
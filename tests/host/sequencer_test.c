@@ -0,0 +1,346 @@
+/* Validates and decodes the image of sequence.yaml built by scripts/sequencer_pattern.py, plays the song
+ * once through the tick provider and the event calendar, and checks that damaged images are rejected */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+/* the steps are decoded directly, so the sequencer is built into the test */
+#include "sequencer.c"
+
+#include "tick_provider.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define IMAGE_SIZE_MAX 4096
+
+/* what sequence.yaml holds: the song groove, groove, groove, fill */
+#define SONG_LENGTH 4
+#define SONG_TICKS (SONG_LENGTH * 16 * 6)
+
+struct pattern_content {
+    int notes;
+    int drums;
+    int locks;
+};
+
+static const struct pattern_content _expected[] = {
+    {.notes = 5, .drums = 10, .locks = 1},  /* groove */
+    {.notes = 2, .drums = 8, .locks = 2},   /* fill */
+};
+
+static const uint8_t _expected_song[SONG_LENGTH] = {0, 0, 0, 1};
+
+/* the partition, memory mapped */
+static uint32_t _partition[IMAGE_SIZE_MAX / 4];
+static size_t _image_size;
+static struct flash_area _area;
+
+int flash_area_open(uint8_t id, const struct flash_area** fa)
+{
+    if (id != FLASH_AREA_ID(pattern_partition)) {
+        return -ENOENT;
+    }
+
+    _area.fa_off = (off_t)(uintptr_t)_partition;
+    _area.fa_size = sizeof(_partition);
+    *fa = &_area;
+    return 0;
+}
+
+void flash_area_close(const struct flash_area* fa)
+{
+    ARG_UNUSED(fa);
+}
+
+/* played notes by voice, to match their note off */
+static int _voice_notes[CONFIG_MAX_NOTES];
+static int _notes_on;
+static int _notes_off;
+static int _drum_hits;
+
+static void _play(int index, int note, uint8_t velocity)
+{
+    ARG_UNUSED(velocity);
+    _voice_notes[index] = note;
+    _notes_on++;
+}
+
+static void _stop(int index)
+{
+    ARG_UNUSED(index);
+    _notes_off++;
+}
+
+void synthesizer_drum_hit(enum drum_type type, fixed16 level)
+{
+    __ASSERT(type < DRUM_TYPE_NUM && level > 0, "invalid drum hit");
+    _drum_hits++;
+}
+
+static int _decode_test(void)
+{
+    CHECK(_header->pattern_count == ARRAY_SIZE(_expected));
+    CHECK(_header->song_length == SONG_LENGTH);
+    for (size_t i = 0; i < SONG_LENGTH; i++) {
+        CHECK(_song[i] == _expected_song[i]);
+    }
+
+    for (size_t index = 0; index < _header->pattern_count; index++) {
+        CHECK(_pattern_validate(index) == 0);
+
+        const struct sequencer_pattern_header* pattern = _pattern_get(index);
+        const uint8_t* cursor = (const uint8_t*)(pattern + 1);
+        struct pattern_content content = {0};
+
+        for (size_t step = 0; step < pattern->steps; step++) {
+            struct _step decoded;
+            cursor = _step_decode(cursor, &decoded);
+
+            for (size_t i = 0; i < decoded.count; i++) {
+                const struct _event* event = &decoded.events[i];
+                const uint8_t track = event->flags & SEQUENCER_EVENT_TRACK_MASK;
+
+                if (event->flags & SEQUENCER_EVENT_NOTE) {
+                    if (pattern->drum_tracks & BIT(track)) {
+                        CHECK(drum_type_from_note(event->note) != DRUM_TYPE_NUM);
+                        content.drums++;
+                    } else {
+                        content.notes++;
+                    }
+                }
+                if (event->flags & SEQUENCER_EVENT_LOCK) {
+                    /* values the store would reject are never written by the script */
+                    CHECK(event->param < PARAM_NUM);
+                    CHECK(param_store_set(event->param, event->value) == 0);
+                    content.locks++;
+                }
+            }
+        }
+
+        /* every byte of the pattern is decoded */
+        CHECK(cursor == (const uint8_t*)(pattern + 1) + pattern->size);
+        CHECK(content.notes == _expected[index].notes);
+        CHECK(content.drums == _expected[index].drums);
+        CHECK(content.locks == _expected[index].locks);
+    }
+
+    return 0;
+}
+
+/* handles the events due in a block, then counts its ticks. Returns whether the cutoff changed */
+static bool _block_play(void)
+{
+    size_t frame;
+    struct calendar_event event;
+    bool changed = false;
+
+    while (event_calendar_peek(&frame)) {
+        (void)event_calendar_get(&event);
+        event.handler(&event);
+
+        changed |= (param_store_acquire() & PARAM_MASK(PARAM_FILTER_CUTOFF)) != 0;
+    }
+
+    tick_provider_increment();
+
+    return changed;
+}
+
+/* whether a key holds the note */
+static bool _held(int note)
+{
+    for (int i = 0; i < CONFIG_MAX_NOTES; i++) {
+        if (_keys->_keys[i].note == note) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int _play_test(void)
+{
+    param_store_init();
+    (void)param_store_acquire();
+    const int32_t cutoff = param_store_get(PARAM_FILTER_CUTOFF);
+    int cutoff_changes = 0;
+
+    sequencer_start();
+
+    /* blocks until just before the song starts over. The last gate closes well before */
+    const int blocks = (int64_t)SONG_TICKS * 60 * 1000000 / (120 * PULSES_PER_QUARTER_NOTE) / CONFIG_AUDIO_FRAME_DURATION_US - 1;
+
+    for (int block = 0; block < blocks; block++) {
+        if (_block_play()) {
+            cutoff_changes++;
+        }
+    }
+
+    sequencer_stop();
+    tick_provider_increment();
+
+    printf("%d notes on, %d off, %d drum hits, %d cutoff changes\n", _notes_on, _notes_off, _drum_hits,
+           cutoff_changes);
+
+    int notes = 0;
+    int drums = 0;
+    for (size_t i = 0; i < SONG_LENGTH; i++) {
+        notes += _expected[_expected_song[i]].notes;
+        drums += _expected[_expected_song[i]].drums;
+    }
+    CHECK(_notes_on == notes);
+    CHECK(_notes_off == notes);
+    CHECK(_drum_hits == drums);
+
+    /* locked for one step and released, once in each groove and once in the fill */
+    CHECK(cutoff_changes == 2 * SONG_LENGTH);
+    CHECK(param_store_get(PARAM_FILTER_CUTOFF) == cutoff);
+
+    return 0;
+}
+
+/* blocks of a pattern, the longest any of the waits below takes */
+#define PATTERN_BLOCKS (16 * 6 * 60 * (1000000 / CONFIG_AUDIO_FRAME_DURATION_US) / (120 * PULSES_PER_QUARTER_NOTE))
+
+/* plays blocks until the condition holds, for at most a pattern */
+#define PLAY_UNTIL(condition)                          \
+    for (int block = 0; !(condition); block++) {       \
+        CHECK(block < PATTERN_BLOCKS);                 \
+        (void)_block_play();                           \
+    }
+
+/* a start while playing releases at once what the song holds, and what was scheduled before is ignored, so
+ * a note off of the earlier start does not cut the same note of the new one */
+static int _restart_test(void)
+{
+    const int32_t cutoff = param_store_get(PARAM_FILTER_CUTOFF);
+
+    sequencer_start();
+
+    /* step 10 of groove: note 46, with the cutoff locked */
+    PLAY_UNTIL(_locked & BIT(PARAM_FILTER_CUTOFF));
+    (void)_block_play();
+    CHECK(_held(46));
+    CHECK(param_store_get(PARAM_FILTER_CUTOFF) != cutoff);
+
+    uint8_t generation = _generation;
+    sequencer_start();
+    PLAY_UNTIL(_generation != generation);
+    (void)param_store_acquire();
+    CHECK(!_held(46));
+    CHECK(_notes_on == _notes_off);
+    CHECK(param_store_get(PARAM_FILTER_CUTOFF) == cutoff);
+
+    /* step 0 of groove: note 36 for 4 ticks, started over one tick in. The tick count is of the step */
+    (void)_block_play();
+    CHECK(_held(36));
+    PLAY_UNTIL(_tick_count >= 2);
+
+    generation = _generation;
+    sequencer_start();
+    PLAY_UNTIL(_generation != generation);
+    (void)_block_play();
+    CHECK(_held(36));
+
+    /* the note off of the first 36 is due on the third tick of the second */
+    PLAY_UNTIL(_tick_count >= 3);
+    (void)_block_play();
+    CHECK(_held(36));
+
+    PLAY_UNTIL(_tick_count >= 5);
+    (void)_block_play();
+    CHECK(!_held(36));
+
+    sequencer_stop();
+    PLAY_UNTIL(!_playing);
+    (void)param_store_acquire();
+    CHECK(_notes_on == _notes_off);
+    CHECK(param_store_get(PARAM_FILTER_CUTOFF) == cutoff);
+
+    return 0;
+}
+
+/* sequencer_init of a copy of the image with one byte changed */
+static int _init_damaged(struct keys* keys, size_t offset, uint8_t value)
+{
+    uint8_t* image = (uint8_t*)_partition;
+    const uint8_t original = image[offset];
+
+    image[offset] = value;
+    const int ret = sequencer_init(keys);
+    image[offset] = original;
+
+    return ret;
+}
+
+static int _damaged_test(struct keys* keys)
+{
+    const struct sequencer_pattern_header* first = _pattern_get(0);
+    const size_t first_offset = (const uint8_t*)first - (const uint8_t*)_partition;
+    const size_t first_step = first_offset + sizeof(*first);
+
+    CHECK(_init_damaged(keys, 0, 0) == -ENOENT);
+    CHECK(_init_damaged(keys, offsetof(struct sequencer_header, version), SEQUENCER_VERSION + 1) == -ENOTSUP);
+
+    /* the song plays a pattern which does not exist */
+    CHECK(_init_damaged(keys, sizeof(struct sequencer_header) + 4 * 2, 2) == -EINVAL);
+
+    /* a misaligned pattern, and one longer than the partition */
+    CHECK(_init_damaged(keys, sizeof(struct sequencer_header), first_offset + 1) == -EINVAL);
+    CHECK(_init_damaged(keys, first_offset + offsetof(struct sequencer_pattern_header, size) + 1, 0xFF) == -EINVAL);
+
+    /* no steps, and a step of more events than are decoded */
+    CHECK(_init_damaged(keys, first_offset + offsetof(struct sequencer_pattern_header, steps), 0) == -EINVAL);
+    CHECK(_init_damaged(keys, first_step, CONFIG_SYNTH_SEQUENCER_STEP_EVENTS + 1) == -EINVAL);
+
+    /* the velocity of the kick on the first step of groove */
+    CHECK(_init_damaged(keys, first_step + 3, 128) == -EINVAL);
+
+    CHECK(sequencer_init(keys) == 0);
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <image of sequence.yaml>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    _image_size = fread(_partition, 1, sizeof(_partition), file);
+    fclose(file);
+
+    static struct keys keys;
+    keys_init(&keys, _play, _stop);
+    param_store_init();
+
+    CHECK(sequencer_init(&keys) == 0);
+
+    static struct tick_provider_subscriber subscriber;
+
+    event_calendar_init();
+    tick_provider_init();
+    tick_provider_set_bpm(120);
+    tick_provider_subscribe(&subscriber, sequencer_tick);
+
+    if (_decode_test() != 0 || _play_test() != 0 || _restart_test() != 0) {
+        return 1;
+    }
+
+    return _damaged_test(&keys);
+}
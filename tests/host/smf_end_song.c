@@ -0,0 +1,19 @@
+/* a bar with the last note off at the very end of it, where the next pass starts, and with a note held
+ * when the song does not loop, released when playback ends */
+
+#include "smf_player.h"
+
+const struct smf_event smf_events[] = {
+    {0, 0, 0x90, {64, 100}},
+    {0, 0, 0x99, {36, 100}},
+#if !CONFIG_SYNTH_SMF_LOOP
+    {24, 128, 0x90, {67, 90}},
+#endif
+    {48, 0, 0x99, {38, 100}},
+    {72, 0, 0x90, {71, 80}},
+    {95, 0, 0x80, {71, 0}},
+    {96, 0, 0x80, {64, 0}},
+};
+
+const size_t smf_event_count = ARRAY_SIZE(smf_events);
+const uint32_t smf_song_ticks = 96;
@@ -0,0 +1,104 @@
+/* Renders the song of the MIDI file player offline, through the tick provider, the event calendar and the
+ * synthesizer as audio_process does for each block, as fast as the host allows. Checks that no note is left
+ * sounding once playback has stopped, and optionally writes the audio to a WAV file:
+ *   smf_render <passes> [output.wav] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <zephyr/kernel.h>
+
+/* the voices are inspected once the song has stopped, so the synthesizer is built into the renderer */
+#include "synthesizer.c"
+
+#include "render.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+static struct tick_provider_subscriber _synthesizer_subscriber;
+static struct tick_provider_subscriber _counter_subscriber;
+static uint32_t _ticks;
+
+static void _tick_count(void)
+{
+    _ticks++;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || atoi(argv[1]) <= 0) {
+        printf("usage: %s <passes> [output.wav]\n", argv[0]);
+        return 2;
+    }
+
+    const uint32_t passes = atoi(argv[1]);
+
+    FILE* wav = NULL;
+    if (argc > 2) {
+        wav = fopen(argv[2], "wb");
+        CHECK(wav != NULL);
+        _wav_header(wav, 0);
+    }
+
+    /* the startup of audio_process */
+    event_calendar_init();
+    synthesizer_init();
+    tick_provider_init();
+    tick_provider_set_bpm(128);
+    tick_provider_subscribe(&_synthesizer_subscriber, synthesizer_tick);
+    tick_provider_subscribe(&_counter_subscriber, _tick_count);
+
+    static bus_frame block[AUDIO_BLOCK_FRAMES];
+    uint32_t blocks = 0;
+
+    const clock_t start = clock();
+
+    while (_ticks < passes * smf_song_ticks) {
+        _block_render(block);
+        blocks++;
+
+        if (wav != NULL) {
+            fwrite(block, sizeof(block[0]), AUDIO_BLOCK_FRAMES, wav);
+        }
+    }
+
+    /* a song played once has ended by itself, releasing what it left sounding */
+    if (IS_ENABLED(CONFIG_SYNTH_SMF_LOOP)) {
+        smf_player_stop();
+    }
+
+    for (int i = 0; i < TAIL_BLOCKS; i++) {
+        _block_render(block);
+        blocks++;
+
+        if (wav != NULL) {
+            fwrite(block, sizeof(block[0]), AUDIO_BLOCK_FRAMES, wav);
+        }
+    }
+
+    const double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    const double duration = (double)blocks * CONFIG_AUDIO_FRAME_DURATION_US / 1000000;
+
+    CHECK(_render_silent());
+
+    if (wav != NULL) {
+        _wav_header(wav, blocks * AUDIO_BLOCK_FRAMES);
+        fclose(wav);
+    }
+
+    printf("%u passes of %u ticks: %.1f s of audio rendered in %.2f s, %.0fx realtime\n", passes, smf_song_ticks,
+           duration, elapsed, duration / (elapsed > 0 ? elapsed : 1e-9));
+
+    /* the budget of the target is far below the host, so this only catches gross regressions */
+    CHECK(elapsed < duration);
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+/* Advertising API used by the BLE MIDI service. Nothing is advertised on the host */
+
+#ifndef _HOST_STUB_BLUETOOTH_H_
+#define _HOST_STUB_BLUETOOTH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct bt_data {
+    uint8_t type;
+    uint8_t data_len;
+    const uint8_t* data;
+};
+
+#define BT_DATA(_type, _data, _data_len) {.type = (_type), .data_len = (_data_len), .data = (const uint8_t*)(_data)}
+#define BT_DATA_BYTES(_type, _bytes...) BT_DATA(_type, ((uint8_t[]){_bytes}), sizeof((uint8_t[]){_bytes}))
+
+#define BT_DATA_FLAGS 0x01
+#define BT_DATA_UUID128_ALL 0x07
+#define BT_DATA_NAME_COMPLETE 0x09
+
+#define BT_LE_AD_GENERAL 0x02
+#define BT_LE_AD_NO_BREDR 0x04
+
+#define BT_LE_ADV_CONN NULL
+
+static inline int bt_le_adv_start(const void* param, const struct bt_data* ad, size_t ad_len,
+                                  const struct bt_data* sd, size_t sd_len)
+{
+    (void)param; (void)ad; (void)ad_len; (void)sd; (void)sd_len;
+    return 0;
+}
+
+#endif
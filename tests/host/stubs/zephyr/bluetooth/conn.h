@@ -0,0 +1,35 @@
+/* Connection API used by the BLE MIDI service. The tests feed packets without connecting */
+
+#ifndef _HOST_STUB_BT_CONN_H_
+#define _HOST_STUB_BT_CONN_H_
+
+#include <stdint.h>
+
+struct bt_conn;
+
+enum bt_conn_role {
+    BT_CONN_ROLE_CENTRAL,
+    BT_CONN_ROLE_PERIPHERAL,
+};
+
+struct bt_conn_info {
+    enum bt_conn_role role;
+};
+
+struct bt_conn_cb {
+    void (*connected)(struct bt_conn* conn, uint8_t err);
+    void (*disconnected)(struct bt_conn* conn, uint8_t reason);
+};
+
+static inline void bt_conn_cb_register(struct bt_conn_cb* cb) { (void)cb; }
+static inline struct bt_conn* bt_conn_ref(struct bt_conn* conn) { return conn; }
+static inline void bt_conn_unref(struct bt_conn* conn) { (void)conn; }
+
+static inline int bt_conn_get_info(const struct bt_conn* conn, struct bt_conn_info* info)
+{
+    (void)conn;
+    info->role = BT_CONN_ROLE_PERIPHERAL;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,39 @@
+/* GATT API used by the BLE MIDI service. Services are not registered on the host, the tests call the
+ * handlers of the service themselves */
+
+#ifndef _HOST_STUB_BT_GATT_H_
+#define _HOST_STUB_BT_GATT_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+
+struct bt_gatt_attr {
+    const struct bt_uuid* uuid;
+};
+
+/* the attributes are only kept as a list of what they refer to */
+#define BT_GATT_SERVICE_DEFINE(name, ...) static const void* const name[] __attribute__((unused)) = {__VA_ARGS__}
+#define BT_GATT_PRIMARY_SERVICE(service) (service)
+#define BT_GATT_CHARACTERISTIC(uuid, props, perm, read, write, user_data) (uuid), (void*)(read), (void*)(write)
+#define BT_GATT_CCC(changed, perm) (void*)(changed)
+
+#define BT_GATT_CHRC_READ 0x02
+#define BT_GATT_CHRC_WRITE_WITHOUT_RESP 0x04
+#define BT_GATT_CHRC_NOTIFY 0x10
+#define BT_GATT_PERM_READ 0x01
+#define BT_GATT_PERM_WRITE 0x02
+
+#define BT_ATT_ERR_INVALID_OFFSET 0x07
+#define BT_GATT_ERR(att_err) (-(att_err))
+
+static inline ssize_t bt_gatt_attr_read(struct bt_conn* conn, const struct bt_gatt_attr* attr, void* buf,
+                                        uint16_t buf_len, uint16_t offset, const void* value, uint16_t value_len)
+{
+    (void)conn; (void)attr; (void)buf; (void)buf_len; (void)offset; (void)value;
+    return value_len;
+}
+
+#endif
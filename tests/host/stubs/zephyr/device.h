@@ -0,0 +1,13 @@
+#ifndef _HOST_STUB_DEVICE_H_
+#define _HOST_STUB_DEVICE_H_
+
+#include <stdbool.h>
+
+struct device {
+    const char* name;
+};
+
+/* provided by each test using devices */
+bool device_is_ready(const struct device* dev);
+
+#endif
@@ -0,0 +1,29 @@
+/* GPIO API used by the modules built on the host. The functions are provided by each test, which simulates
+ * the hardware behind them */
+
+#ifndef _HOST_STUB_GPIO_H_
+#define _HOST_STUB_GPIO_H_
+
+#include <stdint.h>
+
+#include <zephyr/device.h>
+
+typedef uint8_t gpio_pin_t;
+typedef uint32_t gpio_flags_t;
+typedef uint32_t gpio_port_value_t;
+
+#define GPIO_INPUT BIT(16)
+#define GPIO_OUTPUT BIT(17)
+#define GPIO_OUTPUT_INACTIVE (GPIO_OUTPUT | BIT(18))
+
+struct gpio_dt_spec {
+    const struct device* port;
+    gpio_pin_t pin;
+    gpio_flags_t dt_flags;
+};
+
+int gpio_pin_configure_dt(const struct gpio_dt_spec* spec, gpio_flags_t extra_flags);
+int gpio_pin_set_dt(const struct gpio_dt_spec* spec, int value);
+int gpio_port_get(const struct device* port, gpio_port_value_t* value);
+
+#endif
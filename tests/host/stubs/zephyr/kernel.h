@@ -0,0 +1,75 @@
+/* The parts of the Zephyr kernel API used by the modules built on the host. Asserts are enabled */
+
+#ifndef _HOST_STUB_KERNEL_H_
+#define _HOST_STUB_KERNEL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/atomic.h>
+
+#define BIT(n) (1UL << (n))
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define ARG_UNUSED(x) (void)(x)
+#define BUILD_ASSERT(condition, ...) _Static_assert(condition, "" __VA_ARGS__)
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define CLAMP(val, low, high) (((val) <= (low)) ? (low) : MIN(val, high))
+
+/* as in Zephyr, true only for a macro defined to 1 */
+#define _XXXX1 _YYYY,
+#define IS_ENABLED(config_macro) _IS_ENABLED1(config_macro)
+#define _IS_ENABLED1(config_macro) _IS_ENABLED2(_XXXX##config_macro)
+#define _IS_ENABLED2(one_or_two_args) _IS_ENABLED3(one_or_two_args 1, 0)
+#define _IS_ENABLED3(ignore_this, val, ...) val
+
+typedef int k_timeout_t;
+
+#define K_FOREVER (-1)
+#define K_NO_WAIT 0
+#define K_MSEC(ms) (ms)
+
+/* timers never expire on the host, tests call the expiry functions themselves */
+struct k_timer {
+    void (*expiry)(struct k_timer* timer);
+};
+
+#define K_TIMER_DEFINE(name, expiry_fn, stop_fn) struct k_timer name = {.expiry = (expiry_fn)}
+
+static inline void k_timer_start(struct k_timer* timer, int duration, int period) { ARG_UNUSED(timer); ARG_UNUSED(duration); ARG_UNUSED(period); }
+static inline void k_timer_stop(struct k_timer* timer) { ARG_UNUSED(timer); }
+
+/* work items are not run on the host */
+struct k_work {
+    void (*handler)(struct k_work* work);
+};
+
+#define K_WORK_DEFINE(work, work_handler) struct k_work work = {.handler = (work_handler)}
+
+static inline int k_work_submit(struct k_work* work) { ARG_UNUSED(work); return 0; }
+
+static inline void k_busy_wait(uint32_t usec_to_wait) { ARG_UNUSED(usec_to_wait); }
+
+/* the host tests run on one thread */
+struct k_mutex {
+    int locked;
+};
+
+static inline int k_mutex_init(struct k_mutex* mutex) { mutex->locked = 0; return 0; }
+static inline int k_mutex_lock(struct k_mutex* mutex, int timeout) { ARG_UNUSED(timeout); mutex->locked++; return 0; }
+static inline int k_mutex_unlock(struct k_mutex* mutex) { mutex->locked--; return 0; }
+
+struct k_spinlock {
+    int locked;
+};
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock* lock) { lock->locked++; return 0; }
+static inline void k_spin_unlock(struct k_spinlock* lock, k_spinlock_key_t key) { ARG_UNUSED(key); lock->locked--; }
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _HOST_STUB_LOG_H_
+#define _HOST_STUB_LOG_H_
+
+#include <stdio.h>
+
+#define LOG_MODULE_REGISTER(...)
+#define LOG_MODULE_DECLARE(...)
+
+/* warnings and errors are shown, as they are what the tests provoke */
+#define LOG_DBG(...)
+#define LOG_INF(...)
+#define LOG_WRN(fmt, ...) fprintf(stderr, "<wrn> " fmt "\n", ##__VA_ARGS__)
+#define LOG_ERR(fmt, ...) fprintf(stderr, "<err> " fmt "\n", ##__VA_ARGS__)
+
+#endif
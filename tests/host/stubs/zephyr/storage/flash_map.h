@@ -0,0 +1,26 @@
+/* Flash map API used by the modules built on the host. The functions are provided by each test, with the
+ * partitions in memory */
+
+#ifndef _HOST_STUB_FLASH_MAP_H_
+#define _HOST_STUB_FLASH_MAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+struct flash_area {
+    uint8_t fa_id;
+    uint8_t fa_device_id;
+    off_t fa_off;
+    size_t fa_size;
+};
+
+/* partitions are told apart by label in the tests */
+#define FLASH_AREA_ID(label) _FLASH_AREA_ID_##label
+#define _FLASH_AREA_ID_sample_partition 1
+#define _FLASH_AREA_ID_pattern_partition 2
+
+int flash_area_open(uint8_t id, const struct flash_area** fa);
+void flash_area_close(const struct flash_area* fa);
+
+#endif
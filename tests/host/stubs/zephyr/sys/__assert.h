@@ -0,0 +1,17 @@
+#ifndef _HOST_STUB_ASSERT_H_
+#define _HOST_STUB_ASSERT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define __ASSERT(test, fmt, ...) \
+    do { \
+        if (!(test)) { \
+            fprintf(stderr, "%s:%d: assertion \"%s\" failed: " fmt "\n", __FILE__, __LINE__, #test, ##__VA_ARGS__); \
+            abort(); \
+        } \
+    } while (0)
+
+#define __ASSERT_NO_MSG(test) __ASSERT(test, "")
+
+#endif
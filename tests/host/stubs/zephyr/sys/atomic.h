@@ -0,0 +1,25 @@
+#ifndef _HOST_STUB_ATOMIC_H_
+#define _HOST_STUB_ATOMIC_H_
+
+#include <stdbool.h>
+
+typedef long atomic_t;
+typedef atomic_t atomic_val_t;
+
+#define ATOMIC_INIT(i) (i)
+
+static inline atomic_val_t atomic_get(const atomic_t* target) { return __atomic_load_n(target, __ATOMIC_SEQ_CST); }
+static inline atomic_val_t atomic_set(atomic_t* target, atomic_val_t value) { return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST); }
+static inline atomic_val_t atomic_clear(atomic_t* target) { return atomic_set(target, 0); }
+static inline atomic_val_t atomic_or(atomic_t* target, atomic_val_t value) { return __atomic_fetch_or(target, value, __ATOMIC_SEQ_CST); }
+static inline atomic_val_t atomic_and(atomic_t* target, atomic_val_t value) { return __atomic_fetch_and(target, value, __ATOMIC_SEQ_CST); }
+static inline atomic_val_t atomic_add(atomic_t* target, atomic_val_t value) { return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST); }
+static inline atomic_val_t atomic_inc(atomic_t* target) { return atomic_add(target, 1); }
+static inline atomic_val_t atomic_dec(atomic_t* target) { return atomic_add(target, -1); }
+
+static inline bool atomic_cas(atomic_t* target, atomic_val_t old_value, atomic_val_t new_value)
+{
+    return __atomic_compare_exchange_n(target, &old_value, new_value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif
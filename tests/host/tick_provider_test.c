@@ -0,0 +1,150 @@
+/* Follows an external clock with the arrival jitter of a MIDI transport, through a change of tempo, a stop
+ * and continue, and a restart. Checks that one tick is sent per pulse, without the jitter and at the tempo
+ * of the clock */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "tick_provider.h"
+#include "audio_process.h"
+
+#define BLOCKS 6000
+#define PULSES_MAX 20000
+
+/* pulses arrive up to this late */
+#define JITTER_US 2000
+
+/* spread of the tick times around the pulse times, and their largest distance from it */
+#define DEVIATION_SD_MAX_US 500
+#define DEVIATION_MAX_US 2500
+
+#define BPM_ERROR_MAX_MILLI 500
+
+/* pulses until ticks are in step again after the clock starts, continues or changes tempo */
+#define SETTLE_PULSES 100
+
+static double _block_start_us;
+static int _ticks;
+static double _tick_us[PULSES_MAX];
+
+static void _on_tick(void)
+{
+    if (_ticks < PULSES_MAX) {
+        _tick_us[_ticks] = _block_start_us + tick_provider_tick_frame() * (double)CONFIG_AUDIO_FRAME_DURATION_US / AUDIO_BLOCK_FRAMES;
+    }
+    _ticks++;
+}
+
+/* deviation of tick i from pulse i, around their mean distance */
+static int _deviation_check(const double* pulse_us, int from, int to)
+{
+    double sum = 0;
+    double sum_squares = 0;
+    for (int i = from; i < to; i++) {
+        const double distance = _tick_us[i] - pulse_us[i];
+        sum += distance;
+        sum_squares += distance * distance;
+    }
+    const double mean = sum / (to - from);
+    const double sd = sqrt(sum_squares / (to - from) - mean * mean);
+
+    double deviation_max = 0;
+    for (int i = from; i < to; i++) {
+        deviation_max = fmax(deviation_max, fabs(_tick_us[i] - pulse_us[i] - mean));
+    }
+
+    printf("ticks %d-%d: %.0f us after the pulses, sd %.0f us, max %.0f us\n", from, to, mean, sd, deviation_max);
+
+    return sd <= DEVIATION_SD_MAX_US && deviation_max <= DEVIATION_MAX_US ? 0 : 1;
+}
+
+int main(void)
+{
+    static struct tick_provider_subscriber subscriber;
+    static double pulse_us[PULSES_MAX];
+
+    tick_provider_init();
+    tick_provider_set_bpm(128);
+    tick_provider_subscribe(&subscriber, _on_tick);
+    tick_provider_set_external(true);
+
+    srand(1);
+
+    double period_us = 60e6 / (120 * PULSES_PER_QUARTER_NOTE);
+    double next_pulse_us = 3000;
+    int pulses = 0;
+    int ticks_at_stop = 0;
+    int stop_pulse = 0;
+    int continue_pulse = 0;
+    int restart_pulse = 0;
+    int change_pulse = 0;
+    int result = 0;
+
+    for (int block = 0; block < BLOCKS; block++) {
+        _block_start_us = (double)block * CONFIG_AUDIO_FRAME_DURATION_US;
+
+        if (block == 1000 || block == 2000) {
+            tick_provider_clock_stop();
+            ticks_at_stop = _ticks;
+            if (block == 1000) {
+                stop_pulse = pulses;
+            }
+        }
+        if (block == 1100) {
+            tick_provider_clock_continue();
+            continue_pulse = pulses;
+        }
+        if (block == 2050) {
+            tick_provider_clock_start();
+            restart_pulse = pulses;
+        }
+        if (block == 3000) {
+            period_us = 60e6 / (140 * PULSES_PER_QUARTER_NOTE);
+            change_pulse = pulses;
+        }
+
+        const bool stopped = (block >= 1000 && block < 1100) || (block >= 2000 && block < 2050);
+        if (stopped && _ticks != ticks_at_stop) {
+            printf("block %d: tick while stopped\n", block);
+            result = 1;
+        }
+
+        /* pulses which arrived before this block starts. The clock keeps running while stopped */
+        while (next_pulse_us + JITTER_US < _block_start_us) {
+            if (!stopped) {
+                const double arrival_us = next_pulse_us + rand() % JITTER_US;
+                pulse_us[pulses++] = next_pulse_us;
+                tick_provider_clock_pulse((int32_t)(_block_start_us - arrival_us));
+            }
+            next_pulse_us += period_us;
+        }
+
+        tick_provider_increment();
+
+        if (block == 2999 && abs((int)tick_provider_external_bpm_milli() - 120000) > BPM_ERROR_MAX_MILLI) {
+            printf("tempo %u before the change\n", tick_provider_external_bpm_milli());
+            result = 1;
+        }
+    }
+
+    printf("%d pulses, %d ticks, %.3f bpm\n", pulses, _ticks, tick_provider_external_bpm_milli() / 1000.0);
+
+    if (abs((int)tick_provider_external_bpm_milli() - 140000) > BPM_ERROR_MAX_MILLI) {
+        result = 1;
+    }
+
+    /* the last pulses may still be ahead of their ticks */
+    if (_ticks > pulses || pulses - _ticks > 2) {
+        result = 1;
+    }
+
+    /* settled after locking, after continue, after start and after the change of tempo. No pulses are
+     * counted over the second stop, so it ends where start begins */
+    result |= _deviation_check(pulse_us, SETTLE_PULSES, stop_pulse);
+    result |= _deviation_check(pulse_us, continue_pulse + SETTLE_PULSES, restart_pulse);
+    result |= _deviation_check(pulse_us, restart_pulse + SETTLE_PULSES, change_pulse);
+    result |= _deviation_check(pulse_us, change_pulse + SETTLE_PULSES, pulses - 10);
+
+    return result;
+}
@@ -0,0 +1,80 @@
+/* Sums of aligned phases, as right after note on, saturate instead of wrapping around. Other sums are
+ * the 64-bit product of the sum and the gain */
+
+#include <stdio.h>
+
+#include <zephyr/kernel.h>
+
+#include "unison_osc.h"
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition)) {                                     \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                           \
+        }                                                       \
+    } while (0)
+
+#define BLOCK_SIZE 16
+
+/* every phase at the same sawtooth value, held there */
+static void _phases_set(struct unison_osc* osc, int16_t saw)
+{
+    for (int k = 0; k < UNISON_VOICES; k++) {
+        osc->phase_accumulate[k] = (uint32_t)saw << 16;
+        osc->phase_increment[k] = 0;
+    }
+}
+
+static int32_t _expected(int16_t saw, int32_t gain)
+{
+    const int64_t sum = (int64_t)saw * UNISON_VOICES;
+    return CLAMP((sum * gain) >> 15, INT16_MIN, INT16_MAX);
+}
+
+int main(void)
+{
+    static struct unison_osc osc;
+    fixed16 block[BLOCK_SIZE];
+    stereo16 stereo[BLOCK_SIZE];
+
+    const int16_t saws[] = {INT16_MAX, INT16_MIN, 20000, -20000, 4000, -4000, 1, 0};
+    const fixed16 magnitudes[] = {FLOAT_TO_FIXED16(1.0), FLOAT_TO_FIXED16(0.5), FLOAT_TO_FIXED16(0.1)};
+
+    unison_osc_init(&osc);
+
+    for (size_t m = 0; m < ARRAY_SIZE(magnitudes); m++) {
+        unison_osc_set_amplitude(&osc, magnitudes[m]);
+
+        for (size_t s = 0; s < ARRAY_SIZE(saws); s++) {
+            _phases_set(&osc, saws[s]);
+            CHECK(unison_osc_process(&osc, block, BLOCK_SIZE));
+
+            const int32_t expected = _expected(saws[s], osc.gain);
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                if (block[i] != expected) {
+                    printf("saw %d, gain %d: %d, expected %d\n", saws[s], osc.gain, block[i], expected);
+                    CHECK(block[i] == expected);
+                }
+            }
+
+            /* full scale at any magnitude saturates with the sign of the sum */
+            if (saws[s] == INT16_MAX && magnitudes[m] == FLOAT_TO_FIXED16(1.0)) {
+                CHECK(block[0] == INT16_MAX);
+            }
+            if (saws[s] == INT16_MIN && magnitudes[m] == FLOAT_TO_FIXED16(1.0)) {
+                CHECK(block[0] == INT16_MIN);
+            }
+
+            /* both channels hold the same phases, and keep the sign */
+            _phases_set(&osc, saws[s]);
+            CHECK(unison_osc_process_stereo(&osc, stereo, BLOCK_SIZE));
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                CHECK(STEREO_LEFT(stereo[i]) == STEREO_RIGHT(stereo[i]));
+                CHECK((int32_t)STEREO_LEFT(stereo[i]) * saws[s] >= 0);
+            }
+        }
+    }
+
+    return 0;
+}